@@ -86,12 +86,12 @@ static inline void isb(void)
 
 static inline void irq_enable_all(void)
 {
-	asm("cpsie if");
+	asm volatile("cpsie if" ::: "memory");
 }
 
 static inline void irq_disable_all(void)
 {
-	asm("cpsid if");
+	asm volatile("cpsid if" ::: "memory");
 }
 
 static inline void irq_wait(void)
@@ -118,4 +118,25 @@ static inline void isb(void)
 #error Unknown CPU core!
 #endif /* CONFIG_CORE_xxx */
 
+/**
+ * Disable IRQ and FIQ, and return their previous mask for irq_restore().
+ * Used for short critical sections that may run from interrupt context.
+ * Like irq_restore(), it is a compiler memory barrier: accesses are not
+ * moved out of the critical section.
+ */
+static inline uint32_t irq_disable_save(void)
+{
+	uint32_t mask = cpsr_get() & (CPSR_MASK_IRQ | CPSR_MASK_FIQ);
+	irq_disable_all();
+	return mask;
+}
+
+/**
+ * Restore the IRQ and FIQ mask returned by irq_disable_save().
+ */
+static inline void irq_restore(uint32_t mask)
+{
+	cpsr_clear_bits(~mask & (CPSR_MASK_IRQ | CPSR_MASK_FIQ));
+}
+
 #endif /* ARM_H */
@@ -94,6 +94,18 @@ void cp15_write_ttb(uint32_t value)
 	asm("mcr p15, 0, %0, c2, c0, 0" :: "r"(value));
 }
 
+void cp15_tlb_invalidate_all(void)
+{
+	/* write TLBIALL */
+	asm("mcr p15, 0, %0, c8, c7, 0" :: "r"(0) : "memory");
+}
+
+void cp15_tlb_invalidate_mva(uint32_t mva)
+{
+	/* write TLBIMVA */
+	asm("mcr p15, 0, %0, c8, c7, 1" :: "r"(mva & 0xFFFFF000) : "memory");
+}
+
 void cp15_cache_set_exclusive(void)
 {
 	uint32_t actlr;
@@ -152,6 +152,17 @@ extern void cp15_write_domain_access_control(uint32_t value);
  */
 extern void cp15_write_ttb(uint32_t value);
 
+/**
+ * \brief Invalidate all unified TLB entries.
+ */
+extern void cp15_tlb_invalidate_all(void);
+
+/**
+ * \brief Invalidate the unified TLB entry matching a virtual address.
+ * \param mva modified virtual address
+ */
+extern void cp15_tlb_invalidate_mva(uint32_t mva);
+
 /**
  * \brief Indicate CPU that L2 is in exclusive caching mode.
  */
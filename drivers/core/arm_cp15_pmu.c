@@ -193,20 +193,13 @@ void cp15_disable_interrupt(uint8_t Disable, uint8_t Counter)
 }
 
 /**
- * \brief Initialize Cycle counter with Divider 64
+ * \brief Start the cycle counter (see cp15_pmu_start_cycle_counter()) and
+ * return its current value
  */
 uint32_t cp15_init_cycle_counter(void)
 {
-	uint32_t value;
-	cp15_clear_PMCNT();
-	cp15_enable_PMCNT();
-	cp15_overflow_status(true, CP15_BothCounter);
-	cp15_cycle_count_divider(CP15_CountDivider64);
-	cp15_pmu_control(CP15_ResetCycCounter, true);
-
-	asm("mrc     p15, 0, %0, c9, c13, 0":"=r"(value));
-	return value;
-
+	cp15_pmu_start_cycle_counter();
+	return cp15_get_cycle_counter();
 }
 
 /**
@@ -243,6 +236,52 @@ uint32_t cp15_count_evt(uint8_t Counter)
 uint32_t cp15_get_cycle_counter(void)
 {
 	uint32_t value;
-	asm("mrc     p15, 0, %0, c9, c13, 0":"=r"(value));
+	asm volatile("mrc     p15, 0, %0, c9, c13, 0":"=r"(value));
 	return value;
 }
+
+void cp15_pmu_start_event_counter(uint8_t counter, uint32_t event)
+{
+	assert(counter < 2);
+	/* PMSELR */
+	asm("mcr     p15, 0, %0, c9, c12, 5": :"r"((uint32_t)counter));
+	/* PMXEVTYPER */
+	asm("mcr     p15, 0, %0, c9, c13, 1": :"r"(event));
+	/* PMXEVCNTR */
+	asm("mcr     p15, 0, %0, c9, c13, 2": :"r"(0));
+	/* PMCNTENSET */
+	asm("mcr     p15, 0, %0, c9, c12, 1": :"r"(1u << counter));
+	cp15_pmu_control(CP15_NoReset, true);
+}
+
+void cp15_pmu_stop_event_counter(uint8_t counter)
+{
+	assert(counter < 2);
+	/* PMCNTENCLR */
+	asm("mcr     p15, 0, %0, c9, c12, 2": :"r"(1u << counter));
+}
+
+uint32_t cp15_pmu_read_event_counter(uint8_t counter)
+{
+	uint32_t value;
+
+	assert(counter < 2);
+	/* PMSELR then PMXEVCNTR */
+	asm volatile("mcr     p15, 0, %0, c9, c12, 5": :"r"((uint32_t)counter));
+	asm volatile("mrc     p15, 0, %0, c9, c13, 2":"=r"(value));
+	return value;
+}
+
+void cp15_pmu_start_cycle_counter(void)
+{
+	uint32_t value;
+
+	/* PMCR: clear the divider, enable the counters. The counter values
+	 * and the event counters' configuration are left untouched. */
+	asm("mrc     p15, 0, %0, c9, c12, 0":"=r"(value));
+	value &= ~(1u << CP15_PMCR_DIVIDER);
+	value |= 1u << CP15_PMCR_ENABLE;
+	asm("mcr     p15, 0, %0, c9, c12, 0": :"r"(value));
+	/* PMCNTENSET */
+	asm("mcr     p15, 0, %0, c9, c12, 1": :"r"(1u << CP15_PMCNTENSET));
+}
@@ -48,6 +48,11 @@
 #define CP15_CountDividerSingle 0
 #define CP15_CountDivider64     1
 
+/* Architectural event numbers, for cp15_pmu_start_event_counter() */
+#define CP15_PMU_EVT_L1I_REFILL    0x01
+#define CP15_PMU_EVT_L1D_REFILL    0x03
+#define CP15_PMU_EVT_BR_MIS_PRED   0x10
+
 #define CP15_CounterNone        0
 #define CP15_Counter0           1
 #define CP15_Counter1           2
@@ -86,6 +91,11 @@ typedef enum {
 	DWstallSBFfull		// Data Write operation that stalls the pipeline because the store buffer is full.
 } PerfEventType;
 
+/** CPU cycles per tick of the cycle counter started by
+ * cp15_pmu_start_cycle_counter(): the divider is never enabled. At 500MHz the
+ * 32-bit counter wraps around after about 8.5 seconds. */
+#define CP15_PMU_CYCLES_PER_TICK 1
+
 /*----------------------------------------------------------------------------
  *        Functions
  *----------------------------------------------------------------------------*/
@@ -103,4 +113,33 @@ extern void cp15_enable_interrupt(uint8_t Enable, uint8_t Counter);
 extern void cp15_disable_interrupt(uint8_t Disable, uint8_t Counter);
 extern void cp15_init_perf_counter(PerfEventType Event, uint8_t Counter);
 
+/**
+ * \brief Start counting an event on an event counter.
+ * \param counter  event counter index (0 or 1)
+ * \param event  architectural event number (CP15_PMU_EVT_*)
+ */
+extern void cp15_pmu_start_event_counter(uint8_t counter, uint32_t event);
+
+/**
+ * \brief Stop an event counter.
+ * \param counter  event counter index (0 or 1)
+ */
+extern void cp15_pmu_stop_event_counter(uint8_t counter);
+
+/**
+ * \brief Read an event counter.
+ * \param counter  event counter index (0 or 1)
+ */
+extern uint32_t cp15_pmu_read_event_counter(uint8_t counter);
+
+/**
+ * \brief Start the cycle counter without resetting it.
+ *
+ * The cycle counter is shared by every user (IRQ and DMA statistics,
+ * benchmarks), which only compute differences between two readings: all of
+ * them start it through this function, which is idempotent and always
+ * selects the same divider, CP15_PMU_CYCLES_PER_TICK.
+ */
+extern void cp15_pmu_start_cycle_counter(void);
+
 #endif /* ARM_CP15_PMU_H */
@@ -43,15 +43,22 @@
 void cpsr_clear_bits(uint32_t mask)
 {
 	uint32_t cpsr;
-	asm("mrs %0, cpsr" : "=r"(cpsr));
+	asm volatile("mrs %0, cpsr" : "=r"(cpsr));
 	cpsr &= ~mask;
-	asm("msr cpsr_c, %0" :: "r"(cpsr));
+	asm volatile("msr cpsr_c, %0" :: "r"(cpsr) : "memory");
 }
 
 void cpsr_set_bits(uint32_t mask)
 {
 	uint32_t cpsr;
-	asm("mrs %0, cpsr" : "=r"(cpsr));
+	asm volatile("mrs %0, cpsr" : "=r"(cpsr));
 	cpsr |= mask;
-	asm("msr cpsr_c, %0" :: "r"(cpsr));
+	asm volatile("msr cpsr_c, %0" :: "r"(cpsr) : "memory");
+}
+
+uint32_t cpsr_get(void)
+{
+	uint32_t cpsr;
+	asm volatile("mrs %0, cpsr" : "=r"(cpsr));
+	return cpsr;
 }
@@ -40,4 +40,6 @@ extern void cpsr_clear_bits(uint32_t mask);
 
 extern void cpsr_set_bits(uint32_t mask);
 
+extern uint32_t cpsr_get(void);
+
 #endif /* ARM_CPSR_H_ */
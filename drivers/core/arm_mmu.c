@@ -59,10 +59,157 @@
 /*         Headers                                                               */
 /*------------------------------------------------------------------------------ */
 
+#include "chip.h"
 #include "compiler.h"
 
 #include "arm.h"
 #include "arm_mmu.h"
+#include "misc/cache.h"
+
+#include <errno.h>
+#include <stdbool.h>
+
+/*------------------------------------------------------------------------------ */
+/*         Local definitions                                                     */
+/*------------------------------------------------------------------------------ */
+
+#define TTB_TYPE_MASK         (3 << 0)
+
+#define PAGES_PER_SECTION     (MMU_SECTION_SIZE / MMU_PAGE_SIZE)
+
+/* Descriptor bits replaced when changing memory attributes, execute-never
+ * included so that it follows the memory type */
+#define TTB_PAGE_C_B          ((1 << 3) | (1 << 2))
+#define TTB_SECT_C_B          ((1 << 3) | (1 << 2))
+
+#if defined(CONFIG_CORE_CORTEXA5)
+
+#define TTB_PAGE_XN           (1 << 0)
+#define TTB_PAGE_TEX(x)       (((x) & 7) << 6)
+#define TTB_PAGE_ATTR_MASK    (TTB_PAGE_TEX(7) | TTB_PAGE_C_B | TTB_PAGE_XN)
+
+#define TTB_SECT_XN           (1 << 4)
+#define TTB_SECT_TEX(x)       (((x) & 7) << 12)
+#define TTB_SECT_ATTR_MASK    (TTB_SECT_TEX(7) | TTB_SECT_C_B | TTB_SECT_XN)
+
+#define TTB_COARSE_BITS       0
+
+#elif defined(CONFIG_CORE_ARM926)
+
+#define TTB_PAGE_XN           0
+#define TTB_PAGE_ATTR_MASK    TTB_PAGE_C_B
+
+#define TTB_SECT_XN           0
+#define TTB_SECT_ATTR_MASK    TTB_SECT_C_B
+
+#define TTB_COARSE_BITS       TTB_SECT_SBO
+
+#endif
+
+/*------------------------------------------------------------------------------ */
+/*         Local variables                                                       */
+/*------------------------------------------------------------------------------ */
+
+static uint32_t *_tlb;
+
+ALIGNED(1024) static uint32_t _coarse_tables[MMU_COARSE_TABLES][PAGES_PER_SECTION];
+
+static uint8_t _coarse_used;
+
+/*------------------------------------------------------------------------------ */
+/*         Local functions                                                       */
+/*------------------------------------------------------------------------------ */
+
+/* Returns the C/B/TEX bits of a small page descriptor for attr */
+static uint32_t _page_attr(enum mmu_mem_attr attr)
+{
+	switch (attr) {
+	case MMU_MEM_CACHEABLE_WB:
+		return TTB_SECT_CACHEABLE_WB;
+	case MMU_MEM_CACHEABLE_WT:
+		return TTB_SECT_CACHEABLE_WT;
+	case MMU_MEM_NON_CACHEABLE:
+#if defined(CONFIG_CORE_CORTEXA5)
+		return TTB_PAGE_TEX(1);
+#else
+		return TTB_SECT_WRITE_BACK; /* non-cached, buffered */
+#endif
+	case MMU_MEM_DEVICE:
+#if defined(CONFIG_CORE_CORTEXA5)
+		return TTB_SECT_SHAREABLE_DEVICE;
+#else
+		return TTB_SECT_STRONGLY_ORDERED;
+#endif
+	case MMU_MEM_STRONGLY_ORDERED:
+	default:
+		return TTB_SECT_STRONGLY_ORDERED;
+	}
+}
+
+/* Returns the C/B/TEX bits of a section descriptor for attr */
+static uint32_t _sect_attr(enum mmu_mem_attr attr)
+{
+	uint32_t bits = _page_attr(attr);
+#if defined(CONFIG_CORE_CORTEXA5)
+	/* TEX moves from bits [8:6] to bits [14:12] */
+	bits = (bits & TTB_SECT_C_B) | ((bits & TTB_PAGE_TEX(7)) << 6);
+#endif
+	return bits;
+}
+
+static bool _is_execute_never(enum mmu_mem_attr attr)
+{
+	return attr == MMU_MEM_DEVICE || attr == MMU_MEM_STRONGLY_ORDERED;
+}
+
+static bool _is_coarse(uint32_t desc)
+{
+	return (desc & TTB_TYPE_MASK) == TTB_TYPE_COARSE;
+}
+
+static bool _is_section(uint32_t desc)
+{
+	return (desc & TTB_TYPE_MASK) == TTB_TYPE_SECT;
+}
+
+/* Builds the small page descriptor equivalent to a section descriptor */
+static uint32_t _sect_to_page(uint32_t sect, uint32_t addr)
+{
+	uint32_t page = TTB_PAGE_ADDR(addr) | TTB_TYPE_SMALL_PAGE;
+	uint32_t ap = (sect >> 10) & 3;
+
+	page |= sect & TTB_SECT_C_B;
+#if defined(CONFIG_CORE_CORTEXA5)
+	if (sect & TTB_SECT_XN)
+		page |= TTB_PAGE_XN;
+	page |= ap << 4;
+	page |= TTB_PAGE_TEX(sect >> 12);
+	page |= ((sect >> 15) & 1) << 9;	/* AP[2] */
+	page |= ((sect >> 16) & 1) << 10;	/* S */
+#else
+	page |= (ap << 4) | (ap << 6) | (ap << 8) | (ap << 10);
+#endif
+	return page;
+}
+
+/* Replaces a section descriptor by a coarse page table mapping the same
+ * memory with the same attributes */
+static void _split_section(uint32_t index)
+{
+	uint32_t sect = _tlb[index];
+	uint32_t *table = _coarse_tables[_coarse_used++];
+	uint32_t base = TTB_SECT_ADDR(sect);
+	int i;
+
+	for (i = 0; i < PAGES_PER_SECTION; i++)
+		table[i] = _sect_to_page(sect, base + i * MMU_PAGE_SIZE);
+	cache_clean_region(table, PAGES_PER_SECTION * sizeof(uint32_t));
+
+	_tlb[index] = TTB_COARSE_ADDR((uint32_t)table)
+	            | (sect & TTB_SECT_DOMAIN(0xf))
+	            | TTB_COARSE_BITS
+	            | TTB_TYPE_COARSE;
+}
 
 /*------------------------------------------------------------------------------ */
 /*         Exported functions                                                    */
@@ -70,6 +217,7 @@
 
 void mmu_configure(uint32_t *tlb)
 {
+	_tlb = tlb;
 	cp15_write_ttb((unsigned int)tlb);
 	/* Program the domain access register */
 	/* only domain 15: access are not checked */
@@ -77,3 +225,91 @@ void mmu_configure(uint32_t *tlb)
 	dsb();
 	isb();
 }
+
+int mmu_set_attributes(uint32_t addr, uint32_t size, enum mmu_mem_attr attr)
+{
+	uint32_t first, last, index, needed, mask;
+	uint32_t page_attr = _page_attr(attr);
+	uint32_t sect_attr = _sect_attr(attr);
+	bool xn = _is_execute_never(attr);
+
+	if (!_tlb)
+		return -EPERM;
+	if ((addr | size) & (MMU_PAGE_SIZE - 1))
+		return -EINVAL;
+	if (size == 0)
+		return 0;
+	if (addr + size - 1 < addr)
+		return -EINVAL;
+
+	first = addr >> 20;
+	last = (addr + size - 1) >> 20;
+
+	/* check the whole range before changing anything */
+	needed = 0;
+	for (index = first; index <= last; index++) {
+		uint32_t desc = _tlb[index];
+		uint32_t start = index == first ? addr : index << 20;
+		uint32_t end = index == last ? addr + size : (index + 1) << 20;
+
+		if (_is_section(desc)) {
+			if (end - start != MMU_SECTION_SIZE)
+				needed++;
+		} else if (!_is_coarse(desc)) {
+			return -EINVAL;
+		}
+	}
+
+	mask = irq_disable_save();
+
+	if (needed > MMU_COARSE_TABLES - _coarse_used) {
+		irq_restore(mask);
+		return -ENOMEM;
+	}
+
+	/* write back and drop the cached data with the old attributes */
+	cache_clean_region((void *)addr, size);
+	cache_invalidate_region((void *)addr, size);
+
+	for (index = first; index <= last; index++) {
+		uint32_t start = index == first ? addr : index << 20;
+		uint32_t end = index == last ? addr + size : (index + 1) << 20;
+		uint32_t *table;
+		uint32_t page;
+
+		if (_is_section(_tlb[index]) &&
+		    end - start == MMU_SECTION_SIZE) {
+			uint32_t sect = _tlb[index] & ~TTB_SECT_ATTR_MASK;
+			if (xn)
+				sect |= TTB_SECT_XN;
+			_tlb[index] = sect | sect_attr;
+			cache_clean_region(&_tlb[index], sizeof(uint32_t));
+			cp15_tlb_invalidate_mva(start);
+			continue;
+		}
+
+		if (_is_section(_tlb[index]))
+			_split_section(index);
+
+		table = (uint32_t *)TTB_COARSE_ADDR(_tlb[index]);
+		for (page = (start >> 12) & 0xff;
+		     page <= ((end - 1) >> 12 & 0xff); page++) {
+			uint32_t desc = table[page] & ~TTB_PAGE_ATTR_MASK;
+			if (xn)
+				desc |= TTB_PAGE_XN;
+			table[page] = desc | page_attr;
+		}
+		cache_clean_region(&table[(start >> 12) & 0xff],
+				   (end - start) >> 10);
+		cache_clean_region(&_tlb[index], sizeof(uint32_t));
+
+		/* a split section may still be cached as a whole in the TLB */
+		for (page = start; page != end; page += MMU_PAGE_SIZE)
+			cp15_tlb_invalidate_mva(page);
+	}
+
+	dsb();
+	isb();
+	irq_restore(mask);
+	return 0;
+}
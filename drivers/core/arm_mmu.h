@@ -30,6 +30,12 @@
 #ifndef ARM_MMU_H_
 #define ARM_MMU_H_
 
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
 /*----------------------------------------------------------------------------
  *        Exported definitions
  *----------------------------------------------------------------------------*/
@@ -81,6 +87,40 @@
 /* TTB Section Descriptor: Section Base Address */
 #define TTB_SECT_ADDR(x)           ((x) & 0xFFF00000)
 
+/* TTB descriptor type for Coarse page table descriptor */
+#define TTB_TYPE_COARSE            (1 << 0)
+
+/* TTB Coarse Descriptor: Page Table Base Address */
+#define TTB_COARSE_ADDR(x)         ((x) & 0xFFFFFC00)
+
+/* Page table descriptor type for Small page descriptor */
+#define TTB_TYPE_SMALL_PAGE        (2 << 0)
+
+/* Small Page Descriptor: Page Base Address */
+#define TTB_PAGE_ADDR(x)           ((x) & 0xFFFFF000)
+
+/* Size of a section and of a small page */
+#define MMU_SECTION_SIZE           0x100000
+#define MMU_PAGE_SIZE              0x1000
+
+/* Number of coarse page tables (1 per split section) */
+#ifndef MMU_COARSE_TABLES
+#define MMU_COARSE_TABLES          4
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported types
+ *----------------------------------------------------------------------------*/
+
+/** Memory attributes for mmu_set_attributes */
+enum mmu_mem_attr {
+	MMU_MEM_CACHEABLE_WB,       /**< normal memory, write-back */
+	MMU_MEM_CACHEABLE_WT,       /**< normal memory, write-through */
+	MMU_MEM_NON_CACHEABLE,      /**< normal memory, not cached */
+	MMU_MEM_DEVICE,             /**< device memory, execute-never */
+	MMU_MEM_STRONGLY_ORDERED,   /**< strongly-ordered, execute-never */
+};
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -90,4 +130,27 @@
  */
 extern void mmu_configure(uint32_t *tlb);
 
+/**
+ * \brief Change the memory attributes of an address range.
+ *
+ * Sections fully covered by the range keep a single section descriptor.
+ * Sections partially covered are split into 4KB pages using a coarse page
+ * table taken from a static pool of MMU_COARSE_TABLES tables. Caches are
+ * cleaned and invalidated on the range, then the matching TLB entries are
+ * invalidated.
+ *
+ * Access permissions and domains are preserved. Execute-never is set for
+ * device and strongly-ordered memory and cleared for normal memory. Only
+ * already mapped ranges can be changed.
+ *
+ * \param addr Start of the range, aligned on MMU_PAGE_SIZE
+ * \param size Size of the range, multiple of MMU_PAGE_SIZE
+ * \param attr New memory attributes
+ * \return 0 on success, -EPERM if mmu_configure was not called, -EINVAL if
+ * the range is not aligned or not mapped, -ENOMEM if no coarse page table is
+ * left.
+ */
+extern int mmu_set_attributes(uint32_t addr, uint32_t size,
+			      enum mmu_mem_attr attr);
+
 #endif  /* ARM_MMU_H_ */
@@ -133,8 +133,9 @@ static void _aesd_transfer_buffer_dma(struct _aesd_desc* desc)
 	cache_clean_region((uint32_t*)desc->xfer.bufin->data,
 						desc->xfer.bufin->size);
 
-	/* Allocate one DMA channel for writing message blocks to AES_IDATARx */
-	desc->xfer.dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, ID_AES);
+	/* Allocate once, and keep, one DMA channel for writing message blocks to AES_IDATARx */
+	if (!desc->xfer.dma.tx.channel)
+		desc->xfer.dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, ID_AES);
 	assert(desc->xfer.dma.tx.channel);
 
 	width_in_byte = 1 << _aesd_get_dma_data_width(desc);
@@ -166,8 +167,9 @@ static void _aesd_transfer_buffer_dma(struct _aesd_desc* desc)
 	dma_configure_sg_transfer(desc->xfer.dma.tx.channel, &cfg, NULL);
 	dma_set_callback(desc->xfer.dma.tx.channel, _aesd_dma_callback, (void*)desc);
 
-	/* Allocate one DMA channel for obtaining the result from AES_ODATARx.*/
-	desc->xfer.dma.rx.channel = dma_allocate_channel(ID_AES, DMA_PERIPH_MEMORY);
+	/* Allocate once, and keep, one DMA channel for obtaining the result from AES_ODATARx.*/
+	if (!desc->xfer.dma.rx.channel)
+		desc->xfer.dma.rx.channel = dma_allocate_channel(ID_AES, DMA_PERIPH_MEMORY);
 	assert(desc->xfer.dma.rx.channel);
 
 	remains = desc->xfer.bufout->size;
@@ -202,8 +204,8 @@ static void _aesd_transfer_buffer_dma(struct _aesd_desc* desc)
 	dma_start_transfer(desc->xfer.dma.rx.channel);
 
 	aesd_wait_transfer(desc);
-	dma_free_channel(desc->xfer.dma.tx.channel);
-	dma_free_channel(desc->xfer.dma.rx.channel);
+	dma_free_item(desc->xfer.dma.tx.channel);
+	dma_free_item(desc->xfer.dma.rx.channel);
 	if (desc->xfer.callback)
 			desc->xfer.callback(desc->xfer.cb_args);
 }
@@ -82,8 +82,9 @@ static void _shad_transfer_buffer_dma(struct _shad_desc* desc)
 	cache_clean_region((uint32_t*)desc->xfer.bufin->data,
 						desc->xfer.bufin->size);
 
-	/* Allocate one DMA channel for writing message blocks to SHA_IDATARx */
-	desc->xfer.dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, ID_SHA);
+	/* Allocate once, and keep, one DMA channel for writing message blocks to SHA_IDATARx */
+	if (!desc->xfer.dma.tx.channel)
+		desc->xfer.dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, ID_SHA);
 	assert(desc->xfer.dma.tx.channel);
 	
 	/* For the first block of a message, the FIRST command must be set by
@@ -119,7 +120,7 @@ static void _shad_transfer_buffer_dma(struct _shad_desc* desc)
 
 	dma_start_transfer(desc->xfer.dma.tx.channel);
 	shad_wait_transfer(desc);
-	dma_free_channel(desc->xfer.dma.tx.channel);
+	dma_free_item(desc->xfer.dma.tx.channel);
 
 	sha_get_output((uint32_t*)desc->xfer.bufout->data);
 	if (desc->xfer.callback)
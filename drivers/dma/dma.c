@@ -41,18 +41,20 @@
 #include "peripherals/pmc.h"
 #include "dma/dma.h"
 #include "misc/cache.h"
+#ifdef CONFIG_DMA_STATS
+#include "core/arm_cp15_pmu.h"
+#endif
 
 #include <assert.h>
 #include "compiler.h"
+#ifdef CONFIG_DMA_STATS
+#include <stdio.h>
+#include <string.h>
+#endif
 
 /*----------------------------------------------------------------------------
  *        Local definitions
  *----------------------------------------------------------------------------*/
-struct _ll_item {
-	struct dma_xfer_item *ll;
-	struct _ll_item* next;
-};
-
 /** DMA driver channel */
 struct dma_channel
 {
@@ -77,15 +79,24 @@ struct dma_channel
 	volatile uint32_t rep_count;/* repeat count in auto mode */
 #endif
 	volatile uint8_t state;		/* Channel State */
-	struct _ll_item* ll_head;	/* pointer to the head of linked list */
+	volatile uint8_t cyclic;	/* Looping linked list transfer */
+	volatile uint8_t error;		/* Last transfer stopped on a bus error */
+	struct dma_item_pool *pool;	/* Pool of linked list items */
+	struct _dma_ll_node *ll_head;	/* Head of allocated items */
+	struct _dma_ll_node *ll_tail;	/* Tail of allocated items */
+	struct _dma_ll_node *ll_last;	/* Last item linked by dma_link_last_item */
+	uint32_t ll_count;			/* Number of allocated items */
+	uint32_t xfer_key;			/* Parameters of the last single block transfer */
+	uint32_t period_len;		/* Period of a cyclic transfer, in data elements */
 };
 
+/** Default pool of DMA Linked List items */
+DMA_ITEM_POOL_DECLARE(_default_pool, DMA_LL_POOL_SIZE);
 
-static struct _ll_item  _ll_item_pool[DMA_LL_POOL_SIZE];
-static struct _ll_item* _ll_next_free_item;
-
-/** DMA Linked List */
-CACHE_ALIGNED static struct dma_xfer_item _item_pool[DMA_LL_POOL_SIZE];
+#ifdef CONFIG_DMA_STATS
+/** Timestamp of the last statistics reset */
+static uint32_t _stats_epoch;
+#endif
 
 /*----------------------------------------------------------------------------
  *        Local functions
@@ -100,60 +111,64 @@ static inline bool is_dest_periph(struct dma_channel *channel)
 	return ((channel->dest_txif != 0xff) | (channel->dest_rxif != 0xff));
 }
 
-static void _initialize_item_pool(void)
+/* Parameters of a single block transfer that a channel can be rearmed
+ * with, or 0 if the transfer needs a full configuration */
+static uint32_t _get_xfer_key(const struct dma_xfer_cfg *cfg)
 {
-	uint32_t i;
+	if (cfg->blk_size || !cfg->len || cfg->len > DMA_MAX_BT_SIZE)
+		return 0;
+	return (1u << 31)
+		| (cfg->upd_sa_per_data << 0)
+		| (cfg->upd_da_per_data << 1)
+		| (cfg->data_width << 8)
+		| (cfg->chunk_size << 16);
+}
 
-	for (i = 0; i < ARRAY_SIZE(_ll_item_pool); i++) {
+static inline bool _is_item_linked(struct dma_xfer_item *item)
+{
 #if defined(CONFIG_HAVE_XDMAC)
-		_item_pool[i].mbr_nda = NULL;
+	return item->mbr_nda != NULL;
 #elif defined(CONFIG_HAVE_DMAC)
-		_item_pool[i].dscr = NULL;
+	return item->dscr != NULL;
 #endif
-		_ll_item_pool[i].ll = &_item_pool[i];
-		_ll_item_pool[i].next = &_ll_item_pool[i + 1];
-	}
-	_ll_item_pool[i - 1].next = NULL;
-	_ll_next_free_item = &_ll_item_pool[0];
 }
 
-static struct _ll_item* _allocate_ll_item(void)
+static struct dma_xfer_item* _get_last_ll_item(struct dma_channel *channel)
 {
-	struct _ll_item* item;
+	struct _dma_ll_node* last;
 
-	assert(_ll_next_free_item);
+	if (channel->ll_head == NULL)
+		return NULL;
 
-	item = _ll_next_free_item;
-#if defined(CONFIG_HAVE_XDMAC)
-		item->ll->mbr_nda = NULL;
-#elif defined(CONFIG_HAVE_DMAC)
-		item->ll->dscr = NULL;
-#endif
-	_ll_next_free_item = _ll_next_free_item->next;
-	item->next = NULL;
-	return item;
+	/* Resume the search from the last item found, items before it are
+	 * already linked */
+	last = channel->ll_last ? channel->ll_last : channel->ll_head;
+	while (last->next && _is_item_linked(last->ll))
+		last = last->next;
+	channel->ll_last = last;
+	return last->ll;
 }
 
-static struct dma_xfer_item* _get_last_ll_item(struct dma_channel *channel)
+#ifdef CONFIG_DMA_STATS
+static inline uint32_t _get_timestamp(void)
 {
-	struct _ll_item* last = channel->ll_head;
+#ifdef CONFIG_CORE_CORTEXA5
+	return cp15_get_cycle_counter();
+#else
+	/* No PMU cycle counter on ARM926: latencies are not measured */
+	return 0;
+#endif
+}
 
-	if (channel->ll_head == NULL) {
-		return NULL;
-	} else {
-		while (last->next) {
+static struct dma_channel_stats *_get_channel_stats(uint32_t index)
+{
 #if defined(CONFIG_HAVE_XDMAC)
-			if (!last->ll->mbr_nda)
-				break;
+	return xdmacd_get_stats(index);
 #elif defined(CONFIG_HAVE_DMAC)
-			if (!last->ll->dscr)
-				break;
+	return dmacd_get_stats(index);
 #endif
-			last = last->next;
-		}
-	}
-	return last->ll;
 }
+#endif /* CONFIG_DMA_STATS */
 
 /*----------------------------------------------------------------------------
  *        Exported functions
@@ -161,12 +176,18 @@ static struct dma_xfer_item* _get_last_ll_item(struct dma_channel *channel)
 
 void dma_initialize(bool polling)
 {
-	_initialize_item_pool();
+	dma_initialize_item_pool(&_default_pool);
 #if defined(CONFIG_HAVE_XDMAC)
 	xdmacd_initialize(polling);
 #elif defined(CONFIG_HAVE_DMAC)
 	dmacd_initialize(polling);
 #endif
+#ifdef CONFIG_DMA_STATS
+#ifdef CONFIG_CORE_CORTEXA5
+	cp15_pmu_start_cycle_counter();
+#endif
+	_stats_epoch = _get_timestamp();
+#endif
 }
 
 struct dma_channel *dma_allocate_channel(uint8_t src, uint8_t dest)
@@ -177,7 +198,16 @@ struct dma_channel *dma_allocate_channel(uint8_t src, uint8_t dest)
 #elif defined(CONFIG_HAVE_DMAC)
 	chan = (struct dma_channel *)dmacd_allocate_channel(src, dest);
 #endif
-	chan->ll_head = NULL;
+	if (chan) {
+		chan->pool = &_default_pool;
+		chan->ll_head = NULL;
+		chan->ll_tail = NULL;
+		chan->ll_last = NULL;
+		chan->ll_count = 0;
+		chan->xfer_key = 0;
+		chan->cyclic = false;
+		chan->period_len = 0;
+	}
 	return chan;
 }
 
@@ -185,12 +215,17 @@ uint32_t dma_free_channel(struct dma_channel *channel)
 {
 	uint32_t status;
 
+	/* A cyclic transfer never completes and keeps its items, stop it */
+	if (channel->cyclic)
+		dma_stop_transfer(channel);
 #if defined(CONFIG_HAVE_XDMAC)
 	status = xdmacd_free_channel((struct _xdmacd_channel *)channel);
 #elif defined(CONFIG_HAVE_DMAC)
 	status = dmacd_free_channel((struct _dmacd_channel *)channel);
 #endif
-	dma_free_item(channel);
+	/* The items of a running transfer are still read by the controller */
+	if (status == DMA_OK)
+		dma_free_item(channel);
 	return status;
 }
 
@@ -210,7 +245,7 @@ uint32_t dma_configure_transfer(struct dma_channel *channel,
 								const struct dma_xfer_cfg *cfg)
 {
 	bool src_is_periph, dst_is_periph;
-	uint32_t divisor;
+	uint32_t divisor, key, status;
 
 #if defined(CONFIG_HAVE_XDMAC)
 	struct _xdmacd_cfg xdma_cfg;
@@ -219,6 +254,22 @@ uint32_t dma_configure_transfer(struct dma_channel *channel,
 	struct _dma_desc dma_regs;
 #endif
 
+	/* Same parameters as the previous transfer of the channel: only update
+	 * the addresses and the length */
+	key = _get_xfer_key(cfg);
+	if (key && key == channel->xfer_key) {
+#if defined(CONFIG_HAVE_XDMAC)
+		status = xdmacd_rearm_transfer((struct _xdmacd_channel *)channel,
+					       cfg->sa, cfg->da, cfg->len);
+#elif defined(CONFIG_HAVE_DMAC)
+		status = dmacd_rearm_transfer((struct _dmacd_channel *)channel,
+					      cfg->sa, cfg->da, cfg->len);
+#endif
+		if (status == DMA_OK)
+			return DMA_OK;
+	}
+	channel->xfer_key = 0;
+
 	src_is_periph = is_source_periph(channel);
 	dst_is_periph = is_dest_periph(channel);
 
@@ -280,7 +331,10 @@ uint32_t dma_configure_transfer(struct dma_channel *channel,
 	xdma_cfg.sus = 0;
 	xdma_cfg.dus = 0;
 
-	return xdmacd_configure_transfer((struct _xdmacd_channel *)channel, &xdma_cfg, 0, 0);
+	status = xdmacd_configure_transfer((struct _xdmacd_channel *)channel, &xdma_cfg, 0, 0);
+	if (status == DMA_OK)
+		channel->xfer_key = key;
+	return status;
 
 #elif defined(CONFIG_HAVE_DMAC)
 
@@ -360,7 +414,94 @@ uint32_t dma_configure_transfer(struct dma_channel *channel,
 						DMAC_CTRLB_DST_INCR_FIXED);
 	dma_regs.ctrlb |= DMAC_CTRLB_SRC_DSCR_FETCH_DISABLE | DMAC_CTRLB_DST_DSCR_FETCH_DISABLE;
 
-	return dmacd_configure_transfer((struct _dmacd_channel *)channel, &dma_cfg, &dma_regs);
+	status = dmacd_configure_transfer((struct _dmacd_channel *)channel, &dma_cfg, &dma_regs);
+	if (status == DMA_OK)
+		channel->xfer_key = key;
+	return status;
+#endif
+}
+
+uint32_t dma_configure_2d_transfer(struct dma_channel *channel,
+				   const struct dma_xfer_2d_cfg *cfg)
+{
+	bool src_is_periph, dst_is_periph;
+
+	if (!cfg->width || cfg->width > DMA_MAX_BT_SIZE || !cfg->height)
+		return DMA_ERROR;
+
+	src_is_periph = is_source_periph(channel);
+	dst_is_periph = is_dest_periph(channel);
+	channel->xfer_key = 0;
+
+#if defined(CONFIG_HAVE_XDMAC)
+	struct _xdmacd_cfg xdma_cfg;
+	uint32_t row_len = cfg->width * DMA_DATA_WIDTH_IN_BYTE(cfg->data_width);
+
+	if (cfg->height > DMA_MAX_BLOCK_LEN)
+		return DMA_ERROR;
+
+	xdma_cfg.ubc = cfg->width;
+	xdma_cfg.bc = cfg->height - 1;
+	xdma_cfg.sa = (void *)cfg->sa;
+	xdma_cfg.da = cfg->da;
+	xdma_cfg.cfg = (src_is_periph | dst_is_periph) ?
+					XDMAC_CC_TYPE_PER_TRAN : XDMAC_CC_TYPE_MEM_TRAN;
+	xdma_cfg.cfg |= src_is_periph ? XDMAC_CC_DSYNC_PER2MEM:
+					 XDMAC_CC_DSYNC_MEM2PER;
+	xdma_cfg.cfg |= (src_is_periph | dst_is_periph) ?
+					XDMAC_CC_CSIZE(cfg->chunk_size) : 0;
+	xdma_cfg.cfg |= XDMAC_CC_DWIDTH(cfg->data_width);
+	xdma_cfg.cfg |= src_is_periph ? XDMAC_CC_SIF_AHB_IF1:
+					XDMAC_CC_SIF_AHB_IF0;
+	xdma_cfg.cfg |= dst_is_periph ? XDMAC_CC_DIF_AHB_IF1:
+					XDMAC_CC_DIF_AHB_IF0;
+	/* Addresses are incremented within a row, then the microblock stride
+	 * moves them to the start of the next row */
+	xdma_cfg.cfg |= src_is_periph ? XDMAC_CC_SAM_FIXED_AM :
+					XDMAC_CC_SAM_UBS_AM;
+	xdma_cfg.cfg |= dst_is_periph ? XDMAC_CC_DAM_FIXED_AM :
+					XDMAC_CC_DAM_UBS_AM;
+	xdma_cfg.cfg |= (src_is_periph | dst_is_periph) ? 0: XDMAC_CC_SWREQ_SWR_CONNECTED;
+	xdma_cfg.ds = 0;
+	xdma_cfg.sus = src_is_periph ? 0 : XDMAC_CSUS_SUBS(cfg->src_stride - row_len);
+	xdma_cfg.dus = dst_is_periph ? 0 : XDMAC_CDUS_DUBS(cfg->dst_stride - row_len);
+
+	return xdmacd_configure_transfer((struct _xdmacd_channel *)channel, &xdma_cfg, 0, 0);
+
+#elif defined(CONFIG_HAVE_DMAC)
+	struct dma_xfer_item_tmpl tmpl;
+	struct dma_xfer_item *item, *prev = NULL;
+	uint32_t i;
+
+	if (!dma_is_transfer_done(channel))
+		return DMA_BUSY;
+	dma_free_item(channel);
+
+	tmpl.upd_sa_per_data = !src_is_periph;
+	tmpl.upd_da_per_data = !dst_is_periph;
+	tmpl.upd_sa_per_blk = 1;
+	tmpl.upd_da_per_blk = 1;
+	tmpl.data_width = cfg->data_width;
+	tmpl.chunk_size = cfg->chunk_size;
+	tmpl.blk_size = cfg->width;
+
+	/* One item per row */
+	for (i = 0; i < cfg->height; i++) {
+		item = dma_allocate_item(channel);
+		if (!item) {
+			dma_free_item(channel);
+			return DMA_ERROR;
+		}
+		tmpl.sa = (const uint8_t*)cfg->sa + (src_is_periph ? 0 : i * cfg->src_stride);
+		tmpl.da = (uint8_t*)cfg->da + (dst_is_periph ? 0 : i * cfg->dst_stride);
+		dma_prepare_item(channel, &tmpl, item);
+		if (prev)
+			dma_link_item(channel, prev, item);
+		prev = item;
+	}
+	dma_link_item(channel, prev, NULL);
+
+	return dma_configure_sg_transfer(channel, &tmpl, NULL);
 #endif
 }
 
@@ -435,34 +576,103 @@ uint32_t dma_prepare_item(struct dma_channel *channel,
 #endif
 }
 
-struct dma_xfer_item* dma_allocate_item(struct dma_channel *channel)
+void dma_initialize_item_pool(struct dma_item_pool *pool)
 {
-	struct _ll_item* item = _allocate_ll_item();
-	struct _ll_item* last = channel->ll_head;
+	uint32_t i;
 
-	if (item) {
-		if (channel->ll_head == NULL) {
-			channel->ll_head = item;
-		} else {
-			while (last->next)
-				last = last->next;
-			last->next = item;
-		}
-		return item->ll;
+	for (i = 0; i < pool->size; i++) {
+#if defined(CONFIG_HAVE_XDMAC)
+		pool->items[i].mbr_nda = NULL;
+#elif defined(CONFIG_HAVE_DMAC)
+		pool->items[i].dscr = NULL;
+#endif
+		pool->nodes[i].ll = &pool->items[i];
+		pool->nodes[i].next = (i + 1 < pool->size) ? &pool->nodes[i + 1] : NULL;
 	}
+	pool->free = pool->size ? &pool->nodes[0] : NULL;
+	pool->used = 0;
+	pool->high_water = 0;
+	pool->exhausted = 0;
+}
 
-	return NULL;
+uint32_t dma_set_item_pool(struct dma_channel *channel,
+			   struct dma_item_pool *pool)
+{
+	if (channel->ll_head)
+		return DMA_BUSY;
+	channel->pool = pool ? pool : &_default_pool;
+	return DMA_OK;
 }
 
-void dma_free_item(struct dma_channel *channel)
+void dma_get_item_pool_stats(struct dma_item_pool *pool,
+			     struct dma_item_pool_stats *stats)
 {
-	struct _ll_item* item = channel->ll_head;
-	struct _ll_item* next = _ll_next_free_item;
+	uint32_t mask;
+
+	if (!pool)
+		pool = &_default_pool;
 
-	while (next->next)
-		next = next->next;
-	next->next = item;
-	channel->ll_head = NULL;
+	mask = irq_disable_save();
+	stats->size = pool->size;
+	stats->used = pool->used;
+	stats->high_water = pool->high_water;
+	stats->exhausted = pool->exhausted;
+	irq_restore(mask);
+}
+
+struct dma_xfer_item* dma_allocate_item(struct dma_channel *channel)
+{
+	struct dma_item_pool *pool = channel->pool;
+	struct _dma_ll_node* node;
+	uint32_t mask;
+
+	mask = irq_disable_save();
+	node = pool->free;
+	if (node) {
+		pool->free = node->next;
+		if (++pool->used > pool->high_water)
+			pool->high_water = pool->used;
+		node->next = NULL;
+		if (channel->ll_head == NULL)
+			channel->ll_head = node;
+		else
+			channel->ll_tail->next = node;
+		channel->ll_tail = node;
+		channel->ll_count++;
+	} else {
+		pool->exhausted++;
+	}
+	irq_restore(mask);
+
+	if (!node)
+		return NULL;
+#if defined(CONFIG_HAVE_XDMAC)
+	node->ll->mbr_nda = NULL;
+#elif defined(CONFIG_HAVE_DMAC)
+	node->ll->dscr = NULL;
+#endif
+	return node->ll;
+}
+
+void dma_free_item(struct dma_channel *channel)
+{
+	struct dma_item_pool *pool;
+	uint32_t mask;
+
+	mask = irq_disable_save();
+	/* Items of a cyclic transfer are in use until it is stopped */
+	if (channel->ll_head && !channel->cyclic) {
+		/* Give back the whole list of the channel at once */
+		pool = channel->pool;
+		channel->ll_tail->next = pool->free;
+		pool->free = channel->ll_head;
+		pool->used -= channel->ll_count;
+		channel->ll_head = NULL;
+		channel->ll_tail = NULL;
+		channel->ll_last = NULL;
+		channel->ll_count = 0;
+	}
+	irq_restore(mask);
 }
 
 uint32_t dma_link_item(struct dma_channel *channel,
@@ -647,6 +857,7 @@ uint32_t dma_configure_sg_transfer(struct dma_channel *channel,
 		else 
 			desc_list = channel->ll_head->ll;
 	}
+	channel->xfer_key = 0;
 
 #if defined(CONFIG_HAVE_XDMAC)
 	struct _xdmacd_cfg xdma_cfg;
@@ -686,7 +897,8 @@ uint32_t dma_configure_sg_transfer(struct dma_channel *channel,
 				| XDMAC_CNDC_NDSUP_SRC_PARAMS_UPDATED
 				| XDMAC_CNDC_NDDUP_DST_PARAMS_UPDATED;
 	if (channel->ll_head != NULL)
-		cache_clean_region(_item_pool, sizeof(_item_pool));
+		cache_clean_region(channel->pool->items,
+				   channel->pool->size * sizeof(struct dma_xfer_item));
 	return xdmacd_configure_transfer((struct _xdmacd_channel *)channel, &xdma_cfg, desc_cntrl, (void *)desc_list);
 #elif defined(CONFIG_HAVE_DMAC)
 
@@ -707,12 +919,90 @@ uint32_t dma_configure_sg_transfer(struct dma_channel *channel,
 	dma_cfg.cfg = src_is_periph ? DMAC_CFG_SRC_H2SEL_HW : 0;
 	dma_cfg.cfg |= dst_is_periph ? DMAC_CFG_DST_H2SEL_HW : 0;
 	if (channel->ll_head != NULL)
-		cache_clean_region(_item_pool, sizeof(_item_pool));
+		cache_clean_region(channel->pool->items,
+				   channel->pool->size * sizeof(struct dma_xfer_item));
 
 	return dmacd_configure_transfer((struct _dmacd_channel *)channel, &dma_cfg, (void *)desc_list);
 #endif
 }
 
+uint32_t dma_configure_cyclic(struct dma_channel *channel,
+			      const struct dma_xfer_cfg *cfg,
+			      uint32_t period_len, uint32_t period_count)
+{
+	struct dma_xfer_item_tmpl tmpl;
+	struct dma_xfer_item *item, *prev = NULL;
+	uint32_t i, period_bytes, status;
+
+	if (period_len == 0 || period_len > DMA_MAX_BT_SIZE || period_count < 2)
+		return DMA_ERROR;
+	if (!dma_is_transfer_done(channel))
+		return DMA_BUSY;
+	dma_free_item(channel);
+
+	tmpl.upd_sa_per_data = cfg->upd_sa_per_data;
+	tmpl.upd_da_per_data = cfg->upd_da_per_data;
+	tmpl.upd_sa_per_blk = 1;
+	tmpl.upd_da_per_blk = 1;
+	tmpl.data_width = cfg->data_width;
+	tmpl.chunk_size = cfg->chunk_size;
+	tmpl.blk_size = period_len;
+	period_bytes = period_len * DMA_DATA_WIDTH_IN_BYTE(cfg->data_width);
+
+	/* One descriptor per period, the last one pointing back to the first */
+	for (i = 0; i < period_count; i++) {
+		item = dma_allocate_item(channel);
+		if (!item) {
+			dma_free_item(channel);
+			return DMA_ERROR;
+		}
+		channel->ll_tail->period = i;
+		tmpl.sa = (uint8_t*)cfg->sa + (cfg->upd_sa_per_data ? i * period_bytes : 0);
+		tmpl.da = (uint8_t*)cfg->da + (cfg->upd_da_per_data ? i * period_bytes : 0);
+		dma_prepare_item(channel, &tmpl, item);
+		if (prev)
+			dma_link_item(channel, prev, item);
+		prev = item;
+	}
+	dma_link_item(channel, prev, channel->ll_head->ll);
+
+	channel->cyclic = true;
+	channel->period_len = period_len;
+	status = dma_configure_sg_transfer(channel, &tmpl, NULL);
+	if (status != DMA_OK) {
+		channel->cyclic = false;
+		dma_free_item(channel);
+	}
+	return status;
+}
+
+uint32_t dma_get_cyclic_position(struct dma_channel *channel)
+{
+	struct dma_item_pool *pool = channel->pool;
+	struct dma_xfer_item *next;
+	uint32_t index, done;
+
+	if (!channel->cyclic)
+		return 0;
+
+	/* Read the transferred length within a single period */
+	do {
+		next = dma_get_desc_addr(channel);
+		done = dma_get_transferred_data_len(channel, DMA_CHUNK_SIZE_1,
+						    channel->period_len);
+	} while (next != dma_get_desc_addr(channel));
+	next = (struct dma_xfer_item*)((uint32_t)next & ~3u);
+
+	/* The descriptor register holds the period following the current one.
+	 * Items and their nodes are parallel arrays of the pool. */
+	if (next < pool->items || next >= pool->items + pool->size)
+		return done;
+	index = pool->nodes[next - pool->items].period;
+	index = (index ? index : channel->ll_count) - 1;
+
+	return index * channel->period_len + done;
+}
+
 uint32_t dma_start_transfer(struct dma_channel *channel)
 {
 #if defined(CONFIG_HAVE_XDMAC)
@@ -731,13 +1021,31 @@ bool dma_is_transfer_done(struct dma_channel *channel)
 #endif
 }
 
+uint32_t dma_get_transfer_status(struct dma_channel *channel)
+{
+#if defined(CONFIG_HAVE_XDMAC)
+	return xdmacd_get_transfer_status((struct _xdmacd_channel *)channel);
+#elif defined(CONFIG_HAVE_DMAC)
+	return dmacd_get_transfer_status((struct _dmacd_channel *)channel);
+#endif
+}
+
 uint32_t dma_stop_transfer(struct dma_channel *channel)
 {
+	uint32_t status;
+
+	/* Channel interrupts are disabled, a full configuration is needed */
+	channel->xfer_key = 0;
 #if defined(CONFIG_HAVE_XDMAC)
-	return xdmacd_stop_transfer((struct _xdmacd_channel *)channel);
+	status = xdmacd_stop_transfer((struct _xdmacd_channel *)channel);
 #elif defined(CONFIG_HAVE_DMAC)
-	return dmacd_stop_transfer((struct _dmacd_channel *)channel);
+	status = dmacd_stop_transfer((struct _dmacd_channel *)channel);
 #endif
+	if (channel->cyclic) {
+		channel->cyclic = false;
+		dma_free_item(channel);
+	}
+	return status;
 }
 
 uint32_t dma_suspend_transfer(struct dma_channel *channel)
@@ -798,4 +1106,67 @@ void dma_fifo_flush(struct dma_channel *channel)
 #endif
 }
 
+#ifdef CONFIG_DMA_STATS
+void dma_stats_record_start(struct dma_channel_stats *stats)
+{
+	stats->transfers++;
+	stats->bytes += stats->pending_bytes;
+	stats->start = _get_timestamp();
+}
+
+void dma_stats_record_end(struct dma_channel_stats *stats, bool error)
+{
+	uint32_t latency = _get_timestamp() - stats->start;
+	uint32_t bucket = 0;
+
+	if (error)
+		stats->errors++;
+	stats->busy += latency;
+	while ((latency >>= 1) && bucket < DMA_STATS_LATENCY_BUCKETS - 1)
+		bucket++;
+	stats->latency[bucket]++;
+}
+
+void dma_dump_stats(void)
+{
+	struct dma_channel_stats *stats;
+	uint32_t elapsed = _get_timestamp() - _stats_epoch;
+	uint32_t i, j;
+
+	printf("DMA: %u cycles elapsed, peripheral 255 is memory\r\n",
+	       (unsigned)elapsed);
+	for (i = 0; (stats = _get_channel_stats(i)) != NULL; i++) {
+		if (!stats->transfers)
+			continue;
+		printf("CH%u: %u -> %u, %u transfers, %u errors, %llu bytes, busy %u%%\r\n",
+		       (unsigned)i, stats->src, stats->dest,
+		       (unsigned)stats->transfers, (unsigned)stats->errors,
+		       (unsigned long long)stats->bytes,
+		       elapsed ? (unsigned)(stats->busy * 100 / elapsed) : 0);
+		printf("    latency (log2 cycles):");
+		for (j = 0; j < DMA_STATS_LATENCY_BUCKETS; j++)
+			printf(" %u", (unsigned)stats->latency[j]);
+		printf("\r\n");
+	}
+}
+
+void dma_reset_stats(void)
+{
+	struct dma_channel_stats *stats;
+	uint32_t i, mask;
+
+	/* Keep the owners and the state of running transfers */
+	mask = irq_disable_save();
+	for (i = 0; (stats = _get_channel_stats(i)) != NULL; i++) {
+		stats->transfers = 0;
+		stats->errors = 0;
+		stats->bytes = 0;
+		stats->busy = 0;
+		memset(stats->latency, 0, sizeof(stats->latency));
+	}
+	_stats_epoch = _get_timestamp();
+	irq_restore(mask);
+}
+#endif /* CONFIG_DMA_STATS */
+
 /**@}*/
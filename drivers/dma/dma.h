@@ -35,6 +35,7 @@
  *----------------------------------------------------------------------------*/
 
 #include "chip.h"
+#include "misc/cache.h"
 
 
 #if defined(CONFIG_HAVE_XDMAC)
@@ -93,6 +94,9 @@
 
 #define DMA_DATA_WIDTH_IN_BYTE(w)   (1 << w)
 
+/** Number of buckets of the transfer latency histogram */
+#define DMA_STATS_LATENCY_BUCKETS 24
+
 /*----------------------------------------------------------------------------
  *        Types
  *----------------------------------------------------------------------------*/
@@ -135,6 +139,20 @@ struct dma_xfer_cfg {
 	uint32_t len;				/* transfer length, expressed in data elements; if blk_size is non-zero, then len shall be a multiple of blk_size */
 };
 
+/* Set of parameters to specify a two-dimensional transfer: height rows of
+   width data elements, the start of consecutive rows being separated by a
+   stride on each side. The address of a peripheral side is not incremented. */
+struct dma_xfer_2d_cfg {
+	const void *sa;				/* address of the first source row */
+	void *da;					/* address of the first destination row */
+	uint8_t data_width;			/* data element width, DMA_DATA_WIDTH_xxx */
+	uint8_t chunk_size;			/* chunk size (if transferring with a peripheral) */
+	uint32_t width;				/* row length, expressed in data elements */
+	uint32_t height;			/* number of rows */
+	uint32_t src_stride;		/* distance between two source rows, in bytes */
+	uint32_t dst_stride;		/* distance between two destination rows, in bytes */
+};
+
 /** Types for specifying a transfer of scattered data, or a transfer of
  * contiguous data that may be reconfigured on a block-by-block basis. */
 
@@ -181,6 +199,61 @@ struct dma_xfer_item {
 #  error "Requires a DMA controller to be enabled"
 #endif
 
+/** Bookkeeping node of a linked list item, private to the DMA driver */
+struct _dma_ll_node {
+	struct dma_xfer_item *ll;
+	struct _dma_ll_node *next;
+	uint32_t period;		/* Period of the item in a cyclic transfer */
+};
+
+/** Pool of linked list items used by dma_allocate_item.
+ * Each channel allocates from the default pool of DMA_LL_POOL_SIZE items,
+ * unless another pool is attached with dma_set_item_pool. Declare pools with
+ * DMA_ITEM_POOL_DECLARE, and initialize them with dma_initialize_item_pool. */
+struct dma_item_pool {
+	struct dma_xfer_item *items;	/* Item storage, cache-aligned */
+	struct _dma_ll_node *nodes;		/* One bookkeeping node per item */
+	uint32_t size;					/* Number of items */
+	struct _dma_ll_node *free;		/* Free nodes */
+	uint32_t used;					/* Allocated items */
+	uint32_t high_water;			/* Maximum number of allocated items */
+	uint32_t exhausted;				/* Allocations failed for lack of items */
+};
+
+/** Statistics of a linked list item pool */
+struct dma_item_pool_stats {
+	uint32_t size;			/* Number of items */
+	uint32_t used;			/* Allocated items */
+	uint32_t high_water;	/* Maximum number of allocated items */
+	uint32_t exhausted;		/* Allocations failed for lack of items */
+};
+
+/** Statistics of a physical DMA channel, recorded when CONFIG_DMA_STATS is
+ * defined. Latencies are measured from the start of a transfer to its
+ * completion interrupt, in CPU cycles (see cp15_pmu_start_cycle_counter()).
+ * The elapsed time is read from the 32-bit cycle counter, so the bus
+ * utilization is only meaningful when dma_reset_stats() was called less than
+ * 2^32 cycles before dma_dump_stats(). */
+struct dma_channel_stats {
+	uint8_t src;			/* Source peripheral ID of the last owner */
+	uint8_t dest;			/* Destination peripheral ID of the last owner */
+	uint32_t transfers;		/* Started transfers */
+	uint32_t errors;		/* Transfers ended by a bus or overflow error */
+	uint64_t bytes;			/* Bytes of the started transfers */
+	uint64_t busy;			/* Sum of the latencies */
+	uint32_t latency[DMA_STATS_LATENCY_BUCKETS];	/* Bucket i counts latencies
+												   below 2^(i+1) cycles */
+	/* private */
+	uint32_t pending_bytes;	/* Size of the configured transfer */
+	uint32_t start;			/* Timestamp of the running transfer */
+};
+
+/** Declare a static pool of count linked list items */
+#define DMA_ITEM_POOL_DECLARE(name, count) \
+	CACHE_ALIGNED static struct dma_xfer_item name##_items[count]; \
+	static struct _dma_ll_node name##_nodes[count]; \
+	static struct dma_item_pool name = { name##_items, name##_nodes, (count) }
+
 /**     @}*/
 
 /*----------------------------------------------------------------------------
@@ -232,10 +305,28 @@ extern uint32_t dma_set_callback(struct dma_channel *channel,
  * \param channel Channel pointer
  * \param cfg DMA transfer configuration
  * \return result code
+ * \note When the previous transfer of the channel was a single block with the
+ * same parameters, only the addresses and the length are updated. Drivers
+ * should keep their channels allocated between transfers to benefit from it.
  */
 extern uint32_t dma_configure_transfer(struct dma_channel *channel,
 				const struct dma_xfer_cfg *cfg);
 
+/**
+ * \brief Configure DMA for a two-dimensional (rectangle) transfer.
+ *
+ * On XDMAC, rows are microblocks of a single block and the strides are
+ * applied by the controller, so the height is limited to DMA_MAX_BLOCK_LEN.
+ * On DMAC, one linked list item per row is allocated from the channel item
+ * pool, which limits the height to the free items of the pool.
+ *
+ * \param channel Channel pointer
+ * \param cfg 2D transfer configuration
+ * \return DMA_OK, or DMA_ERROR if the transfer cannot be described
+ */
+extern uint32_t dma_configure_2d_transfer(struct dma_channel *channel,
+				const struct dma_xfer_2d_cfg *cfg);
+
 /**
  * \brief Prepare the provided transfer descriptor, AKA linked list item.
  * \param channel Channel pointer
@@ -327,6 +418,35 @@ extern uint32_t dma_configure_sg_transfer(struct dma_channel *channel,
 					  struct dma_xfer_item_tmpl *tmpl,
 					  struct dma_xfer_item *desc_list);
 
+/**
+ * \brief Configure a cyclic transfer looping over a buffer split in periods.
+ *
+ * One linked list item per period is allocated from the channel item pool,
+ * the last one pointing back to the first. Once started, the transfer runs
+ * without gaps until dma_stop_transfer is called, which also frees the items.
+ * The channel callback is invoked at the end of each period; use
+ * dma_get_cyclic_position to locate the DMA within the buffer.
+ *
+ * \param channel Channel pointer
+ * \param cfg Transfer parameters, sa/da being the start of the buffer on the
+ * memory side; len and blk_size are ignored
+ * \param period_len Length of a period, expressed in data elements
+ * \param period_count Number of periods in the buffer, at least 2
+ * \return DMA_OK on success, DMA_BUSY if the channel is running, DMA_ERROR on
+ * invalid parameters or if the pool has not enough items
+ */
+extern uint32_t dma_configure_cyclic(struct dma_channel *channel,
+				     const struct dma_xfer_cfg *cfg,
+				     uint32_t period_len, uint32_t period_count);
+
+/**
+ * \brief Get the position of a cyclic transfer.
+ * \param channel Channel pointer
+ * \return Number of data elements transferred since the start of the buffer
+ * in the current loop
+ */
+extern uint32_t dma_get_cyclic_position(struct dma_channel *channel);
+
 /**
  * \brief Stop DMA transfer.
  * \param channel Channel pointer
@@ -357,6 +477,15 @@ extern uint32_t dma_free_channel(struct dma_channel *channel);
  */
 extern bool dma_is_transfer_done(struct dma_channel *channel);
 
+/**
+ * \brief Get the status of the last transfer of a DMA channel, e.g. from its
+ * callback.
+ * \param channel Channel pointer
+ * \return DMA_OK, DMA_BUSY if the transfer is not finished, or DMA_ERROR if
+ * it has been stopped by a bus error.
+ */
+extern uint32_t dma_get_transfer_status(struct dma_channel *channel);
+
 /**
  * \brief Flush FIFO of DMA.
  * \param channel Channel pointer
@@ -382,6 +511,8 @@ extern struct dma_xfer_item * dma_get_desc_addr(struct dma_channel *channel);
  * \param channel Channel pointer
  * \return linked list pointer if allocation successful, or NULL if allocation 
  * failed.
+ * \note Allocation and free run in constant time and may be called from
+ * interrupt context.
  */
 extern struct dma_xfer_item* dma_allocate_item(struct dma_channel *channel);
 
@@ -390,6 +521,60 @@ extern struct dma_xfer_item* dma_allocate_item(struct dma_channel *channel);
  * \param channel Channel pointer
  */
 extern void dma_free_item(struct dma_channel *channel);
+
+/**
+ * \brief Initialize a pool of linked list items declared with
+ * DMA_ITEM_POOL_DECLARE.
+ * \param pool Pool pointer
+ */
+extern void dma_initialize_item_pool(struct dma_item_pool *pool);
+
+/**
+ * \brief Select the pool the linked list items of a channel are allocated
+ * from.
+ * \param channel Channel pointer
+ * \param pool Pool pointer, or NULL for the default pool
+ * \return DMA_BUSY if the channel holds items, DMA_OK otherwise
+ */
+extern uint32_t dma_set_item_pool(struct dma_channel *channel,
+				  struct dma_item_pool *pool);
+
+/**
+ * \brief Get the statistics of a pool of linked list items.
+ * \param pool Pool pointer, or NULL for the default pool
+ * \param stats Pointer to the statistics to fill
+ */
+extern void dma_get_item_pool_stats(struct dma_item_pool *pool,
+				    struct dma_item_pool_stats *stats);
+
+#ifdef CONFIG_DMA_STATS
+
+/**
+ * \brief Account for the start of a transfer (used by the DMA drivers).
+ * \param stats Statistics of the channel
+ */
+extern void dma_stats_record_start(struct dma_channel_stats *stats);
+
+/**
+ * \brief Account for the end of a transfer (used by the DMA drivers).
+ * \param stats Statistics of the channel
+ * \param error true if the transfer ended on an error
+ */
+extern void dma_stats_record_end(struct dma_channel_stats *stats, bool error);
+
+/**
+ * \brief Print the statistics of all physical channels on the console:
+ * owner, transfer and error counts, bytes, bus utilization and latency
+ * histogram.
+ */
+extern void dma_dump_stats(void);
+
+/**
+ * \brief Clear the statistics of all physical channels.
+ */
+extern void dma_reset_stats(void);
+
+#endif /* CONFIG_DMA_STATS */
 /**     @}*/
 
 #endif /* _DMA_H_ */
@@ -0,0 +1,243 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Coherent memory pool and streaming mappings for DMA buffers.
+ *
+ * The pool lives in the ".region_ddr_nocache" section, which board_cfg_mmu
+ * maps non-cacheable. Blocks are multiples of a cache line and each starts
+ * with a one-line header. Free blocks are kept in a list sorted by address so
+ * that neighbours can be merged back when released.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Includes
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "compiler.h"
+#include "core/arm.h"
+#include "dma/dma_coherent.h"
+#include "misc/cache.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define BLOCK_MAGIC 0x444d4143u
+
+#define POOL_SIZE (DMA_COHERENT_POOL_SIZE & ~(L1_CACHE_BYTES - 1))
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+struct _block {
+	uint32_t size;		/* block size in bytes, header included */
+	uint32_t magic;		/* BLOCK_MAGIC while allocated */
+	struct _block *next;	/* next free block, sorted by address */
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+ALIGNED(L1_CACHE_BYTES) NOT_CACHED_DDR
+static uint8_t _pool[POOL_SIZE];
+
+static struct _block *_free_list;
+static uint32_t _free_bytes;
+static bool _initialized;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _pool_init(void)
+{
+	struct _block *block = (struct _block *)_pool;
+
+	block->size = POOL_SIZE;
+	block->magic = 0;
+	block->next = NULL;
+	_free_list = block;
+	_free_bytes = POOL_SIZE;
+	_initialized = true;
+}
+
+static bool _in_pool(const void *addr)
+{
+	return (const uint8_t *)addr >= _pool &&
+	       (const uint8_t *)addr < _pool + POOL_SIZE;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void *dma_alloc_coherent(uint32_t size)
+{
+	struct _block **prev, *block;
+	uint32_t needed;
+	uint32_t mask;
+
+	if (size == 0 || size > POOL_SIZE)
+		return NULL;
+	needed = L1_CACHE_BYTES + ROUND_UP_MULT(size, L1_CACHE_BYTES);
+
+	mask = irq_disable_save();
+	if (!_initialized)
+		_pool_init();
+
+	for (prev = &_free_list; *prev; prev = &(*prev)->next) {
+		block = *prev;
+		if (block->size < needed)
+			continue;
+
+		if (block->size - needed >= 2 * L1_CACHE_BYTES) {
+			/* split, keeping the tail in the free list */
+			struct _block *rest =
+				(struct _block *)((uint8_t *)block + needed);
+			rest->size = block->size - needed;
+			rest->magic = 0;
+			rest->next = block->next;
+			*prev = rest;
+			block->size = needed;
+		} else {
+			*prev = block->next;
+		}
+		block->magic = BLOCK_MAGIC;
+		block->next = NULL;
+		_free_bytes -= block->size;
+		irq_restore(mask);
+		return (uint8_t *)block + L1_CACHE_BYTES;
+	}
+
+	irq_restore(mask);
+	return NULL;
+}
+
+void dma_free_coherent(void *buf)
+{
+	struct _block **prev, *block;
+	uint32_t mask;
+
+	if (!buf)
+		return;
+	assert(_in_pool(buf) && IS_CACHE_ALIGNED(buf));
+
+	block = (struct _block *)((uint8_t *)buf - L1_CACHE_BYTES);
+	assert(block->magic == BLOCK_MAGIC);
+
+	mask = irq_disable_save();
+	block->magic = 0;
+	_free_bytes += block->size;
+
+	prev = &_free_list;
+	while (*prev && *prev < block)
+		prev = &(*prev)->next;
+
+	/* merge with the following free block */
+	if (*prev && (uint8_t *)block + block->size == (uint8_t *)*prev) {
+		block->size += (*prev)->size;
+		block->next = (*prev)->next;
+	} else {
+		block->next = *prev;
+	}
+
+	/* merge with the preceding free block */
+	if (prev != &_free_list) {
+		struct _block *before = (struct _block *)
+			((uint8_t *)prev - offsetof(struct _block, next));
+		if ((uint8_t *)before + before->size == (uint8_t *)block) {
+			before->size += block->size;
+			before->next = block->next;
+			irq_restore(mask);
+			return;
+		}
+	}
+	*prev = block;
+	irq_restore(mask);
+}
+
+uint32_t dma_coherent_get_free(void)
+{
+	if (!_initialized)
+		return POOL_SIZE;
+	return _free_bytes;
+}
+
+bool dma_is_coherent(const void *addr, uint32_t len)
+{
+	uint32_t start = (uint32_t)addr;
+
+	return start >= DMA_COHERENT_DDR_START &&
+	       len <= DMA_COHERENT_DDR_SIZE &&
+	       start - DMA_COHERENT_DDR_START <= DMA_COHERENT_DDR_SIZE - len;
+}
+
+void dma_stream_init(struct dma_stream *stream, void *buf, uint32_t len,
+		     enum dma_data_direction dir)
+{
+	stream->buf = buf;
+	stream->len = len;
+	stream->dir = dir;
+	stream->coherent = _in_pool(buf) || dma_is_coherent(buf, len);
+	stream->device_owned = false;
+}
+
+bool dma_stream_to_device(struct dma_stream *stream)
+{
+	if (stream->device_owned)
+		return false;
+
+	if (!stream->coherent) {
+		if (stream->dir == DMA_FROM_DEVICE)
+			cache_invalidate_region(stream->buf, stream->len);
+		else
+			cache_clean_region(stream->buf, stream->len);
+	}
+	stream->device_owned = true;
+	return true;
+}
+
+bool dma_stream_to_cpu(struct dma_stream *stream)
+{
+	if (!stream->device_owned)
+		return false;
+
+	if (!stream->coherent && stream->dir != DMA_TO_DEVICE)
+		cache_invalidate_region(stream->buf, stream->len);
+	stream->device_owned = false;
+	return true;
+}
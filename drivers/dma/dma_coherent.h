@@ -0,0 +1,150 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _DMA_COHERENT_H_
+#define _DMA_COHERENT_H_
+
+/*----------------------------------------------------------------------------
+ *        Includes
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Size (in bytes) of the coherent pool, carved from the non-cached DDR */
+#ifndef DMA_COHERENT_POOL_SIZE
+#define DMA_COHERENT_POOL_SIZE (64 * 1024)
+#endif
+
+/** Non-cached DDR window set up by board_cfg_mmu (ddr_nocache region of the
+ * linker scripts) */
+#ifndef DMA_COHERENT_DDR_START
+#define DMA_COHERENT_DDR_START 0x24000000u
+#endif
+#ifndef DMA_COHERENT_DDR_SIZE
+#define DMA_COHERENT_DDR_SIZE  (16 * 1024 * 1024)
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Direction of a streaming mapping */
+enum dma_data_direction {
+	DMA_TO_DEVICE,		/**< memory is read by the device */
+	DMA_FROM_DEVICE,	/**< memory is written by the device */
+	DMA_BIDIRECTIONAL,	/**< memory is read then written by the device */
+};
+
+/** Streaming mapping of a buffer shared between the CPU and a device */
+struct dma_stream {
+	void *buf;
+	uint32_t len;
+	uint8_t dir;		/**< enum dma_data_direction */
+	bool coherent;		/**< no cache maintenance needed */
+	volatile bool device_owned;
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Allocate a buffer from the coherent (non-cached) pool.
+ *
+ * The returned buffer is aligned on a cache line and never needs cache
+ * maintenance. As the memory is not cached, it is best suited to descriptors
+ * and small buffers shared with a device.
+ *
+ * \param size Size of the buffer in bytes
+ * \return Pointer to the buffer, or NULL if the pool is exhausted.
+ */
+extern void *dma_alloc_coherent(uint32_t size);
+
+/**
+ * \brief Return a buffer to the coherent pool.
+ *
+ * \param buf Buffer returned by dma_alloc_coherent (may be NULL)
+ */
+extern void dma_free_coherent(void *buf);
+
+/**
+ * \brief Get the number of bytes still available in the coherent pool.
+ */
+extern uint32_t dma_coherent_get_free(void);
+
+/**
+ * \brief Check if a memory region is mapped non-cacheable.
+ *
+ * \param addr Start of the region
+ * \param len Length of the region
+ * \return true if the whole region lies in the non-cached DDR window.
+ */
+extern bool dma_is_coherent(const void *addr, uint32_t len);
+
+/**
+ * \brief Describe a buffer for streaming DMA.
+ *
+ * The buffer is initially owned by the CPU. Buffers which are not coherent
+ * should be aligned on cache lines, as invalidation of the partial lines
+ * would also discard neighbouring data.
+ *
+ * \param stream Mapping to initialize
+ * \param buf Buffer
+ * \param len Length of the buffer in bytes
+ * \param dir Direction of the transfers
+ */
+extern void dma_stream_init(struct dma_stream *stream, void *buf,
+			    uint32_t len, enum dma_data_direction dir);
+
+/**
+ * \brief Hand the buffer over to the device, before starting the transfer.
+ *
+ * Cleans the buffer for DMA_TO_DEVICE and DMA_BIDIRECTIONAL, invalidates it
+ * for DMA_FROM_DEVICE. Nothing is done for coherent buffers.
+ *
+ * \return false if the buffer was already owned by the device.
+ */
+extern bool dma_stream_to_device(struct dma_stream *stream);
+
+/**
+ * \brief Give the buffer back to the CPU, once the transfer is done.
+ *
+ * Invalidates the buffer for DMA_FROM_DEVICE and DMA_BIDIRECTIONAL. Nothing
+ * is done for coherent buffers.
+ *
+ * \return false if the buffer was already owned by the CPU.
+ */
+extern bool dma_stream_to_cpu(struct dma_stream *stream);
+
+#endif /* _DMA_COHERENT_H_ */
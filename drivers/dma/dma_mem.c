@@ -0,0 +1,354 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Asynchronous memory copy and fill on top of the generic DMA layer.
+ *
+ * Requests are queued in a ring. When the dedicated channel is idle, the
+ * longest run of pending requests sharing the same transfer parameters is
+ * described by a single linked list and started at once. The completion
+ * callback of the channel notifies the requesters then starts the next run.
+ *
+ * The DMA only writes the whole cache lines of the destination, so that the
+ * invalidation done on completion cannot discard data of a neighbouring
+ * buffer; the CPU handles the partial lines at both ends.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Includes
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "core/arm.h"
+#include "dma/dma.h"
+#include "dma/dma_mem.h"
+#include "misc/cache.h"
+#include "ring.h"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+struct _dma_mem_req {
+	void *dst;
+	const void *src;	/* NULL for a fill request */
+	uint32_t len;
+	uint32_t head;		/* bytes before the first whole cache line of dst */
+	uint32_t dma_len;	/* whole cache lines transferred by the DMA */
+	uint8_t width;
+	uint8_t value;
+	dma_mem_callback_t cb;
+	void *arg;
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct {
+	struct dma_channel *channel;
+	bool no_channel;
+	volatile uint16_t head;
+	volatile uint16_t tail;
+	volatile uint16_t running;
+	struct _dma_mem_req reqs[DMA_MEM_QUEUE_SIZE];
+} _dma_mem;
+
+/** Fill patterns, one per queue slot, read by the DMA as a fixed source */
+CACHE_ALIGNED static uint32_t _dma_mem_patterns[DMA_MEM_QUEUE_SIZE];
+
+/** Linked list items of the running chain */
+CACHE_ALIGNED static struct dma_xfer_item _dma_mem_items[DMA_MEM_MAX_ITEMS];
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint8_t _dma_mem_get_width(uint32_t dst, uint32_t src, uint32_t len)
+{
+	uint32_t align = dst | src | len;
+
+	if ((align & 3) == 0)
+		return DMA_DATA_WIDTH_WORD;
+	else if ((align & 1) == 0)
+		return DMA_DATA_WIDTH_HALF_WORD;
+	else
+		return DMA_DATA_WIDTH_BYTE;
+}
+
+static uint32_t _dma_mem_items_needed(uint32_t len, uint8_t width)
+{
+	return ((len >> width) + DMA_MAX_BT_SIZE - 1) / DMA_MAX_BT_SIZE;
+}
+
+static void _dma_mem_cpu(struct _dma_mem_req *req, uint32_t offset,
+			 uint32_t len)
+{
+	uint8_t *dst = (uint8_t*)req->dst + offset;
+
+	if (req->src)
+		memcpy(dst, (const uint8_t*)req->src + offset, len);
+	else
+		memset(dst, req->value, len);
+}
+
+/* Complete the request at the tail of the queue. The partial cache lines at
+ * both ends of dst are never written by the DMA, as invalidating them could
+ * discard data written by the CPU next to the buffer: they are handled here
+ * by the CPU, in submission order. */
+static void _dma_mem_complete(struct _dma_mem_req *req, uint32_t status)
+{
+	uint32_t end = req->head + req->dma_len;
+
+	if (req->dma_len)
+		cache_invalidate_region((uint8_t*)req->dst + req->head,
+					req->dma_len);
+	if (status == DMA_OK) {
+		_dma_mem_cpu(req, 0, req->head);
+		_dma_mem_cpu(req, end, req->len - end);
+	}
+	RING_INC(_dma_mem.tail, DMA_MEM_QUEUE_SIZE);
+	if (req->cb)
+		req->cb(req->arg, status);
+}
+
+/* Start the longest run of pending requests, from the tail of the queue.
+ * Return false if the channel could not be configured. */
+static bool _dma_mem_start(void)
+{
+	struct dma_channel *ch = _dma_mem.channel;
+	struct dma_xfer_item_tmpl tmpl;
+	struct _dma_mem_req *first, *req;
+	uint16_t idx = _dma_mem.tail;
+	uint16_t count = 0;
+	uint32_t items = 0;
+
+	first = &_dma_mem.reqs[idx];
+
+	memset(&tmpl, 0, sizeof(tmpl));
+	tmpl.upd_sa_per_data = first->src != NULL;
+	tmpl.upd_da_per_data = 1;
+	tmpl.upd_sa_per_blk = 1;
+	tmpl.upd_da_per_blk = 1;
+	tmpl.data_width = first->width;
+	tmpl.chunk_size = DMA_CHUNK_SIZE_1;
+
+	while (idx != _dma_mem.head) {
+		uint32_t elems, offset;
+
+		req = &_dma_mem.reqs[idx];
+		/* On XDMAC the data width and the addressing modes are channel
+		 * settings, so only requests sharing them are chained */
+		if (req->dma_len == 0 || req->width != first->width ||
+		    (req->src == NULL) != (first->src == NULL))
+			break;
+		if (items + _dma_mem_items_needed(req->dma_len, req->width) > DMA_MEM_MAX_ITEMS)
+			break;
+
+		elems = req->dma_len >> req->width;
+		offset = req->head;
+		while (elems) {
+			uint32_t blk = elems < DMA_MAX_BT_SIZE ? elems : DMA_MAX_BT_SIZE;
+
+			tmpl.sa = req->src ? (const uint8_t*)req->src + offset
+					   : (const void*)&_dma_mem_patterns[idx];
+			tmpl.da = (uint8_t*)req->dst + offset;
+			tmpl.blk_size = blk;
+			dma_prepare_item(ch, &tmpl, &_dma_mem_items[items]);
+			if (items)
+				dma_link_item(ch, &_dma_mem_items[items - 1],
+					      &_dma_mem_items[items]);
+			items++;
+			elems -= blk;
+			offset += blk << req->width;
+		}
+		count++;
+		RING_INC(idx, DMA_MEM_QUEUE_SIZE);
+	}
+	dma_link_item(ch, &_dma_mem_items[items - 1], NULL);
+	cache_clean_region(_dma_mem_items, items * sizeof(struct dma_xfer_item));
+
+	if (dma_configure_sg_transfer(ch, &tmpl, _dma_mem_items) != DMA_OK)
+		return false;
+	_dma_mem.running = count;
+	if (dma_start_transfer(ch) != DMA_OK) {
+		_dma_mem.running = 0;
+		return false;
+	}
+	return true;
+}
+
+/* Process the pending requests until a DMA transfer is running or the queue
+ * is empty. Called with the channel idle, from a critical section or from the
+ * channel callback. */
+static void _dma_mem_run(void)
+{
+	struct _dma_mem_req *req;
+
+	while (!RING_EMPTY(_dma_mem.head, _dma_mem.tail)) {
+		req = &_dma_mem.reqs[_dma_mem.tail];
+		if (req->dma_len == 0) {
+			_dma_mem_complete(req, DMA_OK);
+			continue;
+		}
+		if (_dma_mem_start())
+			return;
+		/* The channel cannot be used, let the CPU handle the whole
+		 * request instead of stalling the queue */
+		req->head = 0;
+		req->dma_len = 0;
+	}
+}
+
+static void _dma_mem_callback(struct dma_channel *channel, void *arg)
+{
+	uint32_t status = dma_get_transfer_status(channel);
+	uint16_t count = _dma_mem.running;
+
+	while (count--)
+		_dma_mem_complete(&_dma_mem.reqs[_dma_mem.tail], status);
+	_dma_mem.running = 0;
+	_dma_mem_run();
+}
+
+static bool _dma_mem_get_channel(void)
+{
+	if (_dma_mem.channel)
+		return true;
+	if (_dma_mem.no_channel)
+		return false;
+
+	_dma_mem.channel = dma_allocate_channel(DMA_PERIPH_MEMORY,
+						DMA_PERIPH_MEMORY);
+	if (!_dma_mem.channel) {
+		/* Do not retry on each request, use the CPU instead */
+		_dma_mem.no_channel = true;
+		return false;
+	}
+	dma_set_callback(_dma_mem.channel, _dma_mem_callback, NULL);
+	return true;
+}
+
+static uint32_t _dma_mem_submit(void *dst, const void *src, uint8_t value,
+				uint32_t len, dma_mem_callback_t cb, void *arg)
+{
+	struct _dma_mem_req *req;
+	uint32_t mask, head, dma_len;
+	uint8_t width;
+
+	/* Only the whole cache lines of dst are left to the DMA */
+	head = -(uint32_t)dst & (L1_CACHE_BYTES - 1);
+	if (head > len)
+		head = len;
+	dma_len = (len - head) & ~(L1_CACHE_BYTES - 1);
+
+	if (dma_len < DMA_MEM_THRESHOLD || !_dma_mem_get_channel()) {
+		/* Use the CPU unless it would overtake a queued request */
+		if (len == 0 || !dma_mem_is_busy() || !_dma_mem.channel) {
+			if (src)
+				memcpy(dst, src, len);
+			else
+				memset(dst, value, len);
+			if (cb)
+				cb(arg, DMA_OK);
+			return DMA_OK;
+		}
+		/* Queued behind the pending requests, done by the CPU */
+		dma_len = 0;
+	}
+
+	width = _dma_mem_get_width((uint32_t)dst + head, (uint32_t)src + head,
+				   dma_len);
+	if (_dma_mem_items_needed(dma_len, width) > DMA_MEM_MAX_ITEMS)
+		return DMA_ERROR;
+
+	if (dma_len) {
+		if (src)
+			cache_clean_region((const uint8_t*)src + head, dma_len);
+		/* Write back dirty lines now, so they cannot be evicted over
+		 * the data written by the DMA */
+		cache_clean_region((uint8_t*)dst + head, dma_len);
+	}
+
+	mask = irq_disable_save();
+	if (!RING_SPACE(_dma_mem.head, _dma_mem.tail, DMA_MEM_QUEUE_SIZE)) {
+		irq_restore(mask);
+		return DMA_BUSY;
+	}
+	req = &_dma_mem.reqs[_dma_mem.head];
+	req->dst = dst;
+	req->src = src;
+	req->len = len;
+	req->head = dma_len ? head : 0;
+	req->dma_len = dma_len;
+	req->width = width;
+	req->value = value;
+	req->cb = cb;
+	req->arg = arg;
+	if (!src) {
+		_dma_mem_patterns[_dma_mem.head] = value * 0x01010101u;
+		cache_clean_region(&_dma_mem_patterns[_dma_mem.head], sizeof(uint32_t));
+	}
+	RING_INC(_dma_mem.head, DMA_MEM_QUEUE_SIZE);
+	if (!_dma_mem.running)
+		_dma_mem_run();
+	irq_restore(mask);
+
+	return DMA_OK;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+uint32_t dma_memcpy_async(void *dst, const void *src, uint32_t len,
+			  dma_mem_callback_t cb, void *arg)
+{
+	return _dma_mem_submit(dst, src, 0, len, cb, arg);
+}
+
+uint32_t dma_memset_async(void *dst, uint8_t value, uint32_t len,
+			  dma_mem_callback_t cb, void *arg)
+{
+	return _dma_mem_submit(dst, NULL, value, len, cb, arg);
+}
+
+bool dma_mem_is_busy(void)
+{
+	return !RING_EMPTY(_dma_mem.head, _dma_mem.tail);
+}
+
+void dma_mem_wait(void)
+{
+	while (dma_mem_is_busy())
+		dma_poll();
+}
@@ -0,0 +1,120 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _DMA_MEM_H_
+#define _DMA_MEM_H_
+
+/*----------------------------------------------------------------------------
+ *        Includes
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Requests shorter than this (in bytes) are handled by the CPU when no DMA
+ * request is pending */
+#ifndef DMA_MEM_THRESHOLD
+#define DMA_MEM_THRESHOLD  256
+#endif
+
+/** Number of requests that can be queued (one slot is kept free) */
+#ifndef DMA_MEM_QUEUE_SIZE
+#define DMA_MEM_QUEUE_SIZE 16
+#endif
+
+/** Number of linked list items used to chain queued requests */
+#ifndef DMA_MEM_MAX_ITEMS
+#define DMA_MEM_MAX_ITEMS  16
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Memory request completion callback, status is DMA_OK or DMA_ERROR */
+typedef void (*dma_mem_callback_t)(void *arg, uint32_t status);
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Queue a copy of len bytes from src to dst.
+ *
+ * Requests are processed in submission order. Requests queued while the DMA
+ * channel is busy are chained together and transferred in a single linked
+ * list transfer. Short requests are copied by the CPU, and the callback is
+ * invoked before returning, if nothing is pending. Cache maintenance of both
+ * buffers is handled by the service: the DMA only writes the whole cache lines
+ * of dst, the partial lines at both ends are copied by the CPU on completion.
+ * If the channel cannot be configured, the queued requests are completed by
+ * the CPU, possibly from a critical section.
+ *
+ * \param dst Destination buffer
+ * \param src Source buffer
+ * \param len Number of bytes to copy
+ * \param cb Callback invoked once the copy is done (may be NULL)
+ * \param arg Argument passed to the callback
+ * \return DMA_OK on success, DMA_BUSY if the queue is full, DMA_ERROR if the
+ * request is too large to be described.
+ */
+extern uint32_t dma_memcpy_async(void *dst, const void *src, uint32_t len,
+				 dma_mem_callback_t cb, void *arg);
+
+/**
+ * \brief Queue a fill of len bytes at dst with value.
+ *
+ * Same ordering, batching and cache rules as dma_memcpy_async.
+ *
+ * \param dst Destination buffer
+ * \param value Fill byte
+ * \param len Number of bytes to fill
+ * \param cb Callback invoked once the fill is done (may be NULL)
+ * \param arg Argument passed to the callback
+ * \return DMA_OK on success, DMA_BUSY if the queue is full, DMA_ERROR if the
+ * request is too large to be described.
+ */
+extern uint32_t dma_memset_async(void *dst, uint8_t value, uint32_t len,
+				 dma_mem_callback_t cb, void *arg);
+
+/**
+ * \brief Check if memory requests are still pending.
+ */
+extern bool dma_mem_is_busy(void);
+
+/**
+ * \brief Wait for all pending memory requests to complete.
+ */
+extern void dma_mem_wait(void);
+
+#endif /* _DMA_MEM_H_ */
@@ -0,0 +1,232 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Virtual DMA channels.
+ *
+ * Clients queue jobs on any number of virtual channels. Physical channels are
+ * only allocated while a job runs; when one is given back, the registered
+ * virtual channels are scanned by decreasing priority and the first ones with
+ * a pending job get the free physical channels.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Includes
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "core/arm.h"
+#include "dma/dma.h"
+#include "dma/dma_virt.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+/** Registered virtual channels, by decreasing priority */
+static struct dma_vchan *_vchans;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static inline bool _is_mem2mem(struct dma_vchan *vchan)
+{
+	return vchan->src == DMA_PERIPH_MEMORY && vchan->dest == DMA_PERIPH_MEMORY;
+}
+
+/* Length of the next run of a job, in data elements */
+static uint32_t _get_run_len(struct dma_vchan *vchan, struct dma_vjob *job)
+{
+	uint32_t left = job->cfg.len - job->done;
+
+	if (_is_mem2mem(vchan) && left > DMA_VIRT_SLICE)
+		return DMA_VIRT_SLICE;
+	return left;
+}
+
+static void _dma_vchan_callback(struct dma_channel *channel, void *arg);
+
+/* Start the head job of a virtual channel on its physical channel. Called
+ * with interrupts disabled. */
+static uint32_t _dma_vchan_start(struct dma_vchan *vchan)
+{
+	struct dma_vjob *job = vchan->head;
+	struct dma_xfer_cfg cfg = job->cfg;
+	uint32_t offset, status;
+
+	offset = job->done * DMA_DATA_WIDTH_IN_BYTE(cfg.data_width);
+	if (cfg.upd_sa_per_data)
+		cfg.sa = (uint8_t*)cfg.sa + offset;
+	if (cfg.upd_da_per_data)
+		cfg.da = (uint8_t*)cfg.da + offset;
+	cfg.len = _get_run_len(vchan, job);
+
+	dma_set_callback(vchan->phys, _dma_vchan_callback, vchan);
+	status = dma_configure_transfer(vchan->phys, &cfg);
+	if (status == DMA_OK)
+		status = dma_start_transfer(vchan->phys);
+	return status;
+}
+
+/* Give the physical channel back. Called with interrupts disabled. */
+static void _dma_vchan_release(struct dma_vchan *vchan)
+{
+	dma_free_channel(vchan->phys);
+	vchan->phys = NULL;
+}
+
+/* Remove the head job of a virtual channel. Called with interrupts
+ * disabled. */
+static struct dma_vjob *_dma_vchan_pop(struct dma_vchan *vchan)
+{
+	struct dma_vjob *job = vchan->head;
+
+	vchan->head = job->next;
+	if (vchan->head == NULL)
+		vchan->tail = NULL;
+	job->next = NULL;
+	return job;
+}
+
+static void _dma_vjob_complete(struct dma_vjob *job, uint32_t status)
+{
+	job->status = status;
+	if (job->cb)
+		job->cb(job, job->arg);
+}
+
+static void _dma_vchan_callback(struct dma_channel *channel, void *arg)
+{
+	struct dma_vchan *vchan = (struct dma_vchan *)arg;
+	struct dma_vjob *job = NULL;
+	uint32_t status = dma_get_transfer_status(channel);
+	uint32_t mask;
+
+	mask = irq_disable_save();
+	vchan->head->done += _get_run_len(vchan, vchan->head);
+	/* A bus error ends the job, the remaining slices are not run */
+	if (status != DMA_OK || vchan->head->done >= vchan->head->cfg.len)
+		job = _dma_vchan_pop(vchan);
+	/* Let the scheduler choose the next user of the channel, this is where
+	 * a sliced copy gets preempted */
+	_dma_vchan_release(vchan);
+	irq_restore(mask);
+
+	dma_vchan_schedule();
+
+	if (job)
+		_dma_vjob_complete(job, status);
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void dma_vchan_initialize(struct dma_vchan *vchan, uint8_t src,
+			  uint8_t dest, uint8_t priority)
+{
+	struct dma_vchan **prev;
+	uint32_t mask;
+
+	vchan->src = src;
+	vchan->dest = dest;
+	vchan->priority = priority;
+	vchan->phys = NULL;
+	vchan->head = NULL;
+	vchan->tail = NULL;
+
+	/* Insert after the channels of the same priority */
+	mask = irq_disable_save();
+	for (prev = &_vchans; *prev; prev = &(*prev)->next)
+		if ((*prev)->priority < priority)
+			break;
+	vchan->next = *prev;
+	*prev = vchan;
+	irq_restore(mask);
+}
+
+uint32_t dma_vchan_submit(struct dma_vchan *vchan, struct dma_vjob *job)
+{
+	uint32_t mask;
+
+	if (_is_mem2mem(vchan) && job->cfg.blk_size)
+		return DMA_ERROR;
+
+	job->status = DMA_BUSY;
+	job->done = 0;
+	job->next = NULL;
+
+	mask = irq_disable_save();
+	if (vchan->tail)
+		vchan->tail->next = job;
+	else
+		vchan->head = job;
+	vchan->tail = job;
+	irq_restore(mask);
+
+	dma_vchan_schedule();
+	return DMA_OK;
+}
+
+bool dma_vchan_is_busy(struct dma_vchan *vchan)
+{
+	return vchan->head != NULL;
+}
+
+void dma_vchan_schedule(void)
+{
+	struct dma_vchan *vchan;
+	struct dma_vjob *job;
+	uint32_t mask;
+
+	mask = irq_disable_save();
+	vchan = _vchans;
+	while (vchan) {
+		if (vchan->phys == NULL && vchan->head != NULL) {
+			vchan->phys = dma_allocate_channel(vchan->src, vchan->dest);
+			if (vchan->phys && _dma_vchan_start(vchan) != DMA_OK) {
+				/* Drop the job and restart the scan, the queues
+				 * may change in its callback */
+				_dma_vchan_release(vchan);
+				job = _dma_vchan_pop(vchan);
+				irq_restore(mask);
+				_dma_vjob_complete(job, DMA_ERROR);
+				mask = irq_disable_save();
+				vchan = _vchans;
+				continue;
+			}
+		}
+		vchan = vchan->next;
+	}
+	irq_restore(mask);
+}
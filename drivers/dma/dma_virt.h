@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _DMA_VIRT_H_
+#define _DMA_VIRT_H_
+
+/*----------------------------------------------------------------------------
+ *        Includes
+ *----------------------------------------------------------------------------*/
+
+#include "dma/dma.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Memory to memory jobs are run in slices of this many data elements, the
+ * physical channel being given back between slices */
+#ifndef DMA_VIRT_SLICE
+#define DMA_VIRT_SLICE 4096
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+struct dma_vjob;
+
+/** Job completion callback */
+typedef void (*dma_vjob_callback_t)(struct dma_vjob *job, void *arg);
+
+/** Transfer queued on a virtual channel. Owned by the client, it shall not be
+ * modified until its callback is invoked. */
+struct dma_vjob {
+	struct dma_xfer_cfg cfg;	/* transfer parameters, as for dma_configure_transfer */
+	dma_vjob_callback_t cb;		/* completion callback (may be NULL) */
+	void *arg;					/* callback argument */
+	uint32_t status;			/* DMA_OK once done, DMA_ERROR if it could not be configured or a bus error stopped it */
+
+	/* private */
+	uint32_t done;				/* data elements already transferred */
+	struct dma_vjob *next;
+};
+
+/** Virtual DMA channel. Owned by the client; any number of them can exist. */
+struct dma_vchan {
+	uint8_t src;				/* source peripheral ID */
+	uint8_t dest;				/* destination peripheral ID */
+	uint8_t priority;			/* higher values are scheduled first */
+
+	/* private */
+	struct dma_channel *phys;	/* physical channel while a job runs */
+	struct dma_vjob *head;		/* queued jobs, head is the running one */
+	struct dma_vjob *tail;
+	struct dma_vchan *next;		/* next virtual channel by priority */
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize and register a virtual channel.
+ *
+ * Unlike dma_allocate_channel, this never fails: jobs queued on the virtual
+ * channel wait for a physical channel to be available.
+ *
+ * \param vchan Virtual channel to initialize
+ * \param src Source peripheral ID, DMA_PERIPH_MEMORY for memory.
+ * \param dest Destination peripheral ID, DMA_PERIPH_MEMORY for memory.
+ * \param priority Scheduling priority, higher values first
+ */
+extern void dma_vchan_initialize(struct dma_vchan *vchan, uint8_t src,
+				 uint8_t dest, uint8_t priority);
+
+/**
+ * \brief Queue a job on a virtual channel.
+ *
+ * Jobs of a virtual channel run one at a time in submission order. Whenever a
+ * physical channel is free, the virtual channel with the highest priority and
+ * a pending job gets it. A memory to memory job gives its physical channel
+ * back every DMA_VIRT_SLICE data elements, so a long copy can be preempted by
+ * a job of higher priority.
+ *
+ * \param vchan Virtual channel
+ * \param job Job to queue
+ * \return DMA_OK, or DMA_ERROR if the job cannot be sliced (blk_size set on a
+ * memory to memory job)
+ */
+extern uint32_t dma_vchan_submit(struct dma_vchan *vchan, struct dma_vjob *job);
+
+/**
+ * \brief Check if a virtual channel has queued or running jobs.
+ * \param vchan Virtual channel
+ */
+extern bool dma_vchan_is_busy(struct dma_vchan *vchan);
+
+/**
+ * \brief Try to start pending jobs.
+ *
+ * Physical channels are given back to the scheduler when a virtual job
+ * completes. Call this function after freeing a channel obtained directly
+ * with dma_allocate_channel, so waiting jobs can use it.
+ */
+extern void dma_vchan_schedule(void);
+
+#endif /* _DMA_VIRT_H_ */
@@ -231,6 +231,13 @@ void dmac_set_control_a(Dmac *dmac, uint8_t channel,
 	dmac->DMAC_CH[channel].DMAC_CTRLA = config;
 }
 
+uint32_t dmac_get_control_a(Dmac *dmac, uint8_t channel)
+{
+	assert(dmac == DMAC0 || dmac == DMAC1);
+	assert(channel < DMAC_CHANNELS);
+	return dmac->DMAC_CH[channel].DMAC_CTRLA;
+}
+
 void dmac_set_control_b(Dmac *dmac, uint8_t channel,
 		uint32_t config)
 {
@@ -320,6 +320,14 @@ extern uint32_t dmac_get_descriptor_addr(Dmac *dmac, uint8_t channel);
  */
 extern void dmac_set_control_a(Dmac *dmac, uint8_t channel, uint32_t config);
 
+/**
+ * \brief Get control A register of the relevant channel of given DMA.
+ *
+ * \param dmac Pointer to the DMAC instance.
+ * \param channel Particular channel number.
+ */
+extern uint32_t dmac_get_control_a(Dmac *dmac, uint8_t channel);
+
 /**
  * \brief Set control B register for the relevant channel of given DMA.
  *
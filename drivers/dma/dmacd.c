@@ -57,6 +57,7 @@
  *        Includes
  *----------------------------------------------------------------------------*/
 
+#include "core/arm.h"
 #include "irq/irq.h"
 #include "peripherals/pmc.h"
 #include "dma/dmacd.h"
@@ -113,7 +114,12 @@ struct _dmacd_channel
 	uint8_t          dest_rxif;  /**< Destination RX Interface ID */
 	volatile uint32_t rep_count; /**< repeat count in auto mode */
 	volatile uint8_t state;      /**< Channel State */
-	char             dummy[4];   /** Aligned with dma_channel */
+	volatile uint8_t cyclic;     /**< Looping linked list transfer */
+	volatile uint8_t error;      /**< Last transfer stopped on a bus error */
+	char             dummy[28];  /** Aligned with dma_channel */
+#ifdef CONFIG_DMA_STATS
+	struct dma_channel_stats stats; /**< Transfer statistics */
+#endif
 };
 
 /** DMA driver instance */
@@ -125,6 +131,11 @@ struct _dmacd {
 
 static struct _dmacd _dmacd;
 
+#ifdef CONFIG_DMA_STATS
+/** Maximum number of linked list items walked to size a transfer */
+#define DMACD_STATS_MAX_ITEMS 1024
+#endif
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -135,6 +146,39 @@ static struct _dmacd _dmacd;
  */
 static uint32_t dmacd_prepare_channel(struct _dmacd_channel *channel);
 
+#ifdef CONFIG_DMA_STATS
+/**
+ * \brief Size in bytes of a buffer transfer described by its control A value.
+ */
+static inline uint32_t _dmacd_get_buffer_size(uint32_t ctrla)
+{
+	return ((ctrla & DMAC_CTRLA_BTSIZE_Msk) >> DMAC_CTRLA_BTSIZE_Pos)
+		<< ((ctrla & DMAC_CTRLA_SRC_WIDTH_Msk) >> DMAC_CTRLA_SRC_WIDTH_Pos);
+}
+
+/**
+ * \brief Size in bytes of a transfer about to be configured.
+ * A looping linked list is only accounted once.
+ */
+static uint32_t _dmacd_get_xfer_size(struct _dmacd_cfg *cfg, void *desc_addr)
+{
+	const struct _dma_desc *desc = desc_addr;
+	uint32_t count = 0, len = 0;
+
+	if (cfg->s_decr_fetch && cfg->d_decr_fetch)
+		return _dmacd_get_buffer_size(desc->ctrla)
+			* (cfg->trans_auto ? cfg->blocks + 1 : 1);
+
+	while (desc && count++ < DMACD_STATS_MAX_ITEMS) {
+		len += _dmacd_get_buffer_size(desc->ctrla);
+		desc = desc->desc;
+		if (desc == desc_addr)
+			break;
+	}
+	return len;
+}
+#endif
+
 static struct _dmacd_channel* _dmacd_channel(Dmac* dmac, uint32_t channel)
 {
 	int i;
@@ -169,7 +213,15 @@ static void dmacd_handler(uint32_t source, void* user_arg)
 		channel = _dmacd_channel(dmac, chan);
 		if (channel->state == DMACD_STATE_FREE)
 			continue;
-		if (gis & (DMAC_EBCISR_CBTC0 << chan)) {
+		if (gis & (DMAC_EBCISR_ERR0 << chan)) {
+			/* The channel is disabled on an AHB error */
+			channel->state = DMACD_STATE_DONE;
+			channel->error = 1;
+			exec = 1;
+#ifdef CONFIG_DMA_STATS
+			dma_stats_record_end(&channel->stats, true);
+#endif
+		} else if (gis & (DMAC_EBCISR_CBTC0 << chan)) {
 			if (channel->rep_count) {
 				if (channel->rep_count == 1) {
 					dmac_auto_clear(dmac, chan);
@@ -180,7 +232,13 @@ static void dmacd_handler(uint32_t source, void* user_arg)
 			} else {
 				channel->state = DMACD_STATE_DONE;
 				exec = 1;
+#ifdef CONFIG_DMA_STATS
+				dma_stats_record_end(&channel->stats, false);
+#endif
 			}
+		} else if (channel->cyclic && (gis & (DMAC_EBCISR_BTC0 << chan))) {
+			/* End of a period, the channel keeps running */
+			exec = 1;
 		}
 		/* Execute callback */
 		if (exec && channel->callback) {
@@ -236,7 +294,7 @@ void dmacd_poll(void)
 
 struct _dmacd_channel *dmacd_allocate_channel(uint8_t src, uint8_t dest)
 {
-	uint32_t i;
+	uint32_t i, mask;
 
 	/* Reject peripheral to peripheral transfers */
 	if (src != DMACD_PERIPH_MEMORY && dest != DMACD_PERIPH_MEMORY) {
@@ -247,41 +305,57 @@ struct _dmacd_channel *dmacd_allocate_channel(uint8_t src, uint8_t dest)
 		struct _dmacd_channel *channel = &_dmacd.channels[i];
 		Dmac *dmac = channel->dmac;
 
-		if (channel->state == DMACD_STATE_FREE) {
-			/* Check if source peripheral matches this channel controller */
-			if (src != DMACD_PERIPH_MEMORY)
-				if (!is_peripheral_on_dma_controller(src, dmac))
-					continue;
-
-			/* Check if destination peripheral matches this channel controller */
-			if (dest != DMACD_PERIPH_MEMORY)
-				if (!is_peripheral_on_dma_controller(dest, dmac))
-					continue;
-
-			/* Allocate the channel */
-			channel->state = DMACD_STATE_ALLOCATED;
-			channel->src_txif = get_peripheral_dma_channel(src, dmac, true);
-			channel->src_rxif = get_peripheral_dma_channel(src, dmac, false);
-			channel->dest_txif = get_peripheral_dma_channel(dest, dmac, true);
-			channel->dest_rxif = get_peripheral_dma_channel(dest, dmac, false);
-			dmacd_prepare_channel(channel);
-
-			return channel;
+		/* Check if source peripheral matches this channel controller */
+		if (src != DMACD_PERIPH_MEMORY)
+			if (!is_peripheral_on_dma_controller(src, dmac))
+				continue;
+
+		/* Check if destination peripheral matches this channel controller */
+		if (dest != DMACD_PERIPH_MEMORY)
+			if (!is_peripheral_on_dma_controller(dest, dmac))
+				continue;
+
+		/* Claim the channel, channels are also allocated from
+		 * interrupt context (see dma_vchan_schedule()) */
+		mask = irq_disable_save();
+		if (channel->state != DMACD_STATE_FREE) {
+			irq_restore(mask);
+			continue;
 		}
+		channel->state = DMACD_STATE_ALLOCATED;
+		irq_restore(mask);
+
+		/* Allocate the channel */
+		channel->error = 0;
+		channel->src_txif = get_peripheral_dma_channel(src, dmac, true);
+		channel->src_rxif = get_peripheral_dma_channel(src, dmac, false);
+		channel->dest_txif = get_peripheral_dma_channel(dest, dmac, true);
+		channel->dest_rxif = get_peripheral_dma_channel(dest, dmac, false);
+#ifdef CONFIG_DMA_STATS
+		channel->stats.src = src;
+		channel->stats.dest = dest;
+#endif
+		dmacd_prepare_channel(channel);
+
+		return channel;
 	}
 	return NULL;
 }
 
 uint32_t dmacd_free_channel(struct _dmacd_channel *channel)
 {
+	uint32_t mask = irq_disable_save();
+
 	switch (channel->state) {
 	case DMACD_STATE_STARTED:
+		irq_restore(mask);
 		return DMACD_BUSY;
 	case DMACD_STATE_ALLOCATED:
 	case DMACD_STATE_DONE:
 		channel->state = DMACD_STATE_FREE;
 		break;
 	}
+	irq_restore(mask);
 	return DMACD_OK;
 }
 
@@ -338,6 +412,13 @@ bool dmacd_is_transfer_done(struct _dmacd_channel *channel)
 			&& (channel->state != DMACD_STATE_SUSPENDED));
 }
 
+uint32_t dmacd_get_transfer_status(struct _dmacd_channel *channel)
+{
+	if (!dmacd_is_transfer_done(channel))
+		return DMACD_BUSY;
+	return channel->error ? DMACD_ERROR : DMACD_OK;
+}
+
 uint32_t dmacd_configure_transfer(struct _dmacd_channel *channel,
 		struct _dmacd_cfg *cfg,
 		void *desc_addr)
@@ -371,6 +452,9 @@ uint32_t dmacd_configure_transfer(struct _dmacd_channel *channel,
 	dmac_get_global_isr(dmac);
 	dmac_get_channel_status(dmac);
 
+#ifdef CONFIG_DMA_STATS
+	channel->stats.pending_bytes = _dmacd_get_xfer_size(cfg, desc_addr);
+#endif
 	/* if DMAC_CTRLBx.AUTO bit is enabled, and source or destination is not fetched
 		from linker list, set the channel with AUTO mode, in this mode, the hardware
 		sets the Buffer Transfer Completed Interrupt when the buffer transfer has
@@ -402,6 +486,33 @@ uint32_t dmacd_configure_transfer(struct _dmacd_channel *channel,
 	return DMACD_OK;
 }
 
+uint32_t dmacd_rearm_transfer(struct _dmacd_channel *channel,
+		void *sa, void *da, uint32_t btsize)
+{
+	Dmac *dmac = channel->dmac;
+	uint32_t ctrla;
+
+	if (channel->state == DMACD_STATE_FREE)
+		return DMACD_ERROR;
+	else if (channel->state == DMACD_STATE_STARTED)
+		return DMACD_BUSY;
+
+	/* Keep the widths and chunk sizes of the previous transfer */
+	ctrla = dmac_get_control_a(dmac, channel->id);
+	ctrla &= ~(DMAC_CTRLA_BTSIZE_Msk | DMAC_CTRLA_DONE);
+	ctrla |= DMAC_CTRLA_BTSIZE(btsize);
+
+	channel->rep_count = 0;
+	dmac_set_descriptor_addr(dmac, channel->id, 0, 0);
+	dmac_set_src_addr(dmac, channel->id, sa);
+	dmac_set_dest_addr(dmac, channel->id, da);
+	dmac_set_control_a(dmac, channel->id, ctrla);
+#ifdef CONFIG_DMA_STATS
+	channel->stats.pending_bytes = _dmacd_get_buffer_size(ctrla);
+#endif
+	return DMACD_OK;
+}
+
 uint32_t dmacd_start_transfer(struct _dmacd_channel *channel)
 {
 	if (channel->state == DMACD_STATE_FREE)
@@ -410,7 +521,11 @@ uint32_t dmacd_start_transfer(struct _dmacd_channel *channel)
 		return DMACD_BUSY;
 
 	/* Change state to 'started' */
+	channel->error = 0;
 	channel->state = DMACD_STATE_STARTED;
+#ifdef CONFIG_DMA_STATS
+	dma_stats_record_start(&channel->stats);
+#endif
 
 	/* Start DMA transfer */
 	if (!_dmacd.polling) {
@@ -482,4 +597,13 @@ uint32_t dmacd_get_desc_addr(struct _dmacd_channel *channel)
 
 	return dmac_get_descriptor_addr(dmac, channel->id);
 }
+
+#ifdef CONFIG_DMA_STATS
+struct dma_channel_stats *dmacd_get_stats(uint32_t index)
+{
+	if (index >= DMACD_CHANNELS)
+		return NULL;
+	return &_dmacd.channels[index].stats;
+}
+#endif
 /**@}*/
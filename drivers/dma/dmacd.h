@@ -160,6 +160,17 @@ extern uint32_t dmacd_set_callback(struct _dmacd_channel *channel,
 extern uint32_t dmacd_configure_transfer(struct _dmacd_channel *channel,
 		struct _dmacd_cfg *cfg,  void *desc_addr);
 
+/**
+ * \brief Update the addresses and length of a channel configured for a
+ * single buffer transfer, keeping all other parameters.
+ * \param channel Channel pointer
+ * \param sa Source address
+ * \param da Destination address
+ * \param btsize Buffer transfer size
+ */
+extern uint32_t dmacd_rearm_transfer(struct _dmacd_channel *channel,
+		void *sa, void *da, uint32_t btsize);
+
 /**
  * \brief Start DMA transfer.
  * \param channel Channel pointer
@@ -172,6 +183,14 @@ extern uint32_t dmacd_start_transfer(struct _dmacd_channel *channel);
  */
 extern bool dmacd_is_transfer_done(struct _dmacd_channel *channel);
 
+/**
+ * \brief Get the status of the last transfer of a DMA channel.
+ * \param channel Channel pointer
+ * \return DMACD_OK, DMACD_BUSY if the transfer is not finished, or
+ * DMACD_ERROR if it has been stopped by a bus error.
+ */
+extern uint32_t dmacd_get_transfer_status(struct _dmacd_channel *channel);
+
 /**
  * \brief Stop DMA transfer.
  * \param channel Channel pointer
@@ -208,6 +227,17 @@ extern uint32_t dmacd_get_transferred_data_len(struct _dmacd_channel *channel);
  * \param channel Channel pointer
  */
 extern uint32_t dmacd_get_desc_addr(struct _dmacd_channel *channel);
+
+#ifdef CONFIG_DMA_STATS
+struct dma_channel_stats;
+
+/**
+ * \brief Get the statistics of a channel.
+ * \param index Channel index, over all controllers
+ * \return Pointer to the statistics, NULL if index is out of range
+ */
+extern struct dma_channel_stats *dmacd_get_stats(uint32_t index);
+#endif
 /**     @}*/
 
 /**@}*/
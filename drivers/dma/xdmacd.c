@@ -57,6 +57,7 @@
  *        Includes
  *----------------------------------------------------------------------------*/
 
+#include "core/arm.h"
 #include "irq/irq.h"
 #include "peripherals/pmc.h"
 #include "dma/xdmacd.h"
@@ -110,7 +111,12 @@ struct _xdmacd_channel
 	uint8_t          dest_txif; /**< Destination TX Interface ID */
 	uint8_t          dest_rxif; /**< Destination RX Interface ID */
 	volatile uint8_t state;     /**< Channel State */
-	char             dummy[4];  /** Aligned with dma_channel */
+	volatile uint8_t cyclic;    /**< Looping linked list transfer */
+	volatile uint8_t error;     /**< Last transfer stopped on a bus error */
+	char             dummy[28]; /** Aligned with dma_channel */
+#ifdef CONFIG_DMA_STATS
+	struct dma_channel_stats stats; /**< Transfer statistics */
+#endif
 };
 
 /** DMA driver instance */
@@ -122,6 +128,11 @@ struct _xdmacd {
 
 static struct _xdmacd _xdmacd;
 
+#ifdef CONFIG_DMA_STATS
+/** Maximum number of linked list items walked to size a transfer */
+#define XDMACD_STATS_MAX_ITEMS 1024
+#endif
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -132,6 +143,33 @@ static struct _xdmacd _xdmacd;
  */
 static uint32_t xdmacd_prepare_channel(struct _xdmacd_channel *channel);
 
+#ifdef CONFIG_DMA_STATS
+/**
+ * \brief Size in bytes of a transfer about to be configured.
+ * A looping linked list is only accounted once.
+ */
+static uint32_t _xdmacd_get_xfer_size(struct _xdmacd_cfg *cfg,
+		uint32_t desc_cntrl, void *desc_addr)
+{
+	const struct _xdmacd_desc_view1 *item = desc_addr;
+	uint32_t width = 1 << ((cfg->cfg & XDMAC_CC_DWIDTH_Msk) >> XDMAC_CC_DWIDTH_Pos);
+	uint32_t count = 0, len = 0;
+
+	if ((desc_cntrl & XDMAC_CNDC_NDE) != XDMAC_CNDC_NDE_DSCR_FETCH_EN)
+		return (cfg->ubc & XDMAC_CUBC_UBLEN_Msk) * (cfg->bc + 1) * width;
+
+	while (item && count++ < XDMACD_STATS_MAX_ITEMS) {
+		len += item->mbr_ubc & XDMAC_CUBC_UBLEN_Msk;
+		if (!(item->mbr_ubc & XDMA_UBC_NDE_FETCH_EN))
+			break;
+		item = item->mbr_nda;
+		if (item == desc_addr)
+			break;
+	}
+	return len * width;
+}
+#endif
+
 static struct _xdmacd_channel* _xdmacd_channel(Xdmac* dmac, uint32_t channel)
 {
 	int i;
@@ -172,6 +210,13 @@ static void xdmacd_handler(uint32_t source, void* user_arg)
 		if (!(gcs & (1 << chan))) {
 			uint32_t cis = xdmac_get_channel_isr(xdmac, chan);
 
+			/* The channel is disabled on a bus error */
+			if (cis & (XDMAC_CIS_RBEIS | XDMAC_CIS_WBEIS | XDMAC_CIS_ROIS)) {
+				channel->state = XDMACD_STATE_DONE;
+				channel->error = 1;
+				exec = 1;
+			}
+
 			if (cis & XDMAC_CIS_BIS) {
 				if (!(xdmac_get_channel_it_mask(xdmac, chan) & XDMAC_CIM_LIM)) {
 					channel->state = XDMACD_STATE_DONE;
@@ -188,6 +233,14 @@ static void xdmacd_handler(uint32_t source, void* user_arg)
 				channel->state = XDMACD_STATE_DONE;
 				exec = 1;
 			}
+#ifdef CONFIG_DMA_STATS
+			if (exec)
+				dma_stats_record_end(&channel->stats, channel->error);
+#endif
+		} else if (channel->cyclic) {
+			/* End of a period, the channel keeps running */
+			if (xdmac_get_channel_isr(xdmac, chan) & XDMAC_CIS_BIS)
+				exec = 1;
 		}
 
 		/* Execute callback */
@@ -245,7 +298,7 @@ void xdmacd_poll(void)
 
 struct _xdmacd_channel *xdmacd_allocate_channel(uint8_t src, uint8_t dest)
 {
-	uint32_t i;
+	uint32_t i, mask;
 
 	/* Reject peripheral to peripheral transfers */
 	if (src != XDMACD_PERIPH_MEMORY && dest != XDMACD_PERIPH_MEMORY) {
@@ -256,42 +309,58 @@ struct _xdmacd_channel *xdmacd_allocate_channel(uint8_t src, uint8_t dest)
 		struct _xdmacd_channel *channel = &_xdmacd.channels[i];
 		Xdmac *xdmac = channel->xdmac;
 
-		if (channel->state == XDMACD_STATE_FREE) {
-			/* Check if source peripheral matches this channel controller */
-			if (src != XDMACD_PERIPH_MEMORY)
-				if (!is_peripheral_on_xdma_controller(src, xdmac))
-					continue;
-
-			/* Check if destination peripheral matches this channel controller */
-			if (dest != XDMACD_PERIPH_MEMORY)
-				if (!is_peripheral_on_xdma_controller(dest, xdmac))
-					continue;
-
-			/* Allocate the channel */
-			channel->state = XDMACD_STATE_ALLOCATED;
-			channel->src_txif = get_peripheral_xdma_channel(src, xdmac, true);
-			channel->src_rxif = get_peripheral_xdma_channel(src, xdmac, false);
-			channel->dest_txif = get_peripheral_xdma_channel(dest, xdmac, true);
-			channel->dest_rxif = get_peripheral_xdma_channel(dest, xdmac, false);
+		/* Check if source peripheral matches this channel controller */
+		if (src != XDMACD_PERIPH_MEMORY)
+			if (!is_peripheral_on_xdma_controller(src, xdmac))
+				continue;
+
+		/* Check if destination peripheral matches this channel controller */
+		if (dest != XDMACD_PERIPH_MEMORY)
+			if (!is_peripheral_on_xdma_controller(dest, xdmac))
+				continue;
+
+		/* Claim the channel, channels are also allocated from
+		 * interrupt context (see dma_vchan_schedule()) */
+		mask = irq_disable_save();
+		if (channel->state != XDMACD_STATE_FREE) {
+			irq_restore(mask);
+			continue;
+		}
+		channel->state = XDMACD_STATE_ALLOCATED;
+		irq_restore(mask);
+
+		/* Allocate the channel */
+		channel->error = 0;
+		channel->src_txif = get_peripheral_xdma_channel(src, xdmac, true);
+		channel->src_rxif = get_peripheral_xdma_channel(src, xdmac, false);
+		channel->dest_txif = get_peripheral_xdma_channel(dest, xdmac, true);
+		channel->dest_rxif = get_peripheral_xdma_channel(dest, xdmac, false);
+#ifdef CONFIG_DMA_STATS
+		channel->stats.src = src;
+		channel->stats.dest = dest;
+#endif
 
-			xdmacd_prepare_channel(channel);
+		xdmacd_prepare_channel(channel);
 
-			return channel;
-		}
+		return channel;
 	}
 	return NULL;
 }
 
 uint32_t xdmacd_free_channel(struct _xdmacd_channel *channel)
 {
+	uint32_t mask = irq_disable_save();
+
 	switch (channel->state) {
 	case XDMACD_STATE_STARTED:
+		irq_restore(mask);
 		return XDMACD_BUSY;
 	case XDMACD_STATE_ALLOCATED:
 	case XDMACD_STATE_DONE:
 		channel->state = XDMACD_STATE_FREE;
 		break;
 	}
+	irq_restore(mask);
 	return XDMACD_OK;
 }
 
@@ -350,6 +419,13 @@ bool xdmacd_is_transfer_done(struct _xdmacd_channel *channel)
 			&& (channel->state != XDMACD_STATE_SUSPENDED));
 }
 
+uint32_t xdmacd_get_transfer_status(struct _xdmacd_channel *channel)
+{
+	if (!xdmacd_is_transfer_done(channel))
+		return XDMACD_BUSY;
+	return channel->error ? XDMACD_ERROR : XDMACD_OK;
+}
+
 uint32_t xdmacd_configure_transfer(struct _xdmacd_channel *channel,
 				  struct _xdmacd_cfg *cfg,
 				  uint32_t desc_cntrl,
@@ -379,6 +455,9 @@ uint32_t xdmacd_configure_transfer(struct _xdmacd_channel *channel,
 	xdmac_get_global_isr(xdmac);
 	xdmac_get_channel_isr(xdmac, channel->id);
 
+#ifdef CONFIG_DMA_STATS
+	channel->stats.pending_bytes = _xdmacd_get_xfer_size(cfg, desc_cntrl, desc_addr);
+#endif
 	if ((desc_cntrl & XDMAC_CNDC_NDE) == XDMAC_CNDC_NDE_DSCR_FETCH_EN) {
 		/* Linked List is enabled */
 		if (first_view <= XDMAC_CNDC_NDVIEW_NDV2) {
@@ -394,7 +473,12 @@ uint32_t xdmacd_configure_transfer(struct _xdmacd_channel *channel,
 					 XDMAC_CID_BID | XDMAC_CID_DID |
 					 XDMAC_CID_FID | XDMAC_CID_RBEID |
 					 XDMAC_CID_WBEID | XDMAC_CID_ROID);
-		xdmac_enable_channel_it(xdmac, channel->id, XDMAC_CIE_LIE);
+		if (channel->cyclic)
+			/* Interrupt at the end of each descriptor */
+			xdmac_enable_channel_it(xdmac, channel->id,
+						XDMAC_CIE_LIE | XDMAC_CIE_BIE);
+		else
+			xdmac_enable_channel_it(xdmac, channel->id, XDMAC_CIE_LIE);
 	} else {
 		/* Linked List is disabled. */
 		xdmac_set_src_addr(xdmac, channel->id, cfg->sa);
@@ -416,6 +500,29 @@ uint32_t xdmacd_configure_transfer(struct _xdmacd_channel *channel,
 	return XDMACD_OK;
 }
 
+uint32_t xdmacd_rearm_transfer(struct _xdmacd_channel *channel,
+		void *sa, void *da, uint32_t ubc)
+{
+	Xdmac *xdmac = channel->xdmac;
+
+	if (channel->state == XDMACD_STATE_FREE)
+		return XDMACD_ERROR;
+	else if (channel->state == XDMACD_STATE_STARTED)
+		return XDMACD_BUSY;
+
+	/* Clear status */
+	xdmac_get_channel_isr(xdmac, channel->id);
+
+	xdmac_set_src_addr(xdmac, channel->id, sa);
+	xdmac_set_dest_addr(xdmac, channel->id, da);
+	xdmac_set_microblock_control(xdmac, channel->id, ubc);
+#ifdef CONFIG_DMA_STATS
+	channel->stats.pending_bytes = ubc << ((xdmac_get_channel_config(xdmac, channel->id)
+			& XDMAC_CC_DWIDTH_Msk) >> XDMAC_CC_DWIDTH_Pos);
+#endif
+	return XDMACD_OK;
+}
+
 uint32_t xdmacd_start_transfer(struct _xdmacd_channel *channel)
 {
 	if (channel->state == XDMACD_STATE_FREE)
@@ -424,7 +531,11 @@ uint32_t xdmacd_start_transfer(struct _xdmacd_channel *channel)
 		return XDMACD_BUSY;
 
 	/* Change state to 'started' */
+	channel->error = 0;
 	channel->state = XDMACD_STATE_STARTED;
+#ifdef CONFIG_DMA_STATS
+	dma_stats_record_start(&channel->stats);
+#endif
 
 	/* Start DMA transfer */
 	xdmac_enable_channel(channel->xdmac, channel->id);
@@ -502,4 +613,13 @@ void xdmacd_fifo_flush(struct _xdmacd_channel *channel)
 	xdmac_fifo_flush(xdmac, channel->id);
 }
 
+#ifdef CONFIG_DMA_STATS
+struct dma_channel_stats *xdmacd_get_stats(uint32_t index)
+{
+	if (index >= XDMACD_CHANNELS)
+		return NULL;
+	return &_xdmacd.channels[index].stats;
+}
+#endif
+
 /**@}*/
@@ -209,6 +209,17 @@ extern uint32_t xdmacd_set_callback(struct _xdmacd_channel *channel,
 extern uint32_t xdmacd_configure_transfer(struct _xdmacd_channel *channel,
 		struct _xdmacd_cfg *cfg, uint32_t desc_cntrl, void *desc_addr);
 
+/**
+ * \brief Update the addresses and length of a channel configured for a
+ * single block transfer, keeping all other parameters.
+ * \param channel Channel pointer
+ * \param sa Source address
+ * \param da Destination address
+ * \param ubc Microblock length
+ */
+extern uint32_t xdmacd_rearm_transfer(struct _xdmacd_channel *channel,
+		void *sa, void *da, uint32_t ubc);
+
 /**
  * \brief Start DMA transfer.
  * \param channel Channel pointer
@@ -221,6 +232,14 @@ extern uint32_t xdmacd_start_transfer(struct _xdmacd_channel *channel);
  */
 extern bool xdmacd_is_transfer_done(struct _xdmacd_channel *channel);
 
+/**
+ * \brief Get the status of the last transfer of a DMA channel.
+ * \param channel Channel pointer
+ * \return XDMACD_OK, XDMACD_BUSY if the transfer is not finished, or
+ * XDMACD_ERROR if it has been stopped by a bus error.
+ */
+extern uint32_t xdmacd_get_transfer_status(struct _xdmacd_channel *channel);
+
 /**
  * \brief Stop DMA transfer.
  * \param channel Channel pointer
@@ -258,6 +277,17 @@ extern uint32_t xdmacd_get_desc_addr(struct _xdmacd_channel *channel);
  */
 extern void xdmacd_fifo_flush(struct _xdmacd_channel *channel);
 
+#ifdef CONFIG_DMA_STATS
+struct dma_channel_stats;
+
+/**
+ * \brief Get the statistics of a channel.
+ * \param index Channel index, over all controllers
+ * \return Pointer to the statistics, NULL if index is out of range
+ */
+extern struct dma_channel_stats *xdmacd_get_stats(uint32_t index);
+#endif
+
 /**     @}*/
 
 /**@}*/
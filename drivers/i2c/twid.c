@@ -174,8 +174,6 @@ static void _twid_dma_read_callback(struct dma_channel* channel, void* args)
 
 	cache_invalidate_region(desc->dma.rx.cfg.da, desc->dma.rx.cfg.len);
 
-	dma_free_channel(channel);
-
 	if (_check_rx_timeout(desc)) {
 		mutex_unlock(&desc->mutex);
 		return;
@@ -204,16 +202,32 @@ static void _twid_dma_read_callback(struct dma_channel* channel, void* args)
 	mutex_unlock(&desc->mutex);
 }
 
-static void _twid_dma_read(struct _twi_desc* desc, struct _buffer* buffer)
+static void _twid_dma_write_callback(struct dma_channel* channel, void* args);
+
+static void _twid_dma_reserve(struct _twi_desc* desc)
 {
 	uint32_t id = get_twi_id_from_addr(desc->addr);
 
 	assert(id < ID_PERIPH_COUNT);
 
-	memset(&desc->dma.rx.cfg, 0, sizeof(desc->dma.rx.cfg));
+	/* Channels are kept between transfers, and only rearmed */
+	if (!desc->dma.rx.channel) {
+		desc->dma.rx.channel = dma_allocate_channel(id, DMA_PERIPH_MEMORY);
+		assert(desc->dma.rx.channel);
+		dma_set_callback(desc->dma.rx.channel, _twid_dma_read_callback, (void*)desc);
+	}
+	if (!desc->dma.tx.channel) {
+		desc->dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
+		assert(desc->dma.tx.channel);
+		dma_set_callback(desc->dma.tx.channel, _twid_dma_write_callback, (void*)desc);
+	}
+}
 
-	desc->dma.rx.channel = dma_allocate_channel(id, DMA_PERIPH_MEMORY);
-	assert(desc->dma.rx.channel);
+static void _twid_dma_read(struct _twi_desc* desc, struct _buffer* buffer)
+{
+	_twid_dma_reserve(desc);
+
+	memset(&desc->dma.rx.cfg, 0, sizeof(desc->dma.rx.cfg));
 
 	desc->dma.rx.cfg.sa = (void*)&desc->addr->TWI_RHR;
 	desc->dma.rx.cfg.da = buffer->data;
@@ -243,7 +257,6 @@ static void _twid_dma_read(struct _twi_desc* desc, struct _buffer* buffer)
 #endif
 	desc->dma.rx.cfg.chunk_size = DMA_CHUNK_SIZE_1;
 	dma_configure_transfer(desc->dma.rx.channel, &desc->dma.rx.cfg);
-	dma_set_callback(desc->dma.rx.channel, _twid_dma_read_callback, (void*)desc);
 	dma_start_transfer(desc->dma.rx.channel);
 
 	if (desc->flags & TWID_BUF_ATTR_START)
@@ -254,8 +267,6 @@ static void _twid_dma_write_callback(struct dma_channel* channel, void* args)
 {
 	struct _twi_desc* desc = (struct _twi_desc *)args;
 
-	dma_free_channel(channel);
-
 	if (_check_tx_timeout(desc)) {
 		mutex_unlock(&desc->mutex);
 		return;
@@ -277,15 +288,10 @@ static void _twid_dma_write_callback(struct dma_channel* channel, void* args)
 
 static void _twid_dma_write(struct _twi_desc* desc, struct _buffer* buffer)
 {
-	uint32_t id = get_twi_id_from_addr(desc->addr);
-
-	assert(id < ID_PERIPH_COUNT);
+	_twid_dma_reserve(desc);
 
 	memset(&desc->dma.tx.cfg, 0x0, sizeof(desc->dma.tx.cfg));
 
-	desc->dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
-	assert(desc->dma.tx.channel);
-
 	desc->dma.tx.cfg.sa = buffer->data;
 	desc->dma.tx.cfg.da = (void*)&desc->addr->TWI_THR;
 	desc->dma.tx.cfg.upd_sa_per_data = 1;
@@ -314,7 +320,6 @@ static void _twid_dma_write(struct _twi_desc* desc, struct _buffer* buffer)
 #endif
 	desc->dma.tx.cfg.chunk_size = DMA_CHUNK_SIZE_1;
 	dma_configure_transfer(desc->dma.tx.channel, &desc->dma.tx.cfg);
-	dma_set_callback(desc->dma.tx.channel, _twid_dma_write_callback, (void*)desc);
 	cache_clean_region(desc->dma.tx.cfg.sa, desc->dma.tx.cfg.len);
 	dma_start_transfer(desc->dma.tx.channel);
 }
@@ -675,6 +680,9 @@ void twid_configure(struct _twi_desc* desc)
 #endif
 
 	desc->mutex = 0;
+
+	if (desc->transfer_mode == TWID_MODE_DMA)
+		_twid_dma_reserve(desc);
 }
 
 void twid_slave_configure(struct _twi_slave_desc *desc, struct _twi_slave_ops* ops)
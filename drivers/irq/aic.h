@@ -116,6 +116,16 @@ extern void aic_enable(uint32_t source);
  */
 extern void aic_disable(uint32_t source);
 
+/**
+ * \brief Set the pending flag of the given source (ID_xxx) by software.
+ *
+ * The source must be configured as edge-triggered, the flag is then cleared
+ * when the interrupt is acknowledged.
+ *
+ * \param source  Interrupt source to trigger
+ */
+extern void aic_set_pending(uint32_t source);
+
 /**
  * \brief Get the current interrupt source number
  *
@@ -34,6 +34,8 @@
 #include "chip.h"
 #include "trace.h"
 
+#include "core/arm.h"
+
 #include "irq/aic.h"
 #include "irq/irq.h"
 #include "peripherals/matrix.h"
@@ -95,6 +97,10 @@ static Aic* _get_aic_instance(uint32_t source)
  *        Exported functions
  *----------------------------------------------------------------------------*/
 
+/* AIC_SSR selects the source the other registers apply to. Interrupt
+ * handlers select sources too (e.g. aic_set_pending()), every SSR and
+ * register sequence thus runs with IRQs masked. */
+
 void aic_initialize(aic_handler_t irq_handler)
 {
 	/* Disable interrupts at core level */
@@ -117,8 +123,11 @@ void aic_initialize(aic_handler_t irq_handler)
 void aic_set_source_vector(uint32_t source, aic_handler_t handler)
 {
 	Aic *aic = _get_aic_instance(source);
+	uint32_t mask = irq_disable_save();
+
 	aic->AIC_SSR = AIC_SSR_INTSEL(source);
 	aic->AIC_SVR = (uint32_t)handler;
+	irq_restore(mask);
 }
 
 void aic_set_spurious_vector(aic_handler_t handler)
@@ -132,7 +141,7 @@ void aic_set_spurious_vector(aic_handler_t handler)
 
 void aic_configure_mode(uint32_t source, enum _irq_mode mode)
 {
-	uint32_t srctype;
+	uint32_t srctype, mask;
 
 	switch (mode) {
 	case IRQ_MODE_HIGH_LEVEL:
@@ -152,24 +161,30 @@ void aic_configure_mode(uint32_t source, enum _irq_mode mode)
 	}
 
 	Aic* aic = _get_aic_instance(source);
+	mask = irq_disable_save();
 	aic->AIC_SSR = source;
 	aic->AIC_IDCR = AIC_IDCR_INTD;
 	aic->AIC_SMR = (aic->AIC_SMR & ~AIC_SMR_SRCTYPE_Msk) | srctype;
 	aic->AIC_ICCR = AIC_ICCR_INTCLR;
+	irq_restore(mask);
 }
 
 void aic_configure_priority(uint32_t source, uint8_t priority)
 {
 	Aic* aic = _get_aic_instance(source);
+	uint32_t mask = irq_disable_save();
+
 	aic->AIC_SSR = source;
 	aic->AIC_IDCR = AIC_IDCR_INTD;
 	aic->AIC_SMR = (aic->AIC_SMR & ~AIC_SMR_PRIOR_Msk) | AIC_SMR_PRIOR(priority);
 	aic->AIC_ICCR = AIC_ICCR_INTCLR;
+	irq_restore(mask);
 }
 
 void aic_enable(uint32_t source)
 {
 	Aic* aic = AIC;
+	uint32_t mask;
 
 #ifdef CONFIG_HAVE_SAIC
 	if (SFR->SFR_AICREDIR == 0) {
@@ -178,13 +193,16 @@ void aic_enable(uint32_t source)
 			aic = SAIC;
 	}
 #endif
+	mask = irq_disable_save();
 	aic->AIC_SSR = AIC_SSR_INTSEL(source);
 	aic->AIC_IECR = AIC_IECR_INTEN;
+	irq_restore(mask);
 }
 
 void aic_disable(uint32_t source)
 {
 	Aic* aic = AIC;
+	uint32_t mask;
 
 #ifdef CONFIG_HAVE_SAIC	
 	if (SFR->SFR_AICREDIR == 0) {
@@ -193,8 +211,20 @@ void aic_disable(uint32_t source)
 			aic = SAIC;
 	}
 #endif
+	mask = irq_disable_save();
 	aic->AIC_SSR = AIC_SSR_INTSEL(source);
 	aic->AIC_IDCR = AIC_IDCR_INTD;
+	irq_restore(mask);
+}
+
+void aic_set_pending(uint32_t source)
+{
+	Aic* aic = _get_aic_instance(source);
+	uint32_t mask = irq_disable_save();
+
+	aic->AIC_SSR = AIC_SSR_INTSEL(source);
+	aic->AIC_ISCR = AIC_ISCR_INTSET;
+	irq_restore(mask);
 }
 
 uint32_t aic_get_current_interrupt_source(void)
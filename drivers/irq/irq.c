@@ -38,7 +38,15 @@
 #endif
 #include "irq/irq.h"
 
+#ifdef CONFIG_IRQ_STATS
+#ifndef CONFIG_CORE_CORTEXA5
+#error IRQ statistics require the Cortex-A5 PMU cycle counter
+#endif
+#include "core/arm_cp15_pmu.h"
+#endif
+
 #include <assert.h>
+#include <string.h>
 
 /*------------------------------------------------------------------------------
  *         Local types
@@ -50,13 +58,32 @@ struct handler_entry {
 	struct handler_entry* next;
 };
 
+/* First handler stored inline, additional (shared) handlers chained */
+struct source_entry {
+	irq_handler_t handler;
+	void* user_arg;
+	struct handler_entry* shared;
+};
+
 /*------------------------------------------------------------------------------
  *         Local variables
  *------------------------------------------------------------------------------*/
 
-static struct handler_entry  handlers_pool[ID_PERIPH_COUNT * 2];
+static struct handler_entry  handlers_pool[ID_PERIPH_COUNT];
 static struct handler_entry* next_free_handler;
-static struct handler_entry* handlers[ID_PERIPH_COUNT];
+static struct source_entry   handlers[ID_PERIPH_COUNT];
+
+static volatile bool nesting = true;
+
+#ifdef CONFIG_IRQ_STATS
+/* Cycle counter at IRQ exception entry, written by irqHandler (cstartup) */
+volatile uint32_t irq_entry_cycles;
+
+/* Total cycles spent in the handlers preempting the current one */
+static uint32_t nested_cycles;
+
+static struct _irq_stats stats[ID_PERIPH_COUNT];
+#endif
 
 /*------------------------------------------------------------------------------
  *         Local functions
@@ -99,7 +126,13 @@ static void _free_handler(struct handler_entry* entry)
 static void _default_irq_handler(void)
 {
 	uint32_t source;
+	struct source_entry *src;
 	struct handler_entry *entry;
+#ifdef CONFIG_IRQ_STATS
+	uint32_t entry_cycles = irq_entry_cycles;
+	uint32_t start, end, nested, latency, time;
+	uint32_t nested_start = nested_cycles;
+#endif
 
 #if defined(CONFIG_HAVE_AIC2) || defined(CONFIG_HAVE_AIC5)
 	source = aic_get_current_interrupt_source();
@@ -107,17 +140,44 @@ static void _default_irq_handler(void)
 #error Unknown IRQ controller!
 #endif
 
-	entry = handlers[source];
-	if (!entry) {
+	src = &handlers[source];
+	if (!src->handler) {
 		// no handler for interrupt, block
 		while (1);
 	}
 
-	while (entry) {
-		if (entry->handler)
-			entry->handler(source, entry->user_arg);
-		entry = entry->next;
-	}
+	/* irqHandler enters with interrupts masked: allow interrupts of higher
+	 * priority, the AIC masks the ones of lower or equal priority */
+	if (nesting)
+		irq_enable_all();
+
+#ifdef CONFIG_IRQ_STATS
+	start = cp15_get_cycle_counter();
+#endif
+
+	src->handler(source, src->user_arg);
+	for (entry = src->shared; entry; entry = entry->next)
+		entry->handler(source, entry->user_arg);
+
+#ifdef CONFIG_IRQ_STATS
+	end = cp15_get_cycle_counter();
+#endif
+
+	irq_disable_all();
+
+#ifdef CONFIG_IRQ_STATS
+	/* do not account the time spent in nested handlers */
+	nested = nested_cycles - nested_start;
+	latency = start - entry_cycles;
+	time = end - start - nested;
+	nested_cycles = nested_start + (end - entry_cycles);
+
+	stats[source].count++;
+	if (time > stats[source].max_time)
+		stats[source].max_time = time;
+	if (latency > stats[source].max_latency)
+		stats[source].max_latency = latency;
+#endif
 }
 
 /*----------------------------------------------------------------------------
@@ -128,6 +188,10 @@ void irq_initialize(void)
 {
 	_initialize_handlers_pool();
 
+#ifdef CONFIG_IRQ_STATS
+	cp15_pmu_start_cycle_counter();
+#endif
+
 #if defined(CONFIG_HAVE_AIC2) || defined(CONFIG_HAVE_AIC5)
 	aic_initialize(_default_irq_handler);
 #else
@@ -155,44 +219,95 @@ void irq_configure_priority(uint32_t source, uint8_t priority)
 
 void irq_add_handler(uint32_t source, irq_handler_t handler, void* user_arg)
 {
+	struct source_entry* src = &handlers[source];
 	struct handler_entry* entry;
+	uint32_t mask = irq_disable_save();
 
 	/* check if handler is already registered */
-	entry = handlers[source];
-	while (entry) {
+	if (src->handler == handler) {
+		src->user_arg = user_arg;
+		irq_restore(mask);
+		return;
+	}
+	for (entry = src->shared; entry; entry = entry->next) {
 		if (entry->handler == handler) {
 			entry->user_arg = user_arg;
+			irq_restore(mask);
 			return;
 		}
-		entry = entry->next;
 	}
 
-	/* add handler to linked list */
-	entry = _alloc_handler();
-	entry->handler = handler;
-	entry->user_arg = user_arg;
-	entry->next = handlers[source];
-	handlers[source] = entry;
+	if (!src->handler) {
+		/* single handler: dispatched directly */
+		src->handler = handler;
+		src->user_arg = user_arg;
+	} else {
+		/* shared handler: append to the linked list */
+		entry = _alloc_handler();
+		entry->handler = handler;
+		entry->user_arg = user_arg;
+		entry->next = src->shared;
+		src->shared = entry;
+	}
+	irq_restore(mask);
 }
 
 void irq_remove_handler(uint32_t source, irq_handler_t handler)
 {
-	struct handler_entry* prev;
+	struct source_entry* src = &handlers[source];
+	struct handler_entry** prev;
 	struct handler_entry* cur;
-
-	/* remove handler from linked list */
-	prev = NULL;
-	cur = handlers[source];
-	while (cur) {
-		if (cur->handler == handler) {
-			if (prev)
-				prev->next = cur->next;
+	uint32_t mask = irq_disable_save();
+
+	if (src->handler == handler) {
+		/* promote the first shared handler, if any */
+		cur = src->shared;
+		if (cur) {
+			src->handler = cur->handler;
+			src->user_arg = cur->user_arg;
+			src->shared = cur->next;
 			_free_handler(cur);
-			return;
+		} else {
+			src->handler = NULL;
+			src->user_arg = NULL;
+		}
+	} else {
+		/* remove handler from linked list */
+		for (prev = &src->shared; (cur = *prev) != NULL; prev = &cur->next) {
+			if (cur->handler == handler) {
+				*prev = cur->next;
+				_free_handler(cur);
+				break;
+			}
 		}
-		cur = cur->next;
 	}
+	irq_restore(mask);
+}
+
+void irq_set_nesting(bool enable)
+{
+	nesting = enable;
+}
+
+#ifdef CONFIG_IRQ_STATS
+void irq_get_stats(uint32_t source, struct _irq_stats* source_stats)
+{
+	uint32_t mask;
+
+	assert(source < ID_PERIPH_COUNT);
+
+	mask = irq_disable_save();
+	*source_stats = stats[source];
+	irq_restore(mask);
+}
+
+void irq_reset_stats(void)
+{
+	uint32_t mask = irq_disable_save();
+	memset(stats, 0, sizeof(stats));
+	irq_restore(mask);
 }
+#endif /* CONFIG_IRQ_STATS */
 
 void irq_enable(uint32_t source)
 {
@@ -211,3 +326,12 @@ void irq_disable(uint32_t source)
 #error Unknown IRQ controller!
 #endif
 }
+
+void irq_set_pending(uint32_t source)
+{
+#if defined(CONFIG_HAVE_AIC2) || defined(CONFIG_HAVE_AIC5)
+	aic_set_pending(source);
+#else
+#error Unknown IRQ controller!
+#endif
+}
@@ -34,10 +34,22 @@
  *         Headers
  *------------------------------------------------------------------------------*/
 
+#include <stdbool.h>
 #include <stdint.h>
 
 typedef void (*irq_handler_t)(uint32_t source, void* user_arg);
 
+#ifdef CONFIG_IRQ_STATS
+/** Per-source statistics, in CPU cycles (see cp15_pmu_start_cycle_counter()) */
+struct _irq_stats {
+	uint32_t count;		/**< number of interrupts handled */
+	uint32_t max_time;	/**< longest handler execution, nested
+				     interrupts excluded */
+	uint32_t max_latency;	/**< longest delay from the IRQ exception
+				     entry to the handler call */
+};
+#endif
+
 enum _irq_mode {
 	IRQ_MODE_HIGH_LEVEL,
 	IRQ_MODE_LOW_LEVEL,
@@ -83,7 +95,10 @@ extern void irq_configure_priority(uint32_t source, uint8_t priority);
  * \brief Add a handler for a given interrupt source (ID_xxx).
  *
  * If the handler is already configured for the interrupt source, this function
- * does nothing.
+ * only updates its user argument.
+ *
+ * The first handler of a source is called directly on interrupt, additional
+ * handlers (shared interrupt) are called after it, most recent first.
  *
  * \param source   Interrupt source to configure
  * \param handler  Handler for the interrupt
@@ -116,6 +131,41 @@ extern void irq_enable(uint32_t source);
  */
 extern void irq_disable(uint32_t source);
 
+/**
+ * \brief Trigger an interrupt of the given source (ID_xxx) by software.
+ *
+ * The source should be an unused one, configured as edge-triggered.
+ *
+ * \param source  Interrupt source to trigger
+ */
+extern void irq_set_pending(uint32_t source);
+
+/**
+ * \brief Enable or disable interrupt nesting (enabled by default).
+ *
+ * When enabled, handlers run with interrupts unmasked and can be preempted by
+ * interrupts of a higher priority (see irq_configure_priority()). When
+ * disabled, each handler runs to completion with interrupts masked.
+ *
+ * \param enable  true to allow nesting
+ */
+extern void irq_set_nesting(bool enable);
+
+#ifdef CONFIG_IRQ_STATS
+/**
+ * \brief Get the statistics of an interrupt source (ID_xxx).
+ *
+ * \param source Interrupt source
+ * \param stats  Filled with the statistics of the source
+ */
+extern void irq_get_stats(uint32_t source, struct _irq_stats* stats);
+
+/**
+ * \brief Reset the statistics of all interrupt sources.
+ */
+extern void irq_reset_stats(void);
+#endif /* CONFIG_IRQ_STATS */
+
 #ifdef __cplusplus
 }
 #endif
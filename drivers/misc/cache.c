@@ -27,7 +27,17 @@
  * ----------------------------------------------------------------------------
  */
 
-/** \file */
+/** \file
+ *
+ * Cache maintenance of memory regions.
+ *
+ * Regions are maintained line by line, unless they are larger than a
+ * threshold above which a whole-cache operation by set/way (L1) or by way
+ * (L2) is cheaper. Invalidation of a large region then becomes a clean and
+ * invalidate of the whole cache, so that data of other regions is kept. The
+ * partial lines at both ends of an unaligned region are cleaned and
+ * invalidated instead of being discarded.
+ */
 
 /*----------------------------------------------------------------------------
  *        Headers
@@ -40,21 +50,98 @@
 #include "peripherals/l2cc.h"
 
 #include <assert.h>
+#include <stdbool.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define L1_LINE_MASK (L1_CACHE_BYTES - 1)
+
+#define L2_LINE_BYTES 32
+#define L2_LINE_MASK (L2_LINE_BYTES - 1)
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+static uint32_t _l1_threshold = CACHE_L1_FLUSH_THRESHOLD;
+
+#ifdef CONFIG_HAVE_L2CC
+static uint32_t _l2_threshold = CACHE_L2_FLUSH_THRESHOLD;
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static bool _use_whole_cache(uint32_t threshold, uint32_t length)
+{
+	return threshold != 0 && length >= threshold;
+}
+
+static void _l1_invalidate_region(uint32_t start, uint32_t end)
+{
+	if (start & L1_LINE_MASK) {
+		cp15_dcache_clean_invalidate_region(start, start + 1);
+		start = (start | L1_LINE_MASK) + 1;
+	}
+	if ((end & L1_LINE_MASK) && start < end) {
+		cp15_dcache_clean_invalidate_region(end - 1, end);
+		end &= ~L1_LINE_MASK;
+	}
+	if (start < end)
+		cp15_dcache_invalidate_region(start, end);
+}
+
+#ifdef CONFIG_HAVE_L2CC
+static void _l2_invalidate_region(uint32_t start, uint32_t end)
+{
+	if (start & L2_LINE_MASK) {
+		l2cc_clean_invalidate_pal(start & ~L2_LINE_MASK);
+		start = (start | L2_LINE_MASK) + 1;
+	}
+	if ((end & L2_LINE_MASK) && start < end) {
+		l2cc_clean_invalidate_pal(end & ~L2_LINE_MASK);
+		end &= ~L2_LINE_MASK;
+	}
+	for (; start < end; start += L2_LINE_BYTES)
+		l2cc_invalidate_pal(start);
+}
+#endif
 
 /*----------------------------------------------------------------------------
  *        Functions
  *----------------------------------------------------------------------------*/
 
+void cache_set_flush_threshold(uint32_t l1_bytes, uint32_t l2_bytes)
+{
+	_l1_threshold = l1_bytes;
+#ifdef CONFIG_HAVE_L2CC
+	_l2_threshold = l2_bytes;
+#endif
+}
+
 void cache_invalidate_region(void *start, uint32_t length)
 {
 	uint32_t start_addr = (uint32_t)start;
 	uint32_t end_addr = start_addr + length;
 
+	if (length == 0)
+		return;
+
 	if (cp15_dcache_is_enabled()) {
-		cp15_dcache_invalidate_region(start_addr, end_addr);
+		if (_use_whole_cache(_l1_threshold, length))
+			cp15_dcache_clean_invalidate();
+		else
+			_l1_invalidate_region(start_addr, end_addr);
 #ifdef CONFIG_HAVE_L2CC
-		if (l2cc_is_enabled())
-			l2cc_invalidate_region(start_addr, end_addr);
+		if (l2cc_is_enabled()) {
+			if (_use_whole_cache(_l2_threshold, length))
+				l2cc_clean_invalidate();
+			else
+				_l2_invalidate_region(start_addr, end_addr);
+		}
 #endif
 	}
 }
@@ -64,11 +151,21 @@ void cache_clean_region(const void *start, uint32_t length)
 	uint32_t start_addr = (uint32_t)start;
 	uint32_t end_addr = start_addr + length;
 
+	if (length == 0)
+		return;
+
 	if (cp15_dcache_is_enabled()) {
-		cp15_dcache_clean_region(start_addr, end_addr);
+		if (_use_whole_cache(_l1_threshold, length))
+			cp15_dcache_clean();
+		else
+			cp15_dcache_clean_region(start_addr, end_addr);
 #ifdef CONFIG_HAVE_L2CC
-		if (l2cc_is_enabled())
-			l2cc_clean_region(start_addr, end_addr);
+		if (l2cc_is_enabled()) {
+			if (_use_whole_cache(_l2_threshold, length))
+				l2cc_clean();
+			else
+				l2cc_clean_region(start_addr, end_addr);
+		}
 #endif
 	}
 }
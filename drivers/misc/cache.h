@@ -99,6 +99,23 @@
 	SECTION(".region_ddr_cache_aligned")
 #endif
 
+/**
+ * Regions at least this large (in bytes) are maintained with whole L1 cache
+ * operations by set/way instead of line by line (0 to disable)
+ */
+#ifndef CACHE_L1_FLUSH_THRESHOLD
+#define CACHE_L1_FLUSH_THRESHOLD \
+	(L1_CACHE_WAYS * L1_CACHE_SETS * L1_CACHE_BYTES)
+#endif
+
+/**
+ * Regions at least this large (in bytes) are maintained with whole L2 cache
+ * operations by way instead of line by line (0 to disable)
+ */
+#ifndef CACHE_L2_FLUSH_THRESHOLD
+#define CACHE_L2_FLUSH_THRESHOLD (128 * 1024)
+#endif
+
 /**
  * Is x is aligned on a cache line?
  */
@@ -108,9 +125,23 @@
  *        Exported functions
  *----------------------------------------------------------------------------*/
 
+/**
+ *  \brief Set the sizes above which regions are maintained with whole cache
+ *  operations
+ *
+ *  \param l1_bytes L1 threshold in bytes (0 to always work line by line)
+ *  \param l2_bytes L2 threshold in bytes (0 to always work line by line)
+ */
+extern void cache_set_flush_threshold(uint32_t l1_bytes, uint32_t l2_bytes);
+
 /**
  *  \brief Invalidate cache lines corresponding to a memory region
  *
+ *  Partial lines at the start and end of the region are cleaned before
+ *  being invalidated. Regions above the flush threshold are cleaned and
+ *  invalidated with the whole cache: they must not hold dirty lines that
+ *  would overwrite data written by a DMA.
+ *
  *  \param start Beginning of the memory region
  *  \param length Length of the memory region
  */
@@ -0,0 +1,305 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Implementation of the sampling profiler.
+ *
+ * The TC interrupt is installed directly as the AIC vector, so that the
+ * stacks built by irqHandler (see cstartup.S) can be inspected:
+ * - the IRQ mode stack holds {r0, SPSR, return address} of the interrupted
+ *   code, the return address being the interrupted PC;
+ * - on entry of the vector, the SVC stack pointer points to the {r1, lr}
+ *   pair pushed by irqHandler, lr being the one of the interrupted code when
+ *   it was running in SVC mode.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "compiler.h"
+
+#include "core/arm.h"
+#include "core/arm_cp15_pmu.h"
+#include "irq/aic.h"
+#include "misc/profiler.h"
+#include "peripherals/pmc.h"
+#include "peripherals/tc.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define CPSR_MODE_MASK   0x1f
+#define CPSR_MODE_IRQ    0x12
+#define CPSR_MODE_SVC    0x13
+
+/** Number of slots looked at before a sample is dropped */
+#define MAX_PROBES 16
+
+/** PMU event counter used for event sampling */
+#define EVENT_COUNTER 0
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+struct _profiler_entry {
+	uint32_t pc;
+	uint32_t lr;
+	uint32_t count;
+	uint32_t events;
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct {
+	Tc *tc;
+	uint8_t channel;
+	uint32_t rate;
+	enum profiler_event event;
+	bool running;
+	uint32_t samples;
+	uint32_t lost;
+	uint32_t last_events;
+} _profiler;
+
+static struct _profiler_entry _histogram[PROFILER_HISTOGRAM_SIZE];
+
+static const char *_event_names[] = {
+	[PROFILER_EVENT_NONE] = "none",
+	[PROFILER_EVENT_DCACHE_MISS] = "dcache-miss",
+	[PROFILER_EVENT_ICACHE_MISS] = "icache-miss",
+	[PROFILER_EVENT_BRANCH_MISPREDICT] = "branch-mispredict",
+};
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Get the stack pointer of IRQ mode, which points to the context
+ * saved by irqHandler for the current interrupt.
+ */
+static const uint32_t *_get_irq_frame(void)
+{
+	uint32_t cpsr, sp;
+
+	asm volatile("mrs     %0, cpsr\n\t"
+	             "orr     %1, %0, #0xc0\n\t"
+	             "bic     %1, %1, #0x1f\n\t"
+	             "orr     %1, %1, #0x12\n\t"
+	             "msr     cpsr_c, %1\n\t"
+	             "mov     %1, sp\n\t"
+	             "msr     cpsr_c, %0"
+	             : "=&r"(cpsr), "=&r"(sp) :: "memory");
+	return (const uint32_t *)sp;
+}
+
+static uint32_t _read_events(void)
+{
+#ifdef CONFIG_CORE_CORTEXA5
+	if (_profiler.event != PROFILER_EVENT_NONE)
+		return cp15_pmu_read_event_counter(EVENT_COUNTER);
+#endif
+	return 0;
+}
+
+static void _record(uint32_t pc, uint32_t lr, uint32_t events)
+{
+	uint32_t index = ((pc >> 2) ^ (lr >> 4)) & (PROFILER_HISTOGRAM_SIZE - 1);
+	int probe;
+
+	_profiler.samples++;
+	for (probe = 0; probe < MAX_PROBES; probe++) {
+		struct _profiler_entry *entry = &_histogram[index];
+
+		if (entry->count == 0) {
+			entry->pc = pc;
+			entry->lr = lr;
+		}
+		if (entry->pc == pc && entry->lr == lr) {
+			entry->count++;
+			entry->events += events;
+			return;
+		}
+		index = (index + 1) & (PROFILER_HISTOGRAM_SIZE - 1);
+	}
+	_profiler.lost++;
+}
+
+/* Called by _profiler_irq_entry, hence not static */
+void profiler_irq_handler(const uint32_t *svc_frame);
+
+void profiler_irq_handler(const uint32_t *svc_frame)
+{
+	const uint32_t *irq_frame = _get_irq_frame();
+	uint32_t spsr = irq_frame[1];
+	uint32_t pc = irq_frame[2];
+	uint32_t lr = 0;
+	uint32_t events, now;
+
+	tc_get_status(_profiler.tc, _profiler.channel);
+
+	if (svc_frame && (spsr & CPSR_MODE_MASK) == CPSR_MODE_SVC)
+		lr = svc_frame[1];
+
+	now = _read_events();
+	events = now - _profiler.last_events;
+	_profiler.last_events = now;
+
+	_record(pc, lr, events);
+}
+
+#if defined(__GNUC__)
+__attribute__((naked)) static void _profiler_irq_entry(void)
+{
+	asm("mov     r0, sp\n\t"
+	    "b       profiler_irq_handler");
+}
+#else
+static void _profiler_irq_entry(void)
+{
+	/* the SVC stack at vector entry cannot be located: no LR */
+	profiler_irq_handler(NULL);
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int profiler_start(const struct profiler_config *cfg)
+{
+	uint32_t id;
+
+	if (!cfg->tc || cfg->channel >= ARRAY_SIZE(cfg->tc->TC_CHANNEL) ||
+	    cfg->rate == 0 || cfg->event >= ARRAY_SIZE(_event_names))
+		return -EINVAL;
+#ifndef CONFIG_CORE_CORTEXA5
+	if (cfg->event != PROFILER_EVENT_NONE)
+		return -ENOTSUP;
+#endif
+
+	profiler_stop();
+
+	_profiler.tc = cfg->tc;
+	_profiler.channel = cfg->channel;
+	_profiler.rate = cfg->rate;
+	_profiler.event = cfg->event;
+
+#ifdef CONFIG_CORE_CORTEXA5
+	switch (cfg->event) {
+	case PROFILER_EVENT_DCACHE_MISS:
+		cp15_pmu_start_event_counter(EVENT_COUNTER,
+					     CP15_PMU_EVT_L1D_REFILL);
+		break;
+	case PROFILER_EVENT_ICACHE_MISS:
+		cp15_pmu_start_event_counter(EVENT_COUNTER,
+					     CP15_PMU_EVT_L1I_REFILL);
+		break;
+	case PROFILER_EVENT_BRANCH_MISPREDICT:
+		cp15_pmu_start_event_counter(EVENT_COUNTER,
+					     CP15_PMU_EVT_BR_MIS_PRED);
+		break;
+	default:
+		break;
+	}
+#endif
+	_profiler.last_events = _read_events();
+
+	id = get_tc_id_from_addr(cfg->tc);
+	pmc_enable_peripheral(id);
+	tc_stop(cfg->tc, cfg->channel);
+	tc_trigger_on_freq(cfg->tc, cfg->channel, cfg->rate);
+	tc_get_status(cfg->tc, cfg->channel);
+
+	aic_set_source_vector(id, _profiler_irq_entry);
+	aic_configure_priority(id, PROFILER_IRQ_PRIORITY);
+	tc_enable_it(cfg->tc, cfg->channel, TC_IER_CPCS);
+	aic_enable(id);
+
+	_profiler.running = true;
+	tc_start(cfg->tc, cfg->channel);
+	return 0;
+}
+
+void profiler_stop(void)
+{
+	if (!_profiler.running)
+		return;
+
+	tc_stop(_profiler.tc, _profiler.channel);
+	tc_disable_it(_profiler.tc, _profiler.channel, TC_IDR_CPCS);
+	aic_disable(get_tc_id_from_addr(_profiler.tc));
+#ifdef CONFIG_CORE_CORTEXA5
+	if (_profiler.event != PROFILER_EVENT_NONE)
+		cp15_pmu_stop_event_counter(EVENT_COUNTER);
+#endif
+	_profiler.running = false;
+}
+
+void profiler_reset(void)
+{
+	uint32_t mask = irq_disable_save();
+
+	memset(_histogram, 0, sizeof(_histogram));
+	_profiler.samples = 0;
+	_profiler.lost = 0;
+	irq_restore(mask);
+}
+
+void profiler_dump(void)
+{
+	int i;
+
+	printf("# profiler rate=%u samples=%u lost=%u event=%s\r\n",
+	       (unsigned)_profiler.rate, (unsigned)_profiler.samples,
+	       (unsigned)_profiler.lost, _event_names[_profiler.event]);
+	printf("# pc lr count events\r\n");
+	for (i = 0; i < PROFILER_HISTOGRAM_SIZE; i++) {
+		const struct _profiler_entry *entry = &_histogram[i];
+
+		if (entry->count == 0)
+			continue;
+		printf("0x%08x 0x%08x %u %u\r\n", (unsigned)entry->pc,
+		       (unsigned)entry->lr, (unsigned)entry->count,
+		       (unsigned)entry->events);
+	}
+	printf("# end\r\n");
+}
@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Statistical sampling profiler.
+ *
+ * A TC channel interrupts the CPU at a fixed rate. Each interrupt records
+ * the interrupted PC and LR in a RAM histogram. On Cortex-A5 devices, the
+ * number of PMU events (cache misses, mispredicted branches) counted since
+ * the previous sample can be attributed to each entry.
+ *
+ * profiler_dump() prints the histogram on stdout (the console, or any other
+ * output stdout is redirected to, such as an USB CDC serial port):
+ *
+ * \code
+ * # profiler rate=1000 samples=5000 lost=0 event=dcache-miss
+ * # pc lr count events
+ * 0x20004d18 0x20004f60 1523 8214
+ * ...
+ * # end
+ * \endcode
+ *
+ * Addresses can be symbolized on the host against the ELF file, for example
+ * with "arm-none-eabi-addr2line -f -e app.elf 0x20004d18". A LR of 0 means
+ * that the interrupted code was not running in SVC mode, or that the LR
+ * could not be recovered (IAR builds).
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Number of histogram entries (power of two) */
+#ifndef PROFILER_HISTOGRAM_SIZE
+#define PROFILER_HISTOGRAM_SIZE 1024
+#endif
+
+/** Priority of the sampling interrupt (highest by default, so that interrupt
+ * handlers are profiled too when nesting is enabled, see irq_set_nesting()) */
+#ifndef PROFILER_IRQ_PRIORITY
+#define PROFILER_IRQ_PRIORITY 7
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** PMU event attributed to the samples */
+enum profiler_event {
+	PROFILER_EVENT_NONE,
+	PROFILER_EVENT_DCACHE_MISS,
+	PROFILER_EVENT_ICACHE_MISS,
+	PROFILER_EVENT_BRANCH_MISPREDICT,
+};
+
+struct profiler_config {
+	Tc *tc;			/**< TC used for sampling, reserved while running */
+	uint8_t channel;	/**< TC channel */
+	uint32_t rate;		/**< sampling rate in Hz */
+	enum profiler_event event;
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Start sampling.
+ *
+ * The interrupt vector of the TC is taken over by the profiler: the other
+ * channels of the same TC cannot be used for interrupts while sampling.
+ * The histogram is not cleared, so that several runs can be accumulated.
+ *
+ * \param cfg Sampling configuration
+ * \return 0 on success, -EINVAL if the configuration is invalid, -ENOTSUP if
+ * an event is requested on a device without PMU.
+ */
+extern int profiler_start(const struct profiler_config *cfg);
+
+/**
+ * \brief Stop sampling.
+ */
+extern void profiler_stop(void);
+
+/**
+ * \brief Clear the histogram.
+ */
+extern void profiler_reset(void);
+
+/**
+ * \brief Print the histogram on stdout.
+ */
+extern void profiler_dump(void);
+
+#endif /* PROFILER_H_ */
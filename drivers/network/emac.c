@@ -378,6 +378,27 @@ void emac_increase_statistics(Emac* emac)
 	emac->EMAC_NCR |= EMAC_NCR_INCSTAT;
 }
 
+void emac_read_statistics(Emac* emac, struct _eth_mac_stats* stats)
+{
+	/* The EMAC has no octet, broadcast or multicast counters */
+	stats->tx_frames += emac->EMAC_FTO;
+	stats->tx_underruns += emac->EMAC_TUND;
+	stats->tx_collisions += emac->EMAC_SCF + emac->EMAC_MCF;
+	stats->tx_excessive_collisions += emac->EMAC_ECOL;
+	stats->tx_late_collisions += emac->EMAC_LCOL;
+	stats->tx_carrier_errors += emac->EMAC_CSE;
+
+	stats->rx_frames += emac->EMAC_FRO;
+	stats->rx_fcs_errors += emac->EMAC_FCSE;
+	stats->rx_alignment_errors += emac->EMAC_ALE;
+	stats->rx_undersize += emac->EMAC_USF;
+	stats->rx_oversize += emac->EMAC_ELE;
+	stats->rx_jabbers += emac->EMAC_RJA;
+	stats->rx_symbol_errors += emac->EMAC_RSE;
+	stats->rx_resource_errors += emac->EMAC_RRE;
+	stats->rx_overruns += emac->EMAC_ROV;
+}
+
 void emac_enable_statistics_write(Emac* emac, bool enable)
 {
 	if (enable)
@@ -294,6 +294,12 @@ extern void emac_increase_statistics(Emac* emac);
  */
 extern void emac_enable_statistics_write(Emac* emac, bool enable);
 
+/**
+ *  \brief Read the statistics registers, which are cleared on read, and add
+ *  them to the given counters.
+ */
+extern void emac_read_statistics(Emac* emac, struct _eth_mac_stats* stats);
+
 /**
  *  \brief Start transmission
  */
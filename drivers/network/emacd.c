@@ -142,12 +142,14 @@ static void _emacd_reset_rx(struct _ethd* emacd)
 	emac_receive_enable(emacd->emac, false);
 
 	/* Setup the RX descriptors */
-	q->rx_head = 0;
+	RING_CLEAR(q->rx_head, q->rx_tail);
+	q->rx_held = 0;
+	q->rx_csum = ETH_RX_CSUM_NONE;
 	for (i = 0; i < q->rx_size; i++) {
 		q->rx_desc[i].addr = addr & ETH_RX_ADDR_MASK;
 		dsb();
 		q->rx_desc[i].status = 0;
-		addr += ETH_RX_UNITSIZE;
+		addr += q->rx_unitsize;
 	}
 	q->rx_desc[q->rx_size - 1].addr |= ETH_RX_ADDR_WRAP;
 
@@ -165,6 +167,7 @@ static void _emacd_tx_complete_handler(struct _ethd* emacd, uint8_t queue)
 	struct _ethd_queue* q = &emacd->queues[queue];
 	struct _eth_desc *desc;
 	ethd_callback_t callback;
+	struct _eth_tx_release* release;
 	uint32_t tsr;
 
 	//printf("<TX>\r\n");
@@ -198,6 +201,15 @@ static void _emacd_tx_complete_handler(struct _ethd* emacd, uint8_t queue)
 				callback(queue, tsr);
 		}
 
+		/* Give back the buffers of a frame sent without copy */
+		if (q->tx_releases) {
+			release = &q->tx_releases[q->tx_tail];
+			if (release->callback) {
+				release->callback(queue, tsr, release->arg);
+				release->callback = NULL;
+			}
+		}
+
 		/* Go to next frame */
 		RING_INC(q->tx_tail, q->tx_size);
 	}
@@ -222,6 +234,7 @@ static void _emacd_tx_error_handler(struct _ethd* emacd, uint8_t queue)
 	struct _ethd_queue* q = &emacd->queues[queue];
 	struct _eth_desc* desc;
 	ethd_callback_t callback;
+	struct _eth_tx_release* release;
 	uint32_t tsr;
 
 	printf("<TXERR>\r\n");
@@ -258,6 +271,8 @@ static void _emacd_tx_error_handler(struct _ethd* emacd, uint8_t queue)
 		 */
 		if (desc->status & ETH_TX_STATUS_USED)
 			tx_completed = 1;
+		else
+			q->stats.tx_errors++;
 
 		/* Go to the last buffer descriptor of the frame */
 		while ((desc->status & ETH_TX_STATUS_LASTBUF) == 0) {
@@ -273,6 +288,15 @@ static void _emacd_tx_error_handler(struct _ethd* emacd, uint8_t queue)
 				callback(queue, tx_completed ? EMAC_TSR_COMP : 0);
 		}
 
+		/* Give back the buffers of a frame sent without copy */
+		if (q->tx_releases) {
+			release = &q->tx_releases[q->tx_tail];
+			if (release->callback) {
+				release->callback(queue, tx_completed ? EMAC_TSR_COMP : 0, release->arg);
+				release->callback = NULL;
+			}
+		}
+
 		/* Go to next frame */
 		RING_INC(q->tx_tail, q->tx_size);
 	}
@@ -309,9 +333,23 @@ static void _emacd_handler(struct _ethd * emacd, uint8_t queue)
 			rsr = emac_get_rx_status(emac);
 			emac_clear_rx_status(emac, rsr);
 
-			/* Invoke callback */
-			if (q->rx_callback)
-				q->rx_callback(queue, rsr);
+			/* Ignore RX events while the queue is being polled */
+			if (!q->rx_polling) {
+				q->rx_stats.interrupts++;
+
+				/* Mask RX interrupts until the queue is drained */
+				if (q->rx_coalesce) {
+					emac_disable_it(emacd->emac, EMAC_INT_RX_BITS);
+					q->rx_polling = true;
+					if (q->rx_holdoff)
+						timer_start_timeout(&q->rx_holdoff_timeout,
+								q->rx_holdoff);
+				}
+
+				/* Invoke callback */
+				if (q->rx_callback)
+					q->rx_callback(queue, rsr);
+			}
 		}
 
 		/* TX error */
@@ -357,6 +395,8 @@ void emacd_configure(struct _ethd * emacd,
 
 	/* Initialize struct */
 	emacd->emac = emac;
+	emacd->offload_caps = 0;
+	emacd->offload = 0;
 
 	emac_configure(emac);
 
@@ -384,7 +424,7 @@ void emacd_configure(struct _ethd * emacd,
 	emac_set_network_config_register(emac, ncfgr);
 
 	emacd_setup_queue(emacd, EMAC_QUEUE_INDEX,
-			DUMMY_BUFFERS, dummy_buffer, dummy_rx_desc,
+			DUMMY_BUFFERS, DUMMY_UNITSIZE, dummy_buffer, dummy_rx_desc,
 			DUMMY_BUFFERS, dummy_buffer, dummy_tx_desc,
 			NULL);
 }
@@ -396,9 +436,10 @@ void emacd_configure(struct _ethd * emacd,
  * \param emacd Pointer to EMAC Driver instance.
  * \param rx_buffer Pointer to allocated buffer for RX. The address should
  *                  be 8-byte aligned and the size should be
- *                  ETH_RX_UNITSIZE * wRxSize.
+ *                  rx_unitsize * wRxSize.
  * \param rx_desc      Pointer to allocated RX descriptor list.
  * \param wRxSize   RX size, in number of registered units (RX descriptors).
+ * \param rx_unitsize Size of each RX buffer, must be ETH_RX_UNITSIZE.
  * \param tx_buffer Pointer to allocated buffer for TX. The address should
  *                  be 8-byte aligned and the size should be
  *                  ETH_TX_UNITSIZE * wTxSize.
@@ -410,7 +451,7 @@ void emacd_configure(struct _ethd * emacd,
  *       adjusted and the list size is reduced by one.
  */
 uint8_t emacd_setup_queue(struct _ethd* emacd, uint8_t queue,
-		uint16_t rx_size, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
+		uint16_t rx_size, uint16_t rx_unitsize, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
 		uint16_t tx_size, uint8_t* tx_buffer, struct _eth_desc* tx_desc,
 		ethd_callback_t *tx_callbacks)
 {
@@ -419,6 +460,9 @@ uint8_t emacd_setup_queue(struct _ethd* emacd, uint8_t queue,
 
 	if (rx_size <= 1 || tx_size <= 1)
 		return ETH_PARAM;
+	/* The EMAC RX buffer size is fixed */
+	if (rx_unitsize != ETH_RX_UNITSIZE)
+		return ETH_PARAM;
 
 	/* Assign RX buffers */
 	if (((uint32_t)rx_buffer & 0x7)
@@ -429,7 +473,14 @@ uint8_t emacd_setup_queue(struct _ethd* emacd, uint8_t queue,
 	q->rx_buffer = (uint8_t*)((uint32_t)rx_buffer & 0xFFFFFFF8);
 	q->rx_desc = (struct _eth_desc *)((uint32_t)rx_desc & 0xFFFFFFF8);
 	q->rx_size = rx_size;
+	q->rx_unitsize = rx_unitsize;
+	q->rx_budget = 0;
 	q->rx_callback = NULL;
+	q->rx_coalesce = false;
+	q->rx_polling = false;
+	q->rx_holdoff = 0;
+	memset(&q->rx_stats, 0, sizeof(q->rx_stats));
+	memset(&q->stats, 0, sizeof(q->stats));
 
 	/* Assign TX buffers */
 	if (((uint32_t)tx_buffer & 0x7)
@@ -441,6 +492,7 @@ uint8_t emacd_setup_queue(struct _ethd* emacd, uint8_t queue,
 	q->tx_desc = (struct _eth_desc*)((uint32_t)tx_desc & 0xFFFFFFF8);
 	q->tx_size = tx_size;
 	q->tx_callbacks = tx_callbacks;
+	q->tx_releases = NULL;
 	q->tx_wakeup_callback = NULL;
 
 	/* Reset TX & RX */
@@ -496,6 +548,36 @@ void emacd_set_rx_callback(struct _ethd* emacd,  uint8_t queue, ethd_callback_t
 	}
 }
 
+/**
+ * \brief Mask/Unmask the RX interrupts of a queue, used for RX interrupt
+ * coalescing. The RX complete interrupt is only unmasked if a RX callback
+ * is registered.
+ *  \param emacd Pointer to EMAC Driver instance.
+ *  \param enable Unmask the RX interrupts.
+ */
+void emacd_enable_rx_it(struct _ethd* emacd, uint8_t queue, bool enable)
+{
+	struct _ethd_queue* q = &emacd->queues[queue];
+	uint32_t bits = EMAC_INT_RX_BITS;
+
+	if (enable) {
+		if (!q->rx_callback)
+			bits &= ~EMAC_IER_RCOMP;
+		emac_enable_it(emacd->emac, bits);
+	} else {
+		emac_disable_it(emacd->emac, bits);
+	}
+}
+
+/**
+ * \brief Accumulate the statistics registers of the EMAC.
+ *  \param emacd Pointer to EMAC Driver instance.
+ */
+void emacd_update_stats(struct _ethd* emacd)
+{
+	emac_read_statistics(emacd->emac, &emacd->mac_stats);
+}
+
 const struct _ethd_op _emac_op = {
 	.configure = (_ethd_configure)emacd_configure,
 	.setup_queue = (_ethd_setup_queue)emacd_setup_queue,
@@ -505,8 +587,13 @@ const struct _ethd_op _emac_op = {
 	.get_mac_addr = (_eth_get_mac_addr)emac_get_mac_addr,
 	.start_transmission =(_eth_start_transmission)emac_start_transmission,
 	.send_sg = (_ethd_send_sg)ethd_send_sg,
+	.send_sg_zero_copy = (_ethd_send_sg_zero_copy)ethd_send_sg_zero_copy,
 	.send = (_ethd_send)ethd_send,
 	.poll = (_ethd_poll)ethd_poll,
+	.rx_loan = (_ethd_rx_loan)ethd_rx_loan,
+	.rx_return = (_ethd_rx_return)ethd_rx_return,
+	.update_stats = (_ethd_update_stats)emacd_update_stats,
 	.set_rx_callback = (_ethd_set_rx_callback)emacd_set_rx_callback,
+	.enable_rx_it = (_ethd_enable_rx_it)emacd_enable_rx_it,
 	.set_tx_wakeup_callback = (_ethd_set_tx_wakeup_callback)ethd_set_tx_wakeup_callback,
 };
@@ -40,7 +40,8 @@
  *    and ethd_set_tx_wakeup_callback().
  * -# Send ethernet packets using ethd_send(), ethd_get_tx_load() is used
  *    to get the free space in TX queue.
- * -# Check and obtain received ethernet packets via ethd_poll().
+ * -# Check and obtain received ethernet packets via ethd_poll(), or
+ *    borrow them without copy via ethd_rx_loan() and ethd_rx_return().
  *
  * \sa \ref macb_module, \ref emac_module
  *
@@ -100,7 +101,7 @@ extern "C" {
 extern void emacd_configure(struct _ethd* emacd, Emac *pHw, uint8_t enableCAF, uint8_t enableNBC);
 
 extern uint8_t emacd_setup_queue(struct _ethd* emacd, uint8_t queue,
-		uint16_t rx_size, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
+		uint16_t rx_size, uint16_t rx_unitsize, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
 		uint16_t tx_size, uint8_t* tx_buffer, struct _eth_desc* tx_desc,
 		ethd_callback_t *tx_callbacks);
 
@@ -122,6 +123,10 @@ extern uint8_t emacd_poll(struct _ethd* emacd, uint8_t queue,
 extern void emacd_set_rx_callback(struct _ethd *emacd, uint8_t queue,
 		ethd_callback_t callback);
 
+extern void emacd_update_stats(struct _ethd* emacd);
+
+extern void emacd_enable_rx_it(struct _ethd* emacd, uint8_t queue, bool enable);
+
 /** @}*/
 
 #ifdef __cplusplus
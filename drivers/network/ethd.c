@@ -53,61 +53,154 @@
  *         Constants
  *---------------------------------------------------------------------------*/
 
-/*----------------------------------------------------------------------------
- *        Local functions
- *----------------------------------------------------------------------------*/
+/* Software marker stored in the status word of the RX descriptors that are
+ * ready to be given back to the hardware. The status word of a descriptor
+ * is only updated by the hardware when the OWN bit is clear. */
+#define ETH_RX_STATUS_RELEASED 0xffffffffu
 
 /*----------------------------------------------------------------------------
- *        Exported functions
+ *        Local functions
  *----------------------------------------------------------------------------*/
 
-void ethd_set_mac_addr(struct _ethd * ethd, uint8_t sa_idx, uint8_t* mac)
+/**
+ * \brief Give back to the hardware the released RX descriptors found at the
+ * tail of the ring. Reclaim stops at the first descriptor still lent to the
+ * application.
+ * \param q Pointer to ETH queue.
+ */
+static void _ethd_rx_reclaim(struct _ethd_queue* q)
 {
-	ethd->op->set_mac_addr(ethd->addr, sa_idx, mac);
+	struct _eth_desc* desc;
+
+	while (q->rx_held) {
+		desc = &q->rx_desc[q->rx_tail];
+		if (desc->status != ETH_RX_STATUS_RELEASED)
+			break;
+		desc->status = 0;
+		desc->addr &= ~ETH_RX_ADDR_OWN;
+		RING_INC(q->rx_tail, q->rx_size);
+		q->rx_held--;
+	}
 }
 
-void ethd_get_mac_addr(struct _ethd * ethd, uint8_t sa_idx, uint8_t* mac)
+/**
+ * \brief Release RX descriptors starting at the head of the ring.
+ * \param q     Pointer to ETH queue.
+ * \param count Number of descriptors to release.
+ */
+static void _ethd_rx_release(struct _ethd_queue* q, uint32_t count)
 {
-	ethd->op->get_mac_addr(ethd->addr, sa_idx, mac);
+	while (count--) {
+		q->rx_desc[q->rx_head].status = ETH_RX_STATUS_RELEASED;
+		RING_INC(q->rx_head, q->rx_size);
+		q->rx_held++;
+		_ethd_rx_reclaim(q);
+	}
 }
 
-bool ethd_configure(struct _ethd * ethd, enum _eth_type eth_type, void * addr, uint8_t enable_caf, uint8_t enable_nbc)
+/**
+ * \brief Look for the next complete frame in the RX ring. Fragments that do
+ * not belong to a complete frame are released.
+ * \param q     Pointer to ETH queue.
+ * \param count Number of descriptors of the frame, starting at q->rx_head.
+ * \param status Status word of the last descriptor of the frame.
+ * \return ETH_OK if a frame is available, ETH_RX_NULL otherwise.
+ */
+static uint8_t _ethd_rx_next_frame(struct _ethd_queue* q, uint32_t* count, uint32_t* status)
 {
-	ethd->addr = addr;
-	ethd->op = NULL;
+	struct _eth_desc *desc;
+	uint32_t idx;
+	uint32_t cnt = 0;
+	bool sof = false;
 
-#ifdef CONFIG_HAVE_EMAC
-	if (ETH_TYPE_EMAC == eth_type)
-		ethd->op = &_emac_op;
-#endif
-#ifdef CONFIG_HAVE_GMAC
-	if (ETH_TYPE_GMAC == eth_type)
-		ethd->op = &_gmac_op;
-#endif
+	/* All descriptors are lent to the application */
+	if (q->rx_held == q->rx_size)
+		return ETH_RX_NULL;
 
-	if (NULL == ethd->op)
-		return false;
+	/* Process RX descriptors */
+	idx = q->rx_head;
+	desc = &q->rx_desc[idx];
+	while (desc->addr & ETH_RX_ADDR_OWN) {
+		/* A start of frame has been received, discard previous fragments */
+		if (desc->status & ETH_RX_STATUS_SOF) {
+			q->stats.rx_fragments += RING_CNT(idx, q->rx_head, q->rx_size);
+			_ethd_rx_release(q, RING_CNT(idx, q->rx_head, q->rx_size));
+			sof = true;
+			cnt = 0;
+		}
 
-	ethd->op->configure(ethd, addr, enable_caf, enable_nbc);
-	return true;
+		/* Increment the index */
+		RING_INC(idx, q->rx_size);
+
+		if (sof) {
+			cnt++;
+
+			/* An end of frame has been received */
+			if (desc->status & ETH_RX_STATUS_EOF) {
+				*count = cnt;
+				*status = desc->status;
+				return ETH_OK;
+			}
+
+			/* All available descriptors have been walked through */
+			if (idx == q->rx_tail) {
+				trace_info("no EOF (buffers probably too small)\r\n");
+				q->stats.rx_no_eof++;
+				_ethd_rx_release(q, cnt);
+				return ETH_RX_NULL;
+			}
+		}
+
+		/* SOF has not been detected, skip the fragment */
+		else {
+			q->stats.rx_fragments++;
+			_ethd_rx_release(q, 1);
+			if (q->rx_held == q->rx_size)
+				break;
+		}
+
+		/* Process the next buffer */
+		desc = &q->rx_desc[idx];
+	}
+	return ETH_RX_NULL;
 }
 
-uint8_t ethd_setup_queue(struct _ethd* ethd, uint8_t queue,
-			 uint16_t rx_size, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
-			 uint16_t tx_size, uint8_t* tx_buffer, struct _eth_desc* tx_desc,
-			 ethd_callback_t *tx_callbacks)
+/**
+ * \brief Tell if a received buffer is waiting at the head of the RX ring.
+ */
+static bool _ethd_rx_pending(struct _ethd_queue* q)
 {
-	return ethd->op->setup_queue(ethd, queue, rx_size, rx_buffer, rx_desc,
-		tx_size, tx_buffer, tx_desc,
-		tx_callbacks);
+	return q->rx_held < q->rx_size &&
+		(q->rx_desc[q->rx_head].addr & ETH_RX_ADDR_OWN) != 0;
 }
 
-uint8_t ethd_send_sg(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_list* sgl, ethd_callback_t callback)
+/**
+ * \brief Get the checksums verified by the MAC from the status word of the
+ * last descriptor of a frame.
+ */
+static uint8_t _ethd_rx_csum(struct _ethd* ethd, uint32_t status)
+{
+	if (!(ethd->offload & ETH_OFFLOAD_RX_CSUM))
+		return ETH_RX_CSUM_NONE;
+	return (status & ETH_RX_STATUS_CSUM_Msk) >> ETH_RX_STATUS_CSUM_Pos;
+}
+
+/**
+ * \brief Queue a frame described by a scatter-gather list for transmission.
+ * \param zero_copy If true, the TX descriptors point to the buffers of the
+ * list, which are released through the release callback once the frame has
+ * been sent. Otherwise, the buffers are copied into the TX buffers of the
+ * queue.
+ */
+static uint8_t _ethd_queue_frame(struct _ethd* ethd, uint8_t queue,
+		const struct _eth_sg_list* sgl, ethd_callback_t callback,
+		ethd_tx_release_cb_t release, void* arg, bool zero_copy)
 {
 	void* eth = ethd->addr;
 	struct _ethd_queue* q = &ethd->queues[queue];
 	struct _eth_desc* desc;
 	uint16_t idx, tx_head;
+	uint32_t max_size = zero_copy ? ETH_RX_STATUS_LENGTH_MASK : ETH_TX_UNITSIZE;
 	int i;
 
 	if (callback && !q->tx_callbacks) {
@@ -127,14 +220,25 @@ uint8_t ethd_send_sg(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_lis
 	/* Check available space */
 	if (RING_SPACE(q->tx_head, q->tx_tail, q->tx_size) < sgl->size) {
 		trace_error("ethd_send_sg: not enough free buffers in TX queue.\r\n");
+		q->stats.tx_busy++;
 		return ETH_TX_BUSY;
 	}
 
+	/* Check buffer sizes before touching the TX queue */
+	for (i = 0; i < sgl->size; i++) {
+		if (sgl->entries[i].size > max_size) {
+			trace_error("ethd_send_sg: buffer size is too big.\r\n");
+			return ETH_PARAM;
+		}
+	}
+
 	/* Tag end of TX queue */
 	tx_head = fixed_mod(q->tx_head + sgl->size, q->tx_size);
 	idx = tx_head;
 	if (q->tx_callbacks)
 		q->tx_callbacks[idx] = NULL;
+	if (q->tx_releases)
+		q->tx_releases[idx].callback = NULL;
 	desc = &q->tx_desc[idx];
 	desc->status |= ETH_TX_STATUS_USED;
 
@@ -143,25 +247,34 @@ uint8_t ethd_send_sg(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_lis
 	 */
 	for (i = sgl->size - 1; i >= 0; i--) {
 		const struct _eth_sg *sg = &sgl->entries[i];
-		uint32_t status;
-
-		if (sg->size > ETH_TX_UNITSIZE) {
-			trace_error("ethd_send_sg: buffer size is too big.\r\n");
-			return ETH_PARAM;
-		}
+		uint32_t status, addr;
 
 		RING_DEC(idx, q->tx_size);
 
 		/* Reset TX callback */
 		if (q->tx_callbacks)
 			q->tx_callbacks[idx] = NULL;
+		if (q->tx_releases)
+			q->tx_releases[idx].callback = NULL;
 
 		desc = &q->tx_desc[idx];
 
-		/* Copy data into transmittion buffer */
-		if (sg->buffer && sg->size) {
-			memcpy((void*)desc->addr, sg->buffer, sg->size);
-			cache_clean_region((void*)desc->addr, sg->size);
+		if (zero_copy) {
+			/* Transmit directly from the application buffer */
+			addr = (uint32_t)sg->buffer;
+			if (sg->buffer && sg->size)
+				cache_clean_region(sg->buffer, sg->size);
+		} else {
+			/* Copy data into transmittion buffer */
+			addr = (uint32_t)q->tx_buffer + idx * ETH_TX_UNITSIZE;
+			if (sg->buffer && sg->size) {
+				memcpy((void*)addr, sg->buffer, sg->size);
+				cache_clean_region((void*)addr, sg->size);
+			}
+		}
+		if (desc->addr != addr) {
+			desc->addr = addr;
+			dsb();
 		}
 
 		/* Compute buffer descriptor status word */
@@ -170,6 +283,10 @@ uint8_t ethd_send_sg(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_lis
 			status |= ETH_TX_STATUS_LASTBUF;
 			if (q->tx_callbacks)
 				q->tx_callbacks[idx] = callback;
+			if (q->tx_releases) {
+				q->tx_releases[idx].callback = release;
+				q->tx_releases[idx].arg = arg;
+			}
 		}
 		if (idx == (q->tx_size - 1)) {
 			status |= ETH_TX_STATUS_WRAP;
@@ -182,6 +299,7 @@ uint8_t ethd_send_sg(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_lis
 
 	/* Update TX ring buffer pointers */
 	q->tx_head = tx_head;
+	q->stats.tx_frames++;
 
 	/* Now start to transmit if it is not already done */
 	ethd->op->start_transmission(eth);
@@ -189,6 +307,186 @@ uint8_t ethd_send_sg(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_lis
 	return ETH_OK;
 }
 
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void ethd_set_mac_addr(struct _ethd * ethd, uint8_t sa_idx, uint8_t* mac)
+{
+	ethd->op->set_mac_addr(ethd->addr, sa_idx, mac);
+}
+
+void ethd_get_mac_addr(struct _ethd * ethd, uint8_t sa_idx, uint8_t* mac)
+{
+	ethd->op->get_mac_addr(ethd->addr, sa_idx, mac);
+}
+
+bool ethd_configure(struct _ethd * ethd, enum _eth_type eth_type, void * addr, uint8_t enable_caf, uint8_t enable_nbc)
+{
+	ethd->addr = addr;
+	ethd->op = NULL;
+	ethd->offload_caps = 0;
+	ethd->offload = 0;
+	memset(&ethd->mac_stats, 0, sizeof(ethd->mac_stats));
+	memset(ethd->ptp_events, 0, sizeof(ethd->ptp_events));
+	memset((void*)ethd->ptp_pending, 0, sizeof(ethd->ptp_pending));
+	ethd->ptp_callback = NULL;
+
+#ifdef CONFIG_HAVE_EMAC
+	if (ETH_TYPE_EMAC == eth_type)
+		ethd->op = &_emac_op;
+#endif
+#ifdef CONFIG_HAVE_GMAC
+	if (ETH_TYPE_GMAC == eth_type)
+		ethd->op = &_gmac_op;
+#endif
+
+	if (NULL == ethd->op)
+		return false;
+
+	ethd->op->configure(ethd, addr, enable_caf, enable_nbc);
+	return true;
+}
+
+uint32_t ethd_get_offload_caps(struct _ethd* ethd)
+{
+	return ethd->offload_caps;
+}
+
+uint8_t ethd_set_offload(struct _ethd* ethd, uint32_t offload)
+{
+	if (offload & ~ethd->offload_caps)
+		return ETH_PARAM;
+	if (ethd->op->set_offload)
+		ethd->op->set_offload(ethd, offload);
+	ethd->offload = offload;
+	return ETH_OK;
+}
+
+uint32_t ethd_get_offload(struct _ethd* ethd)
+{
+	return ethd->offload;
+}
+
+void ethd_get_stats(struct _ethd* ethd, struct _eth_stats* stats)
+{
+	int i;
+
+	if (ethd->op->update_stats)
+		ethd->op->update_stats(ethd);
+	stats->mac = ethd->mac_stats;
+	for (i = 0; i < ETH_NUM_QUEUES; i++)
+		stats->queues[i] = ethd->queues[i].stats;
+}
+
+void ethd_reset_stats(struct _ethd* ethd)
+{
+	int i;
+
+	/* Clear the hardware counters by reading them */
+	if (ethd->op->update_stats)
+		ethd->op->update_stats(ethd);
+	memset(&ethd->mac_stats, 0, sizeof(ethd->mac_stats));
+	for (i = 0; i < ETH_NUM_QUEUES; i++)
+		memset(&ethd->queues[i].stats, 0, sizeof(ethd->queues[i].stats));
+}
+
+void ethd_dump_stats(struct _ethd* ethd)
+{
+	struct _eth_stats stats;
+	const struct _eth_mac_stats* mac = &stats.mac;
+	int i;
+
+	ethd_get_stats(ethd, &stats);
+
+	printf("TX: %llu octets, %u frames (%u bcast, %u mcast)\r\n",
+	       (unsigned long long)mac->tx_octets, (unsigned)mac->tx_frames,
+	       (unsigned)mac->tx_broadcast, (unsigned)mac->tx_multicast);
+	printf("    underruns %u, collisions %u/%u/%u, carrier %u\r\n",
+	       (unsigned)mac->tx_underruns, (unsigned)mac->tx_collisions,
+	       (unsigned)mac->tx_excessive_collisions,
+	       (unsigned)mac->tx_late_collisions,
+	       (unsigned)mac->tx_carrier_errors);
+	printf("RX: %llu octets, %u frames (%u bcast, %u mcast)\r\n",
+	       (unsigned long long)mac->rx_octets, (unsigned)mac->rx_frames,
+	       (unsigned)mac->rx_broadcast, (unsigned)mac->rx_multicast);
+	printf("    fcs %u, align %u, length %u, undersize %u, oversize %u, jabber %u, symbol %u\r\n",
+	       (unsigned)mac->rx_fcs_errors, (unsigned)mac->rx_alignment_errors,
+	       (unsigned)mac->rx_length_errors, (unsigned)mac->rx_undersize,
+	       (unsigned)mac->rx_oversize, (unsigned)mac->rx_jabbers,
+	       (unsigned)mac->rx_symbol_errors);
+	printf("    no buffer %u, overrun %u, csum ip %u tcp %u udp %u\r\n",
+	       (unsigned)mac->rx_resource_errors, (unsigned)mac->rx_overruns,
+	       (unsigned)mac->rx_ip_csum_errors,
+	       (unsigned)mac->rx_tcp_csum_errors,
+	       (unsigned)mac->rx_udp_csum_errors);
+
+	for (i = 0; i < ETH_NUM_QUEUES; i++) {
+		const struct _eth_queue_stats* q = &stats.queues[i];
+		if (!q->tx_frames && !q->tx_busy && !q->tx_errors &&
+		    !q->rx_frames && !q->rx_fragments && !q->rx_no_eof &&
+		    !q->rx_too_small)
+			continue;
+		printf("Q%d: TX %u, busy %u, errors %u / RX %u, fragments %u, no EOF %u, too small %u\r\n",
+		       i, (unsigned)q->tx_frames, (unsigned)q->tx_busy,
+		       (unsigned)q->tx_errors, (unsigned)q->rx_frames,
+		       (unsigned)q->rx_fragments, (unsigned)q->rx_no_eof,
+		       (unsigned)q->rx_too_small);
+	}
+}
+
+uint8_t ethd_enable_jumbo_frames(struct _ethd* ethd, bool enable)
+{
+	if (!ethd->op->enable_jumbo_frames)
+		return ETH_PARAM;
+	ethd->op->enable_jumbo_frames(ethd, enable);
+	return ETH_OK;
+}
+
+uint8_t ethd_setup_queue(struct _ethd* ethd, uint8_t queue,
+			 uint16_t rx_size, uint16_t rx_unitsize, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
+			 uint16_t tx_size, uint8_t* tx_buffer, struct _eth_desc* tx_desc,
+			 ethd_callback_t *tx_callbacks)
+{
+	return ethd->op->setup_queue(ethd, queue, rx_size, rx_unitsize, rx_buffer, rx_desc,
+		tx_size, tx_buffer, tx_desc,
+		tx_callbacks);
+}
+
+uint8_t ethd_send_sg(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_list* sgl, ethd_callback_t callback)
+{
+	return _ethd_queue_frame(ethd, queue, sgl, callback, NULL, NULL, false);
+}
+
+uint8_t ethd_send_sg_zero_copy(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_list* sgl, ethd_tx_release_cb_t release, void* arg)
+{
+	if (!ethd->queues[queue].tx_releases) {
+		trace_error("ethd_send_sg_zero_copy: no tx_releases buffer configured for queue %u\r\n", queue);
+		return ETH_NOT_INITIALIZED;
+	}
+
+	return _ethd_queue_frame(ethd, queue, sgl, NULL, release, arg, true);
+}
+
+uint8_t ethd_setup_tx_release(struct _ethd* ethd, uint8_t queue, struct _eth_tx_release* tx_releases)
+{
+	struct _ethd_queue* q = &ethd->queues[queue];
+	uint32_t i;
+
+	if (!RING_EMPTY(q->tx_head, q->tx_tail))
+		return ETH_TX_BUSY;
+
+	if (tx_releases) {
+		for (i = 0; i < q->tx_size; i++) {
+			tx_releases[i].callback = NULL;
+			tx_releases[i].arg = NULL;
+		}
+	}
+	q->tx_releases = tx_releases;
+
+	return ETH_OK;
+}
+
 void ethd_start(struct _ethd* ethd)
 {
 	ethd->op->start(ethd);
@@ -221,10 +519,9 @@ uint32_t ethd_get_tx_load(struct _ethd* ethd, uint8_t queue)
 uint8_t ethd_poll(struct _ethd* ethd, uint8_t queue, uint8_t* buffer, uint32_t buffer_size, uint32_t* recv_size)
 {
 	struct _ethd_queue* q = &ethd->queues[queue];
-	struct _eth_desc *desc;
-	uint32_t idx;
+	uint32_t idx, count, status, frame_size, i;
 	uint32_t cur_frame_size = 0;
-	uint8_t *cur_frame = 0;
+	uint8_t rc;
 
 	if (!buffer)
 		return ETH_PARAM;
@@ -232,83 +529,111 @@ uint8_t ethd_poll(struct _ethd* ethd, uint8_t queue, uint8_t* buffer, uint32_t b
 	/* Set the default return value */
 	*recv_size = 0;
 
-	/* Process RX descriptors */
+	rc = _ethd_rx_next_frame(q, &count, &status);
+	if (rc != ETH_OK)
+		return rc;
+	frame_size = status & ETH_RX_STATUS_LENGTH_MASK;
+	q->rx_csum = _ethd_rx_csum(ethd, status);
+
+	/* Copy the buffers into the application frame */
 	idx = q->rx_head;
-	desc = &q->rx_desc[idx];
-	while (desc->addr & ETH_RX_ADDR_OWN) {
-		/* A start of frame has been received, discard previous fragments */
-		if (desc->status & ETH_RX_STATUS_SOF) {
-			/* Skip previous fragment */
-			while (idx != q->rx_head) {
-				desc = &q->rx_desc[q->rx_head];
-				desc->addr &= ~ETH_RX_ADDR_OWN;
-				RING_INC(q->rx_head, q->rx_size);
-			}
-			cur_frame = buffer;
-			cur_frame_size = 0;
+	for (i = 0; i < count && cur_frame_size < buffer_size; i++) {
+		void* addr = (void*)(q->rx_desc[idx].addr & ETH_RX_ADDR_MASK);
+		uint32_t length = min_u32(q->rx_unitsize, frame_size - cur_frame_size);
+		if ((cur_frame_size + length) > buffer_size) {
+			length = buffer_size - cur_frame_size;
 		}
 
-		/* Increment the index */
+		cache_invalidate_region(addr, length);
+		memcpy(buffer + cur_frame_size, addr, length);
+		cur_frame_size += length;
 		RING_INC(idx, q->rx_size);
+	}
 
-		/* Copy data in the frame buffer */
-		if (cur_frame) {
-			if (idx == q->rx_head) {
-				trace_info("no EOF (buffers probably too small)\r\n");
+	/* Frame size from the ETH */
+	*recv_size = frame_size;
 
-				do {
-					desc = &q->rx_desc[q->rx_head];
-					desc->addr &= ~ETH_RX_ADDR_OWN;
-					RING_INC(q->rx_head, q->rx_size);
-				} while (idx != q->rx_head);
-				return ETH_RX_NULL;
-			}
+	/* Application frame buffer is too small all data have not been
+	 * copied */
+	if (cur_frame_size < frame_size) {
+		q->stats.rx_too_small++;
+		return ETH_SIZE_TOO_SMALL;
+	}
 
-			/* Copy the buffer into the application frame */
-			uint32_t length = ETH_RX_UNITSIZE;
-			if ((cur_frame_size + length) > buffer_size) {
-				length = buffer_size - cur_frame_size;
-			}
+	/* All data have been copied in the application frame buffer =>
+	 * release descriptors */
+	_ethd_rx_release(q, count);
+	q->rx_stats.frames++;
+	q->stats.rx_frames++;
 
-			void* addr = (void*)(desc->addr & ETH_RX_ADDR_MASK);
-			cache_invalidate_region(addr, length);
-			memcpy(cur_frame, addr, length);
-			cur_frame += length;
-			cur_frame_size += length;
+	return ETH_OK;
+}
 
-			/* An end of frame has been received, return the data */
-			if (desc->status & ETH_RX_STATUS_EOF) {
-				/* Frame size from the ETH */
-				*recv_size = desc->status & ETH_RX_STATUS_LENGTH_MASK;
-
-				/* Application frame buffer is too small all
-				 * data have not been copied */
-				if (cur_frame_size < *recv_size) {
-					return ETH_SIZE_TOO_SMALL;
-				}
-
-				/* All data have been copied in the application
-				 * frame buffer => release descriptors */
-				while (q->rx_head != idx) {
-					desc = &q->rx_desc[q->rx_head];
-					desc->addr &= ~ETH_RX_ADDR_OWN;
-					RING_INC(q->rx_head, q->rx_size);
-				}
+uint8_t ethd_rx_loan(struct _ethd* ethd, uint8_t queue, struct _eth_rx_loan* loan)
+{
+	struct _ethd_queue* q = &ethd->queues[queue];
+	struct _eth_sg* sg;
+	uint32_t count, status, frame_size, remaining, i;
+	uint8_t rc;
 
-				return ETH_OK;
-			}
-		}
+	if (!loan || !loan->sgl.entries || !loan->sgl.size)
+		return ETH_PARAM;
 
-		/* SOF has not been detected, skip the fragment */
-		else {
-			desc->addr &= ~ETH_RX_ADDR_OWN;
-			q->rx_head = idx;
-		}
+	rc = _ethd_rx_next_frame(q, &count, &status);
+	if (rc != ETH_OK)
+		return rc;
+	frame_size = status & ETH_RX_STATUS_LENGTH_MASK;
+
+	loan->size = frame_size;
+	loan->csum = _ethd_rx_csum(ethd, status);
+	if (count > loan->sgl.size) {
+		trace_info("ethd_rx_loan: frame has too many buffers\r\n");
+		q->stats.rx_too_small++;
+		_ethd_rx_release(q, count);
+		return ETH_SIZE_TOO_SMALL;
+	}
 
-		/* Process the next buffer */
-		desc = &q->rx_desc[idx];
+	/* Lend the buffers of the frame to the application */
+	loan->index = q->rx_head;
+	loan->count = count;
+	loan->sgl.size = count;
+	remaining = frame_size;
+	for (i = 0; i < count; i++) {
+		sg = &loan->sgl.entries[i];
+		sg->buffer = (void*)(q->rx_desc[q->rx_head].addr & ETH_RX_ADDR_MASK);
+		sg->size = min_u32(remaining, q->rx_unitsize);
+		sg->next = (i + 1) < count ? sg + 1 : NULL;
+		cache_invalidate_region(sg->buffer, sg->size);
+		remaining -= sg->size;
+
+		q->rx_desc[q->rx_head].status = 0;
+		RING_INC(q->rx_head, q->rx_size);
+		q->rx_held++;
 	}
-	return ETH_RX_NULL;
+	q->rx_stats.frames++;
+	q->stats.rx_frames++;
+
+	return ETH_OK;
+}
+
+void ethd_rx_return(struct _ethd* ethd, uint8_t queue, const struct _eth_rx_loan* loan)
+{
+	struct _ethd_queue* q = &ethd->queues[queue];
+	uint32_t idx = loan->index;
+	uint32_t i;
+
+	for (i = 0; i < loan->count; i++) {
+		void* addr = (void*)(q->rx_desc[idx].addr & ETH_RX_ADDR_MASK);
+		cache_invalidate_region(addr, q->rx_unitsize);
+		q->rx_desc[idx].status = ETH_RX_STATUS_RELEASED;
+		RING_INC(idx, q->rx_size);
+	}
+	_ethd_rx_reclaim(q);
+}
+
+uint8_t ethd_get_rx_csum(struct _ethd* ethd, uint8_t queue)
+{
+	return ethd->queues[queue].rx_csum;
 }
 
 void ethd_set_rx_callback(struct _ethd *ethd, uint8_t queue, ethd_callback_t callback)
@@ -316,6 +641,85 @@ void ethd_set_rx_callback(struct _ethd *ethd, uint8_t queue, ethd_callback_t cal
 	ethd->op->set_rx_callback(ethd, queue, callback);
 }
 
+void ethd_set_rx_budget(struct _ethd* ethd, uint8_t queue, uint16_t budget)
+{
+	ethd->queues[queue].rx_budget = budget;
+}
+
+uint16_t ethd_get_rx_budget(struct _ethd* ethd, uint8_t queue)
+{
+	return ethd->queues[queue].rx_budget;
+}
+
+uint8_t ethd_set_rx_coalescing(struct _ethd* ethd, uint8_t queue, bool enable, uint16_t holdoff)
+{
+	struct _ethd_queue* q = &ethd->queues[queue];
+
+	if (!ethd->op->enable_rx_it)
+		return ETH_PARAM;
+
+	q->rx_holdoff = holdoff;
+	q->rx_coalesce = enable;
+	if (!enable && q->rx_polling) {
+		q->rx_polling = false;
+		ethd->op->enable_rx_it(ethd, queue, true);
+	}
+	return ETH_OK;
+}
+
+bool ethd_rx_poll_complete(struct _ethd* ethd, uint8_t queue)
+{
+	struct _ethd_queue* q = &ethd->queues[queue];
+
+	q->rx_stats.polls++;
+	if (!q->rx_polling)
+		return true;
+
+	/* Frames are still waiting: budget exhausted, keep polling */
+	if (_ethd_rx_pending(q))
+		return false;
+
+	/* Rate limit the RX interrupt, polling goes on until then */
+	if (q->rx_holdoff && !timer_timeout_reached(&q->rx_holdoff_timeout))
+		return false;
+
+	q->rx_polling = false;
+	dmb();
+	ethd->op->enable_rx_it(ethd, queue, true);
+
+	/* A frame received while the interrupt was masked would not raise it
+	 * again, check the ring once more */
+	if (_ethd_rx_pending(q)) {
+		ethd->op->enable_rx_it(ethd, queue, false);
+		q->rx_polling = true;
+		return false;
+	}
+	return true;
+}
+
+void ethd_get_rx_coalesce_stats(struct _ethd* ethd, uint8_t queue, struct _eth_rx_coalesce_stats* stats)
+{
+	*stats = ethd->queues[queue].rx_stats;
+}
+
+void ethd_reset_rx_coalesce_stats(struct _ethd* ethd, uint8_t queue)
+{
+	memset(&ethd->queues[queue].rx_stats, 0, sizeof(struct _eth_rx_coalesce_stats));
+}
+
+uint8_t ethd_add_screener(struct _ethd* ethd, const struct _eth_screener* screener)
+{
+	if (!ethd->op->add_screener)
+		return ETH_PARAM;
+	return ethd->op->add_screener(ethd, screener);
+}
+
+void ethd_clear_screeners(struct _ethd* ethd)
+{
+	if (ethd->op->clear_screeners)
+		ethd->op->clear_screeners(ethd);
+}
+
 uint8_t ethd_set_tx_wakeup_callback(struct _ethd* ethd, uint8_t queue, ethd_wakeup_cb_t callback, uint16_t threshold)
 {
 	struct _ethd_queue* q = &ethd->queues[queue];
@@ -332,3 +736,57 @@ uint8_t ethd_set_tx_wakeup_callback(struct _ethd* ethd, uint8_t queue, ethd_wake
 
 	return ETH_OK;
 }
+
+uint8_t ethd_ptp_get_time(struct _ethd* ethd, struct _eth_timestamp* ts)
+{
+	if (!(ethd->offload & ETH_OFFLOAD_PTP))
+		return ETH_PARAM;
+	ethd->op->ptp_get_time(ethd, ts);
+	return ETH_OK;
+}
+
+uint8_t ethd_ptp_set_time(struct _ethd* ethd, const struct _eth_timestamp* ts)
+{
+	if (!(ethd->offload & ETH_OFFLOAD_PTP))
+		return ETH_PARAM;
+	ethd->op->ptp_set_time(ethd, ts);
+	return ETH_OK;
+}
+
+uint8_t ethd_ptp_adjust_time(struct _ethd* ethd, int32_t nsec)
+{
+	if (!(ethd->offload & ETH_OFFLOAD_PTP))
+		return ETH_PARAM;
+	ethd->op->ptp_adjust_time(ethd, nsec);
+	return ETH_OK;
+}
+
+uint8_t ethd_ptp_adjust_freq(struct _ethd* ethd, int32_t ppb)
+{
+	if (!(ethd->offload & ETH_OFFLOAD_PTP))
+		return ETH_PARAM;
+	ethd->op->ptp_adjust_freq(ethd, ppb);
+	return ETH_OK;
+}
+
+uint8_t ethd_ptp_get_event(struct _ethd* ethd, uint8_t event, struct _eth_timestamp* ts)
+{
+	if (!(ethd->offload & ETH_OFFLOAD_PTP) || event >= ETH_PTP_EVENTS)
+		return ETH_PARAM;
+	if (!ethd->ptp_pending[event])
+		return ETH_RX_NULL;
+
+	/* Copy again if the interrupt handler updated the timestamp */
+	do {
+		ethd->ptp_pending[event] = 0;
+		dmb();
+		*ts = ethd->ptp_events[event];
+		dmb();
+	} while (ethd->ptp_pending[event]);
+	return ETH_OK;
+}
+
+void ethd_ptp_set_callback(struct _ethd* ethd, ethd_ptp_callback_t callback)
+{
+	ethd->ptp_callback = callback;
+}
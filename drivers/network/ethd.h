@@ -56,6 +56,7 @@
  *----------------------------------------------------------------------------*/
 
 #include "chip.h"
+#include "timer.h"
 
 #include <stdint.h>
 
@@ -81,6 +82,10 @@ enum _eth_speed {
 /** The MAC can support frame lengths up to 1536 bytes. */
 #define ETH_MAX_FRAME_LENGTH 1536
 
+/** The GMAC can receive frames up to 10240 bytes once jumbo frames are
+ * enabled with ethd_enable_jumbo_frames(). */
+#define ETH_MAX_JUMBO_FRAME_LENGTH 10240
+
 /* Bits contained in struct _eth_desc addr when used for RX*/
 #define ETH_RX_ADDR_OWN  (1u << 0)
 #define ETH_RX_ADDR_WRAP (1u << 1)
@@ -90,6 +95,8 @@ enum _eth_speed {
 #define ETH_RX_STATUS_LENGTH_MASK 0x3fffu
 #define ETH_RX_STATUS_SOF         (1u << 14)
 #define ETH_RX_STATUS_EOF         (1u << 15)
+#define ETH_RX_STATUS_CSUM_Pos    22
+#define ETH_RX_STATUS_CSUM_Msk    (0x3u << ETH_RX_STATUS_CSUM_Pos)
 
 /* Bits contained in struct _eth_desc status when used for TX */
 #define ETH_TX_STATUS_LASTBUF (1u << 15)
@@ -100,7 +107,8 @@ enum _eth_speed {
 
 /** \addtogroup eth_buf_size ETH(EMACD/GMACD) Default Buffer Size
         @{*/
-#define ETH_RX_UNITSIZE            128  /**< RX buffer size, must be 128 */
+#define ETH_RX_UNITSIZE            128  /**< Default RX buffer size, the only
+					   one supported by the EMAC */
 #define ETH_TX_UNITSIZE            1536 /**< TX buffer size, must be multiple
 					   of 32 (cache line) */
 /**     @}*/
@@ -116,6 +124,8 @@ enum _eth_speed {
 #define ETH_PARAM             3
 /** Transter is not initialized */
 #define ETH_NOT_INITIALIZED   4
+/** No free hardware resource (e.g. screening register) */
+#define ETH_NO_RESOURCE       5
 
 enum _eth_type {
 	ETH_TYPE_EMAC,
@@ -124,6 +134,44 @@ enum _eth_type {
 
 /**     @}*/
 
+/** \addtogroup eth_offload ETH(EMACD/GMACD) Offload Features
+        @{*/
+/** Verify IP/TCP/UDP checksums of received frames, drop frames with bad
+ * checksums */
+#define ETH_OFFLOAD_RX_CSUM   (1u << 0)
+/** Generate IP/TCP/UDP checksums of sent frames */
+#define ETH_OFFLOAD_TX_CSUM   (1u << 1)
+/** Run the IEEE 1588 timer and timestamp the PTP event frames */
+#define ETH_OFFLOAD_PTP       (1u << 2)
+
+#define ETH_RX_CSUM_NONE      0   /**< No checksum verified */
+#define ETH_RX_CSUM_IP        1   /**< IP header checksum verified */
+#define ETH_RX_CSUM_TCP       2   /**< IP header and TCP checksums verified */
+#define ETH_RX_CSUM_UDP       3   /**< IP header and UDP checksums verified */
+/**     @}*/
+
+/** \addtogroup eth_ptp ETH(GMACD) IEEE 1588 PTP Event Frames
+        @{*/
+#define ETH_PTP_SYNC_RX        0 /**< Sync received */
+#define ETH_PTP_SYNC_TX        1 /**< Sync sent */
+#define ETH_PTP_DELAY_REQ_RX   2 /**< Delay_Req received */
+#define ETH_PTP_DELAY_REQ_TX   3 /**< Delay_Req sent */
+#define ETH_PTP_PDELAY_REQ_RX  4 /**< Pdelay_Req received */
+#define ETH_PTP_PDELAY_REQ_TX  5 /**< Pdelay_Req sent */
+#define ETH_PTP_PDELAY_RESP_RX 6 /**< Pdelay_Resp received */
+#define ETH_PTP_PDELAY_RESP_TX 7 /**< Pdelay_Resp sent */
+#define ETH_PTP_EVENTS         8
+/**     @}*/
+
+/** \addtogroup eth_screener ETH(GMACD) RX Screening Match Flags
+        @{*/
+#define ETH_SCREENER_ETHERTYPE (1u << 0) /**< Match the EtherType */
+#define ETH_SCREENER_VLAN_PRIO (1u << 1) /**< Match the VLAN priority (PCP) */
+#define ETH_SCREENER_DSCP      (1u << 2) /**< Match the IPv4 DSCP */
+#define ETH_SCREENER_UDP_PORT  (1u << 3) /**< Match the UDP destination port */
+#define ETH_SCREENER_TCP_PORT  (1u << 4) /**< Match the TCP destination port */
+/**     @}*/
+
 /*----------------------------------------------------------------------------
  *        Types
  *----------------------------------------------------------------------------*/
@@ -150,6 +198,89 @@ struct _eth_sg_list {
 	struct _eth_sg *entries;
 };
 
+/** ETH RX frame lent to the application by ethd_rx_loan() */
+struct _eth_rx_loan {
+	struct _eth_sg_list sgl; /**< RX buffers holding the frame */
+	uint32_t size;           /**< Frame size in bytes */
+	uint16_t index;          /**< First RX descriptor of the frame */
+	uint16_t count;          /**< Number of RX descriptors of the frame */
+	uint8_t csum;            /**< Checksums verified by the MAC
+	                              (ETH_RX_CSUM_*) */
+};
+
+/** ETH IEEE 1588 timer value */
+struct _eth_timestamp {
+	uint32_t sec;  /**< Seconds */
+	uint32_t nsec; /**< Nanoseconds, 0 to 999999999 */
+};
+
+/** ETH RX interrupt coalescing counters, frames / interrupts gives the
+ * number of frames handled per RX interrupt */
+struct _eth_rx_coalesce_stats {
+	uint32_t interrupts; /**< RX interrupts handled */
+	uint32_t polls;      /**< Polling rounds, see ethd_rx_poll_complete() */
+	uint32_t frames;     /**< Frames received */
+};
+
+/** ETH MAC statistics, accumulated from the hardware counters. Counters
+ * not implemented by the MAC stay at 0. */
+struct _eth_mac_stats {
+	uint64_t tx_octets;               /**< Octets sent */
+	uint32_t tx_frames;               /**< Frames sent */
+	uint32_t tx_broadcast;            /**< Broadcast frames sent */
+	uint32_t tx_multicast;            /**< Multicast frames sent */
+	uint32_t tx_underruns;            /**< Frames aborted on DMA underrun */
+	uint32_t tx_collisions;           /**< Frames sent after collisions */
+	uint32_t tx_excessive_collisions; /**< Frames aborted after 16 collisions */
+	uint32_t tx_late_collisions;      /**< Late collisions */
+	uint32_t tx_carrier_errors;       /**< Carrier sense errors */
+	uint64_t rx_octets;               /**< Octets received */
+	uint32_t rx_frames;               /**< Frames received */
+	uint32_t rx_broadcast;            /**< Broadcast frames received */
+	uint32_t rx_multicast;            /**< Multicast frames received */
+	uint32_t rx_fcs_errors;           /**< Frames with bad FCS */
+	uint32_t rx_alignment_errors;     /**< Frames not a multiple of 8 bits */
+	uint32_t rx_length_errors;        /**< Frames with a bad length field */
+	uint32_t rx_undersize;            /**< Frames shorter than 64 bytes */
+	uint32_t rx_oversize;             /**< Frames longer than the maximum */
+	uint32_t rx_jabbers;              /**< Oversize frames with bad FCS */
+	uint32_t rx_symbol_errors;        /**< Frames with symbol errors */
+	uint32_t rx_resource_errors;      /**< Frames dropped, no free RX buffer */
+	uint32_t rx_overruns;             /**< Frames dropped on DMA overrun */
+	uint32_t rx_ip_csum_errors;       /**< Frames with bad IP checksum */
+	uint32_t rx_tcp_csum_errors;      /**< Frames with bad TCP checksum */
+	uint32_t rx_udp_csum_errors;      /**< Frames with bad UDP checksum */
+};
+
+/** ETH driver counters of a queue */
+struct _eth_queue_stats {
+	uint32_t tx_frames;       /**< Frames queued for transmission */
+	uint32_t tx_busy;         /**< Frames rejected, TX queue full */
+	uint32_t tx_errors;       /**< Frames dropped on TX error */
+	uint32_t rx_frames;       /**< Frames given to the application */
+	uint32_t rx_fragments;    /**< RX buffers dropped, not part of a frame */
+	uint32_t rx_no_eof;       /**< Frames dropped, end of frame missing */
+	uint32_t rx_too_small;    /**< Frames not fitting the application
+	                               buffer */
+};
+
+/** ETH statistics, see ethd_get_stats() */
+struct _eth_stats {
+	struct _eth_mac_stats mac;
+	struct _eth_queue_stats queues[ETH_NUM_QUEUES];
+};
+
+/** ETH RX screening rule, steering the matching frames to a queue.
+ * All the fields selected by match must be equal for a frame to match. */
+struct _eth_screener {
+	uint8_t  queue;     /**< Destination RX queue */
+	uint8_t  match;     /**< Fields to match (ETH_SCREENER_*) */
+	uint16_t ethertype; /**< EtherType */
+	uint8_t  vlan_prio; /**< VLAN priority, 0 to 7 */
+	uint8_t  dscp;      /**< IPv4 DSCP, 0 to 63 */
+	uint16_t port;      /**< UDP or TCP destination port */
+};
+
 /** @}*/
 
 /** \addtogroup ethd_types
@@ -158,13 +289,20 @@ struct _eth_sg_list {
 /** RX/TX callback */
 typedef void (*ethd_callback_t)(uint8_t queue, uint32_t status);
 
+/** TX release callback, invoked once a frame sent without copy is done */
+typedef void (*ethd_tx_release_cb_t)(uint8_t queue, uint32_t status, void* arg);
+
 /** TX Wakeup callback */
 typedef void (*ethd_wakeup_cb_t)(uint8_t queue);
 
+/** PTP event callback, invoked from interrupt context with the timestamp
+ * of a PTP event frame (ETH_PTP_*) */
+typedef void (*ethd_ptp_callback_t)(uint8_t event, const struct _eth_timestamp* ts);
+
 typedef void (*_ethd_configure)(void* ethd, void *pHw, uint8_t enable_caf, uint8_t enable_nbc);
 
 typedef uint8_t (*_ethd_setup_queue)(void* ethd, uint8_t queue,
-		uint16_t rx_size, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
+		uint16_t rx_size, uint16_t rx_unitsize, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
 		uint16_t tx_size, uint8_t* tx_buffer, struct _eth_desc* tx_desc,
 		ethd_callback_t *tx_callbacks);
 
@@ -180,14 +318,40 @@ typedef void (*_eth_start_transmission)(void * eth);
 
 typedef uint8_t (*_ethd_send_sg)(void* ethd, uint8_t queue, const struct _eth_sg_list* sgl, ethd_callback_t callback);
 
+typedef uint8_t (*_ethd_send_sg_zero_copy)(void* ethd, uint8_t queue, const struct _eth_sg_list* sgl, ethd_tx_release_cb_t release, void* arg);
+
 typedef uint8_t (*_ethd_send)(void* ethd, uint8_t queue, void *buffer, uint32_t size, ethd_callback_t callback);
 
 typedef uint32_t (*_ethd_get_tx_load)(void* ethd, uint8_t queue);
 
 typedef uint8_t (*_ethd_poll)(void* ethd, uint8_t queue, uint8_t* buffer, uint32_t buffer_size, uint32_t* recv_size);
 
+typedef uint8_t (*_ethd_rx_loan)(void* ethd, uint8_t queue, struct _eth_rx_loan* loan);
+
+typedef void (*_ethd_rx_return)(void* ethd, uint8_t queue, const struct _eth_rx_loan* loan);
+
+typedef void (*_ethd_set_offload)(void* ethd, uint32_t offload);
+
+typedef void (*_ethd_update_stats)(void* ethd);
+
+typedef void (*_ethd_enable_jumbo_frames)(void* ethd, bool enable);
+
+typedef uint8_t (*_ethd_add_screener)(void* ethd, const struct _eth_screener* screener);
+
+typedef void (*_ethd_clear_screeners)(void* ethd);
+
+typedef void (*_ethd_ptp_get_time)(void* ethd, struct _eth_timestamp* ts);
+
+typedef void (*_ethd_ptp_set_time)(void* ethd, const struct _eth_timestamp* ts);
+
+typedef void (*_ethd_ptp_adjust_time)(void* ethd, int32_t nsec);
+
+typedef void (*_ethd_ptp_adjust_freq)(void* ethd, int32_t ppb);
+
 typedef void (*_ethd_set_rx_callback)(void *ethd, uint8_t queue, ethd_callback_t callback);
 
+typedef void (*_ethd_enable_rx_it)(void *ethd, uint8_t queue, bool enable);
+
 typedef uint8_t (*_ethd_set_tx_wakeup_callback)(void *ethd, uint8_t queue, ethd_wakeup_cb_t wakeup_callback, uint16_t threshold);
 
 /** @}*/
@@ -195,6 +359,12 @@ typedef uint8_t (*_ethd_set_tx_wakeup_callback)(void *ethd, uint8_t queue, ethd_
 /** \addtogroup ethd_structs
 	@{*/
 
+/** Release callback of a frame sent without copy */
+struct _eth_tx_release {
+	ethd_tx_release_cb_t callback;
+	void                *arg;
+};
+
 struct _ethd_op {
 	_ethd_configure configure;
 	_ethd_setup_queue setup_queue;
@@ -204,9 +374,22 @@ struct _ethd_op {
 	_eth_get_mac_addr get_mac_addr;
 	_eth_start_transmission start_transmission;
 	_ethd_send_sg send_sg;
+	_ethd_send_sg_zero_copy send_sg_zero_copy;
 	_ethd_send send;
 	_ethd_poll poll;
+	_ethd_rx_loan rx_loan;
+	_ethd_rx_return rx_return;
+	_ethd_set_offload set_offload;
+	_ethd_update_stats update_stats;
+	_ethd_enable_jumbo_frames enable_jumbo_frames;
+	_ethd_add_screener add_screener;
+	_ethd_clear_screeners clear_screeners;
+	_ethd_ptp_get_time ptp_get_time;
+	_ethd_ptp_set_time ptp_set_time;
+	_ethd_ptp_adjust_time ptp_adjust_time;
+	_ethd_ptp_adjust_freq ptp_adjust_freq;
 	_ethd_set_rx_callback set_rx_callback;
+	_ethd_enable_rx_it enable_rx_it;
 	_ethd_set_tx_wakeup_callback set_tx_wakeup_callback;
 };
 
@@ -214,18 +397,32 @@ struct _ethd_queue {
 	uint8_t          *rx_buffer;
 	struct _eth_desc *rx_desc;
 	uint16_t          rx_size;
+	uint16_t          rx_unitsize;
 	uint16_t          rx_head;
+	uint16_t          rx_tail;
+	uint16_t          rx_held;
+	uint8_t           rx_csum;
+	uint16_t          rx_budget;
 	ethd_callback_t   rx_callback;
 
+	bool              rx_coalesce;  /**< RX interrupt masked until polled */
+	volatile bool     rx_polling;   /**< RX interrupt currently masked */
+	uint16_t          rx_holdoff;   /**< Minimum ticks between RX interrupts */
+	struct _timeout   rx_holdoff_timeout;
+	struct _eth_rx_coalesce_stats rx_stats;
+
 	uint8_t          *tx_buffer;
 	struct _eth_desc *tx_desc;
 	uint16_t          tx_size;
 	uint16_t          tx_head;
 	uint16_t          tx_tail;
 	ethd_callback_t  *tx_callbacks;
+	struct _eth_tx_release *tx_releases;
 
 	ethd_wakeup_cb_t tx_wakeup_callback;
 	uint16_t         tx_wakeup_threshold;
+
+	struct _eth_queue_stats stats;
 };
 
 /**
@@ -243,6 +440,15 @@ struct _ethd {
 	};
 	struct _ethd_queue queues[ETH_NUM_QUEUES];
 	const struct _ethd_op *op;
+	uint32_t offload_caps; /**< Offload features supported (ETH_OFFLOAD_*) */
+	uint32_t offload;      /**< Offload features enabled (ETH_OFFLOAD_*) */
+	struct _eth_mac_stats mac_stats; /**< Accumulated hardware counters */
+
+	/** Timestamps of the last PTP event frames */
+	struct _eth_timestamp ptp_events[ETH_PTP_EVENTS];
+	/** Timestamps not yet read with ethd_ptp_get_event() */
+	volatile uint8_t ptp_pending[ETH_PTP_EVENTS];
+	ethd_ptp_callback_t ptp_callback;
 };
 
 /** @}*/
@@ -264,11 +470,72 @@ extern void ethd_get_mac_addr(struct _ethd * ethd, uint8_t sa_idx, uint8_t* mac)
 
 extern bool ethd_configure(struct _ethd * ethd, enum _eth_type eth_type, void * addr, uint8_t enable_caf, uint8_t enable_nbc);
 
+/**
+ * \brief Get the offload features supported by the MAC.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \return Mask of ETH_OFFLOAD_* flags
+ */
+extern uint32_t ethd_get_offload_caps(struct _ethd* ethd);
+
+/**
+ * \brief Enable the given offload features and disable the others.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param offload Mask of ETH_OFFLOAD_* flags
+ *  \return ETH_OK, or ETH_PARAM if a feature is not supported by the MAC.
+ */
+extern uint8_t ethd_set_offload(struct _ethd* ethd, uint32_t offload);
+
+/**
+ * \brief Get the enabled offload features.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \return Mask of ETH_OFFLOAD_* flags
+ */
+extern uint32_t ethd_get_offload(struct _ethd* ethd);
+
+/**
+ * \brief Set up the RX/TX buffers and descriptors of a queue.
+ * The RX buffers of the queue are rx_unitsize bytes each, the EMAC only
+ * supports ETH_RX_UNITSIZE. Larger RX buffers (up to 1536 bytes for a
+ * full-size frame) need fewer descriptors per frame on the GMAC.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \return ETH_OK, or ETH_PARAM if a size is not supported by the MAC.
+ */
 extern uint8_t ethd_setup_queue(struct _ethd* ethd, uint8_t queue,
-								uint16_t rx_size, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
+								uint16_t rx_size, uint16_t rx_unitsize, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
 								uint16_t tx_size, uint8_t* tx_buffer, struct _eth_desc* tx_desc,
 								ethd_callback_t *tx_callbacks);
 
+/**
+ * \brief Get the statistics of the MAC and the driver counters of each
+ * queue. The hardware counters are cleared on read, they are accumulated by
+ * the driver: this function should be called often enough for them not to
+ * wrap around.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param stats Statistics.
+ */
+extern void ethd_get_stats(struct _ethd* ethd, struct _eth_stats* stats);
+
+/**
+ * \brief Reset the MAC statistics and the driver counters.
+ *  \param ethd Pointer to ETH Driver instance.
+ */
+extern void ethd_reset_stats(struct _ethd* ethd);
+
+/**
+ * \brief Print the non-zero statistics on the console.
+ *  \param ethd Pointer to ETH Driver instance.
+ */
+extern void ethd_dump_stats(struct _ethd* ethd);
+
+/**
+ * \brief Enable/Disable reception of jumbo frames, up to
+ * ETH_MAX_JUMBO_FRAME_LENGTH bytes. Large RX buffers should be used.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param enable Enable jumbo frames.
+ *  \return ETH_OK, or ETH_PARAM if not supported by the MAC.
+ */
+extern uint8_t ethd_enable_jumbo_frames(struct _ethd* ethd, bool enable);
+
 /**
  * \brief Send a frame splitted into buffers. If the frame size is larger than transfer buffer size
  * error returned. If frame transfer status is monitored, specify callback for each frame.
@@ -278,6 +545,29 @@ extern uint8_t ethd_setup_queue(struct _ethd* ethd, uint8_t queue,
  */
 extern uint8_t ethd_send_sg(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_list* sgl, ethd_callback_t callback);
 
+/**
+ * \brief Send a frame splitted into buffers without copying them.
+ * The TX descriptors point directly to the buffers of the scatter-gather
+ * list, so they must remain untouched until the release callback is invoked
+ * with the frame status once the frame has been sent (or dropped on error).
+ * ethd_setup_tx_release() must have been called for the queue.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param sgl Pointer to a scatter-gather list describing the buffers of the ethernet frame.
+ *  \param release Pointer to release callback function.
+ *  \param arg Argument given to the release callback.
+ *  \return OK, Busy, invalid frame or not initialized
+ */
+extern uint8_t ethd_send_sg_zero_copy(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_list* sgl, ethd_tx_release_cb_t release, void* arg);
+
+/**
+ * \brief Register the release callback list of a TX queue, needed by
+ * ethd_send_sg_zero_copy(). Must be called while the TX queue is empty.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param tx_releases Pointer to a list of as many entries as TX descriptors.
+ *  \return ETH_OK, or ETH_TX_BUSY if frames are still being sent.
+ */
+extern uint8_t ethd_setup_tx_release(struct _ethd* ethd, uint8_t queue, struct _eth_tx_release* tx_releases);
+
 extern void ethd_start(struct _ethd* ethd);
 
 /**
@@ -305,8 +595,118 @@ extern uint32_t ethd_get_tx_load(struct _ethd* ethd, uint8_t queue);
  */
 extern uint8_t ethd_poll(struct _ethd* ethd, uint8_t queue, uint8_t* buffer, uint32_t buffer_size, uint32_t* recv_size);
 
+/**
+ * \brief Get the checksums verified by the MAC for the last frame returned
+ * by ethd_poll(). Frames with bad checksums are dropped by the MAC.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \return ETH_RX_CSUM_NONE if ETH_OFFLOAD_RX_CSUM is disabled, or an
+ *          ETH_RX_CSUM_* value.
+ */
+extern uint8_t ethd_get_rx_csum(struct _ethd* ethd, uint8_t queue);
+
+/**
+ * \brief Receive a packet with ETH without copying it.
+ * The RX buffers holding the next received frame are lent to the application
+ * as a scatter-gather list, and are not reused by the hardware until they are
+ * given back with ethd_rx_return(). Loans may be returned in any order.
+ * Before the call, loan->sgl.entries must point to an array of
+ * loan->sgl.size entries; on success loan->sgl.size is updated with the
+ * number of buffers of the frame.
+ * If the array is too small, the frame is dropped and ETH_SIZE_TOO_SMALL
+ * is returned.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param loan         Loan descriptor to fill
+ *  \return             OK, no data, or scatter-gather array too small
+ */
+extern uint8_t ethd_rx_loan(struct _ethd* ethd, uint8_t queue, struct _eth_rx_loan* loan);
+
+/**
+ * \brief Give back to the driver the RX buffers of a frame obtained with
+ * ethd_rx_loan(). Must be called from the same context as ethd_rx_loan() and
+ * ethd_poll(). The buffers may have been modified by the application, their
+ * cache lines are discarded.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param loan         Loan descriptor filled by ethd_rx_loan()
+ */
+extern void ethd_rx_return(struct _ethd* ethd, uint8_t queue, const struct _eth_rx_loan* loan);
+
 extern void ethd_set_rx_callback(struct _ethd *ethd, uint8_t queue, ethd_callback_t callback);
 
+/**
+ * \brief Set the maximum number of frames the application should process
+ * from a queue in one polling round before serving the other queues, so
+ * that bulk traffic cannot starve a higher priority queue.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param budget Number of frames, 0 for no limit (default).
+ */
+extern void ethd_set_rx_budget(struct _ethd* ethd, uint8_t queue, uint16_t budget);
+
+/**
+ * \brief Get the polling budget of a queue, see ethd_set_rx_budget().
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \return Number of frames, 0 for no limit.
+ */
+extern uint16_t ethd_get_rx_budget(struct _ethd* ethd, uint8_t queue);
+
+/**
+ * \brief Enable/Disable RX interrupt coalescing on a queue.
+ * When enabled, the RX interrupt of the queue is masked as soon as it fires
+ * and the RX callback is invoked once. The application then polls the queue,
+ * up to its budget per round (see ethd_set_rx_budget()), and calls
+ * ethd_rx_poll_complete() after each round. The interrupt is unmasked once
+ * the queue is empty and at least holdoff timer ticks have elapsed since it
+ * fired, which bounds the RX interrupt rate under heavy traffic.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param enable Enable coalescing.
+ *  \param holdoff Minimum number of timer ticks between two RX interrupts,
+ *                  0 to unmask as soon as the queue is empty.
+ *  \return ETH_OK, or ETH_PARAM if not supported by the MAC.
+ */
+extern uint8_t ethd_set_rx_coalescing(struct _ethd* ethd, uint8_t queue, bool enable, uint16_t holdoff);
+
+/**
+ * \brief End a polling round of a queue with RX interrupt coalescing.
+ * Does nothing if coalescing is disabled.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \return true if the RX interrupt has been unmasked (or was not masked),
+ *          false if the queue must be polled again.
+ */
+extern bool ethd_rx_poll_complete(struct _ethd* ethd, uint8_t queue);
+
+/**
+ * \brief Get the RX interrupt coalescing counters of a queue. The counters
+ * are updated whether coalescing is enabled or not.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param stats Counters.
+ */
+extern void ethd_get_rx_coalesce_stats(struct _ethd* ethd, uint8_t queue, struct _eth_rx_coalesce_stats* stats);
+
+/**
+ * \brief Reset the RX interrupt coalescing counters of a queue.
+ *  \param ethd Pointer to ETH Driver instance.
+ */
+extern void ethd_reset_rx_coalesce_stats(struct _ethd* ethd, uint8_t queue);
+
+/**
+ * \brief Install a RX screening rule. Received frames matching the rule
+ * are stored in the given queue instead of queue 0. Rules are evaluated by
+ * the MAC, the queue must have been set up with ethd_setup_queue(). The
+ * board ETH setup only sets up the priority queues of the GMAC when the
+ * application is built with CONFIG_GMAC_PRIO_QUEUES = y.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param screener Rule to install.
+ *  \return ETH_OK, ETH_PARAM if the rule is invalid or not supported by the
+ *          MAC, or ETH_NO_RESOURCE if no screening register is free.
+ */
+extern uint8_t ethd_add_screener(struct _ethd* ethd, const struct _eth_screener* screener);
+
+/**
+ * \brief Remove all the RX screening rules, all frames are received in
+ * queue 0.
+ *  \param ethd Pointer to ETH Driver instance.
+ */
+extern void ethd_clear_screeners(struct _ethd* ethd);
+
 /**
  * Register/Clear TX wakeup callback.
  *
@@ -327,6 +727,57 @@ extern void ethd_set_rx_callback(struct _ethd *ethd, uint8_t queue, ethd_callbac
  */
 extern uint8_t ethd_set_tx_wakeup_callback(struct _ethd* ethd, uint8_t queue, ethd_wakeup_cb_t callback, uint16_t threshold);
 
+/**
+ * \brief Read the IEEE 1588 timer. ETH_OFFLOAD_PTP must be enabled.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param ts Timer value.
+ *  \return ETH_OK, or ETH_PARAM if PTP is not enabled.
+ */
+extern uint8_t ethd_ptp_get_time(struct _ethd* ethd, struct _eth_timestamp* ts);
+
+/**
+ * \brief Set the IEEE 1588 timer.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param ts New timer value.
+ *  \return ETH_OK, or ETH_PARAM if PTP is not enabled.
+ */
+extern uint8_t ethd_ptp_set_time(struct _ethd* ethd, const struct _eth_timestamp* ts);
+
+/**
+ * \brief Step the IEEE 1588 timer forward or backward.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param nsec Signed offset in nanoseconds.
+ *  \return ETH_OK, or ETH_PARAM if PTP is not enabled.
+ */
+extern uint8_t ethd_ptp_adjust_time(struct _ethd* ethd, int32_t nsec);
+
+/**
+ * \brief Trim the frequency of the IEEE 1588 timer.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param ppb Frequency offset from the nominal rate, in parts per billion.
+ *  \return ETH_OK, or ETH_PARAM if PTP is not enabled.
+ */
+extern uint8_t ethd_ptp_adjust_freq(struct _ethd* ethd, int32_t ppb);
+
+/**
+ * \brief Get the timestamp of the last PTP event frame of the given kind,
+ * latched by the MAC when the frame went through the MII.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param event Kind of event frame (ETH_PTP_*).
+ *  \param ts Timestamp of the frame.
+ *  \return ETH_OK, ETH_RX_NULL if no such frame was seen since the last
+ *          call, or ETH_PARAM if PTP is not enabled.
+ */
+extern uint8_t ethd_ptp_get_event(struct _ethd* ethd, uint8_t event, struct _eth_timestamp* ts);
+
+/**
+ * \brief Register a callback invoked, from interrupt context, with the
+ * timestamp of each PTP event frame. NULL to unregister.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param callback PTP event callback.
+ */
+extern void ethd_ptp_set_callback(struct _ethd* ethd, ethd_ptp_callback_t callback);
+
 /** @}*/
 
 #ifdef __cplusplus
@@ -150,6 +150,9 @@ bool gmac_configure(Gmac* gmac)
 	gmac_set_network_control_register(gmac, 0);
 	gmac_set_network_config_register(gmac, GMAC_NCFGR_DBW_DBW32);
 
+	/* Disable checksum offload */
+	gmac_enable_tx_checksum_offload(gmac, false);
+
 	/* Disable interrupts */
 	gmac_disable_it(gmac, 0, ~0u);
 #ifdef CONFIG_HAVE_GMAC_QUEUES
@@ -160,6 +163,11 @@ bool gmac_configure(Gmac* gmac)
 	/* Clear statistics */
 	gmac_clear_statistics(gmac);
 
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+	/* All frames go to queue 0 */
+	gmac_clear_screeners(gmac);
+#endif
+
 	/* Clear all status bits in the receive status register. */
 	gmac_clear_rx_status(gmac, GMAC_RSR_RXOVR | GMAC_RSR_REC |
 			GMAC_RSR_BNA | GMAC_RSR_HNO);
@@ -303,6 +311,97 @@ void gmac_set_link_speed(Gmac* gmac, enum _eth_speed speed, enum _eth_duplex dup
 	gmac->GMAC_NCR |= (GMAC_NCR_RXEN | GMAC_NCR_TXEN);
 }
 
+void gmac_enable_rx_checksum_offload(Gmac* gmac, bool enable)
+{
+	if (enable)
+		gmac->GMAC_NCFGR |= GMAC_NCFGR_RXCOEN;
+	else
+		gmac->GMAC_NCFGR &= ~GMAC_NCFGR_RXCOEN;
+}
+
+void gmac_enable_tx_checksum_offload(Gmac* gmac, bool enable)
+{
+#ifdef GMAC_DCFGR_TXCOEN
+	if (enable)
+		gmac->GMAC_DCFGR |= GMAC_DCFGR_TXCOEN;
+	else
+		gmac->GMAC_DCFGR &= ~GMAC_DCFGR_TXCOEN;
+#endif
+}
+
+void gmac_set_tsu_increment(Gmac* gmac, uint32_t incr)
+{
+	uint32_t ns = incr >> 16;
+	uint32_t frac = incr & 0xffff;
+
+#ifdef GMAC_TISUBN_LSBTIR_Pos
+	gmac->GMAC_TISUBN = GMAC_TISUBN_LSBTIR(frac);
+	gmac->GMAC_TI = GMAC_TI_CNS(ns);
+#else
+	/* No sub-nanosecond increment, one increment out of NIT is
+	 * (ns + 1) instead of ns */
+	uint32_t nit = frac ? (0x10000 + frac / 2) / frac : 0;
+	if (nit >= 2 && nit <= 255)
+		gmac->GMAC_TI = GMAC_TI_CNS(ns) | GMAC_TI_ACNS(ns + 1) | GMAC_TI_NIT(nit);
+	else if (nit == 1)
+		gmac->GMAC_TI = GMAC_TI_CNS(ns + 1);
+	else
+		gmac->GMAC_TI = GMAC_TI_CNS(ns);
+#endif
+}
+
+void gmac_get_tsu_time(Gmac* gmac, uint32_t* sec, uint32_t* nsec)
+{
+	uint32_t s;
+
+	/* Read again if the seconds changed while reading the nanoseconds */
+	do {
+		s = gmac->GMAC_TSL;
+		*nsec = gmac->GMAC_TN & GMAC_TN_TNS_Msk;
+		*sec = gmac->GMAC_TSL;
+	} while (*sec != s);
+}
+
+void gmac_set_tsu_time(Gmac* gmac, uint32_t sec, uint32_t nsec)
+{
+#ifdef GMAC_TSH_TCS_Pos
+	gmac->GMAC_TSH = 0;
+#endif
+	gmac->GMAC_TSL = sec;
+	gmac->GMAC_TN = GMAC_TN_TNS(nsec);
+}
+
+void gmac_adjust_tsu_time(Gmac* gmac, int32_t nsec)
+{
+	if (nsec < 0)
+		gmac->GMAC_TA = GMAC_TA_ADJ | GMAC_TA_ITDT(-nsec);
+	else
+		gmac->GMAC_TA = GMAC_TA_ITDT(nsec);
+}
+
+void gmac_get_ptp_event_time(Gmac* gmac, enum _gmac_ptp_event_reg reg,
+		uint32_t* sec, uint32_t* nsec)
+{
+	switch (reg) {
+	case GMAC_PTP_EVENT_RX:
+		*sec = gmac->GMAC_EFRSL;
+		*nsec = gmac->GMAC_EFRN & GMAC_EFRN_RUD_Msk;
+		break;
+	case GMAC_PTP_EVENT_TX:
+		*sec = gmac->GMAC_EFTSL;
+		*nsec = gmac->GMAC_EFTN & GMAC_EFTN_RUD_Msk;
+		break;
+	case GMAC_PTP_PEER_EVENT_RX:
+		*sec = gmac->GMAC_PEFRSL;
+		*nsec = gmac->GMAC_PEFRN & GMAC_PEFRN_RUD_Msk;
+		break;
+	case GMAC_PTP_PEER_EVENT_TX:
+		*sec = gmac->GMAC_PEFTSL;
+		*nsec = gmac->GMAC_PEFTN & GMAC_PEFTN_RUD_Msk;
+		break;
+	}
+}
+
 void gmac_enable_local_loopback(Gmac* gmac)
 {
 	gmac->GMAC_NCR |= GMAC_NCR_LBL;
@@ -380,6 +479,32 @@ struct _eth_desc* gmac_get_rx_desc(Gmac* gmac, uint8_t queue)
 	}
 }
 
+void gmac_set_rx_buffer_size(Gmac* gmac, uint8_t queue, uint32_t size)
+{
+	uint32_t units = size / GMAC_RX_UNITSIZE_ALIGN;
+
+	if (queue == 0) {
+		gmac->GMAC_DCFGR = (gmac->GMAC_DCFGR & ~GMAC_DCFGR_DRBS_Msk) |
+			GMAC_DCFGR_DRBS(units);
+	}
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+	else if (queue < GMAC_NUM_QUEUES) {
+		gmac->GMAC_RBSRPQ[queue - 1] = GMAC_RBSRPQ_RBS(units);
+	}
+#endif
+	else {
+		trace_debug("Invalid queue number %d\r\n", queue);
+	}
+}
+
+void gmac_enable_jumbo_frames(Gmac* gmac, bool enable)
+{
+	if (enable)
+		gmac->GMAC_NCFGR |= GMAC_NCFGR_JFRAME;
+	else
+		gmac->GMAC_NCFGR &= ~GMAC_NCFGR_JFRAME;
+}
+
 void gmac_set_tx_desc(Gmac* gmac, uint8_t queue, struct _eth_desc* desc)
 {
 	if (queue == 0) {
@@ -502,6 +627,43 @@ void gmac_increase_statistics(Gmac* gmac)
 	gmac->GMAC_NCR |= GMAC_NCR_INCSTAT;
 }
 
+void gmac_read_statistics(Gmac* gmac, struct _eth_mac_stats* stats)
+{
+	uint64_t octets;
+
+	/* Octet counters are 48-bit wide */
+	octets = gmac->GMAC_OTLO;
+	octets |= (uint64_t)(gmac->GMAC_OTHI & GMAC_OTHI_TXO_Msk) << 32;
+	stats->tx_octets += octets;
+	stats->tx_frames += gmac->GMAC_FT;
+	stats->tx_broadcast += gmac->GMAC_BCFT;
+	stats->tx_multicast += gmac->GMAC_MFT;
+	stats->tx_underruns += gmac->GMAC_TUR;
+	stats->tx_collisions += gmac->GMAC_SCF + gmac->GMAC_MCF;
+	stats->tx_excessive_collisions += gmac->GMAC_EC;
+	stats->tx_late_collisions += gmac->GMAC_LC;
+	stats->tx_carrier_errors += gmac->GMAC_CSE;
+
+	octets = gmac->GMAC_ORLO;
+	octets |= (uint64_t)(gmac->GMAC_ORHI & GMAC_ORHI_RXO_Msk) << 32;
+	stats->rx_octets += octets;
+	stats->rx_frames += gmac->GMAC_FR;
+	stats->rx_broadcast += gmac->GMAC_BCFR;
+	stats->rx_multicast += gmac->GMAC_MFR;
+	stats->rx_fcs_errors += gmac->GMAC_FCSE;
+	stats->rx_alignment_errors += gmac->GMAC_AE;
+	stats->rx_length_errors += gmac->GMAC_LFFE;
+	stats->rx_undersize += gmac->GMAC_UFR;
+	stats->rx_oversize += gmac->GMAC_OFR;
+	stats->rx_jabbers += gmac->GMAC_JR;
+	stats->rx_symbol_errors += gmac->GMAC_RSE;
+	stats->rx_resource_errors += gmac->GMAC_RRE;
+	stats->rx_overruns += gmac->GMAC_ROE;
+	stats->rx_ip_csum_errors += gmac->GMAC_IHCE;
+	stats->rx_tcp_csum_errors += gmac->GMAC_TCE;
+	stats->rx_udp_csum_errors += gmac->GMAC_UCE;
+}
+
 void gmac_enable_statistics_write(Gmac* gmac, bool enable)
 {
 	if (enable)
@@ -519,3 +681,63 @@ void gmac_halt_transmission(Gmac * gmac)
 {
 	gmac->GMAC_NCR |= GMAC_NCR_THALT;
 }
+
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+
+void gmac_set_st1_screener(Gmac* gmac, uint8_t index, uint32_t st1rpq)
+{
+	gmac->GMAC_ST1RPQ[index] = st1rpq;
+}
+
+uint32_t gmac_get_st1_screener(Gmac* gmac, uint8_t index)
+{
+	return gmac->GMAC_ST1RPQ[index];
+}
+
+void gmac_set_st2_screener(Gmac* gmac, uint8_t index, uint32_t st2rpq)
+{
+	gmac->GMAC_ST2RPQ[index] = st2rpq;
+}
+
+uint32_t gmac_get_st2_screener(Gmac* gmac, uint8_t index)
+{
+	return gmac->GMAC_ST2RPQ[index];
+}
+
+void gmac_set_st2_ethertype(Gmac* gmac, uint8_t index, uint16_t ethertype)
+{
+	gmac->GMAC_ST2ER[index] = GMAC_ST2ER_COMPVAL(ethertype);
+}
+
+uint16_t gmac_get_st2_ethertype(Gmac* gmac, uint8_t index)
+{
+	return (gmac->GMAC_ST2ER[index] & GMAC_ST2ER_COMPVAL_Msk) >> GMAC_ST2ER_COMPVAL_Pos;
+}
+
+void gmac_set_st2_compare(Gmac* gmac, uint8_t index, uint32_t cw0, uint32_t cw1)
+{
+	gmac->GMAC_ST2CW[index].GMAC_ST2CW0 = cw0;
+	gmac->GMAC_ST2CW[index].GMAC_ST2CW1 = cw1;
+}
+
+void gmac_get_st2_compare(Gmac* gmac, uint8_t index, uint32_t* cw0, uint32_t* cw1)
+{
+	*cw0 = gmac->GMAC_ST2CW[index].GMAC_ST2CW0;
+	*cw1 = gmac->GMAC_ST2CW[index].GMAC_ST2CW1;
+}
+
+void gmac_clear_screeners(Gmac* gmac)
+{
+	int i;
+
+	for (i = 0; i < GMAC_NUM_ST1_SCREENERS; i++)
+		gmac_set_st1_screener(gmac, i, 0);
+	for (i = 0; i < GMAC_NUM_ST2_SCREENERS; i++)
+		gmac_set_st2_screener(gmac, i, 0);
+	for (i = 0; i < GMAC_NUM_ST2_ETHERTYPES; i++)
+		gmac_set_st2_ethertype(gmac, i, 0);
+	for (i = 0; i < GMAC_NUM_ST2_COMPARES; i++)
+		gmac_set_st2_compare(gmac, i, 0, 0);
+}
+
+#endif /* CONFIG_HAVE_GMAC_QUEUES */
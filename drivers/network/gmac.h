@@ -91,12 +91,20 @@
 
 #ifdef CONFIG_HAVE_GMAC_QUEUES
 #define GMAC_NUM_QUEUES 3
+#define GMAC_NUM_ST1_SCREENERS 4
+#define GMAC_NUM_ST2_SCREENERS 8
+#define GMAC_NUM_ST2_ETHERTYPES 4
+#define GMAC_NUM_ST2_COMPARES 24
 #else
 #define GMAC_NUM_QUEUES 1
 #endif
 
 #define GMAC_MAX_JUMBO_FRAME_LENGTH 10240
 
+/* RX buffer sizes are programmed in units of 64 bytes */
+#define GMAC_RX_UNITSIZE_ALIGN 64
+#define GMAC_RX_UNITSIZE_MAX   (0xff * GMAC_RX_UNITSIZE_ALIGN)
+
 /**@}*/
 
 /*----------------------------------------------------------------------------
@@ -106,6 +114,14 @@
 /** \addtogroup gmac_structs
 	@{*/
 
+/** 1588 timer values latched by PTP event frames */
+enum _gmac_ptp_event_reg {
+	GMAC_PTP_EVENT_RX,      /**< Sync or Delay_Req received */
+	GMAC_PTP_EVENT_TX,      /**< Sync or Delay_Req sent */
+	GMAC_PTP_PEER_EVENT_RX, /**< Pdelay_Req or Pdelay_Resp received */
+	GMAC_PTP_PEER_EVENT_TX, /**< Pdelay_Req or Pdelay_Resp sent */
+};
+
 /**     @}*/
 
 /*----------------------------------------------------------------------------
@@ -190,6 +206,55 @@ extern void gmac_enable_rmii(Gmac* gmac, enum _eth_speed speed,
 extern void gmac_set_link_speed(Gmac* gmac, enum _eth_speed speed,
 		enum _eth_duplex duplex);
 
+/**
+ *  \brief Enable/Disable verification of the IP/TCP/UDP checksums of the
+ *  received frames. Frames with bad checksums are discarded.
+ *  \param gmac Pointer to an Gmac instance.
+ */
+extern void gmac_enable_rx_checksum_offload(Gmac* gmac, bool enable);
+
+/**
+ *  \brief Enable/Disable generation of the IP/TCP/UDP checksums of the
+ *  sent frames.
+ *  \param gmac Pointer to an Gmac instance.
+ */
+extern void gmac_enable_tx_checksum_offload(Gmac* gmac, bool enable);
+
+/**
+ *  \brief Set the increment of the 1588 timer, added at each peripheral
+ *  clock cycle.
+ *  \param gmac Pointer to an Gmac instance.
+ *  \param incr Increment in 1/65536 ns.
+ */
+extern void gmac_set_tsu_increment(Gmac* gmac, uint32_t incr);
+
+/**
+ *  \brief Read the 1588 timer.
+ *  \param gmac Pointer to an Gmac instance.
+ */
+extern void gmac_get_tsu_time(Gmac* gmac, uint32_t* sec, uint32_t* nsec);
+
+/**
+ *  \brief Set the 1588 timer.
+ *  \param gmac Pointer to an Gmac instance.
+ */
+extern void gmac_set_tsu_time(Gmac* gmac, uint32_t sec, uint32_t nsec);
+
+/**
+ *  \brief Add a signed offset to the 1588 timer.
+ *  \param gmac Pointer to an Gmac instance.
+ *  \param nsec Offset in nanoseconds, less than 2^30 in absolute value.
+ */
+extern void gmac_adjust_tsu_time(Gmac* gmac, int32_t nsec);
+
+/**
+ *  \brief Read the 1588 timer value latched by the last PTP event frame of
+ *  the given kind.
+ *  \param gmac Pointer to an Gmac instance.
+ */
+extern void gmac_get_ptp_event_time(Gmac* gmac, enum _gmac_ptp_event_reg reg,
+		uint32_t* sec, uint32_t* nsec);
+
 /**
  *  \brief Enable local loop back
  *  \param gmac Pointer to an Gmac instance.
@@ -242,6 +307,20 @@ void gmac_set_rx_desc(Gmac* gmac, uint8_t queue, struct _eth_desc* desc);
  */
 struct _eth_desc* gmac_get_rx_desc(Gmac* gmac, uint8_t queue);
 
+/**
+ *  \brief Set the size of the RX buffers of a queue.
+ *  \param size Size in bytes, multiple of GMAC_RX_UNITSIZE_ALIGN, up to
+ *  GMAC_RX_UNITSIZE_MAX.
+ */
+void gmac_set_rx_buffer_size(Gmac* gmac, uint8_t queue, uint32_t size);
+
+/**
+ *  \brief Enable/Disable reception of jumbo frames, up to
+ *  GMAC_MAX_JUMBO_FRAME_LENGTH bytes.
+ *  \param gmac Pointer to an Gmac instance.
+ */
+void gmac_enable_jumbo_frames(Gmac* gmac, bool enable);
+
 /**
  *  \brief Set TX descriptor address
  */
@@ -297,6 +376,12 @@ extern void gmac_increase_statistics(Gmac* gmac);
  */
 extern void gmac_enable_statistics_write(Gmac* gmac, bool enable);
 
+/**
+ *  \brief Read the statistics registers, which are cleared on read, and add
+ *  them to the given counters.
+ */
+extern void gmac_read_statistics(Gmac* gmac, struct _eth_mac_stats* stats);
+
 /**
  *  \brief Start transmission
  */
@@ -307,6 +392,56 @@ extern void gmac_start_transmission(Gmac* gmac);
  */
 extern void gmac_halt_transmission(Gmac* gmac);
 
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+
+/**
+ *  \brief Set a Screening Type 1 register (DS/TC field and UDP port)
+ */
+extern void gmac_set_st1_screener(Gmac* gmac, uint8_t index, uint32_t st1rpq);
+
+/**
+ *  \brief Get a Screening Type 1 register
+ */
+extern uint32_t gmac_get_st1_screener(Gmac* gmac, uint8_t index);
+
+/**
+ *  \brief Set a Screening Type 2 register (VLAN priority, EtherType and
+ *  compare words)
+ */
+extern void gmac_set_st2_screener(Gmac* gmac, uint8_t index, uint32_t st2rpq);
+
+/**
+ *  \brief Get a Screening Type 2 register
+ */
+extern uint32_t gmac_get_st2_screener(Gmac* gmac, uint8_t index);
+
+/**
+ *  \brief Set a Screening Type 2 EtherType register
+ */
+extern void gmac_set_st2_ethertype(Gmac* gmac, uint8_t index, uint16_t ethertype);
+
+/**
+ *  \brief Get a Screening Type 2 EtherType register
+ */
+extern uint16_t gmac_get_st2_ethertype(Gmac* gmac, uint8_t index);
+
+/**
+ *  \brief Set a Screening Type 2 Compare Word 0/Word 1 register pair
+ */
+extern void gmac_set_st2_compare(Gmac* gmac, uint8_t index, uint32_t cw0, uint32_t cw1);
+
+/**
+ *  \brief Get a Screening Type 2 Compare Word 0/Word 1 register pair
+ */
+extern void gmac_get_st2_compare(Gmac* gmac, uint8_t index, uint32_t* cw0, uint32_t* cw1);
+
+/**
+ *  \brief Disable all screeners, all frames are received in queue 0
+ */
+extern void gmac_clear_screeners(Gmac* gmac);
+
+#endif /* CONFIG_HAVE_GMAC_QUEUES */
+
 #ifdef __cplusplus
 }
 #endif
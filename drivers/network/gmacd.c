@@ -57,6 +57,38 @@
 #define GMAC_INT_TX_ERR_BITS (GMAC_IER_TUR | GMAC_IER_RLEX | GMAC_IER_TFC)
 #define GMAC_INT_TX_BITS     (GMAC_INT_TX_ERR_BITS | GMAC_IER_TCOMP)
 
+/* for compatibility with some devices that cannot generate checksums */
+#ifdef GMAC_DCFGR_TXCOEN
+#define GMAC_OFFLOAD_TX_CSUM ETH_OFFLOAD_TX_CSUM
+#else
+#define GMAC_OFFLOAD_TX_CSUM 0
+#endif
+#define GMAC_INT_PTP_BITS    (GMAC_IER_SFR | GMAC_IER_SFT |\
+		GMAC_IER_DRQFR | GMAC_IER_DRQFT |\
+		GMAC_IER_PDRQFR | GMAC_IER_PDRQFT |\
+		GMAC_IER_PDRSFR | GMAC_IER_PDRSFT)
+
+/* Maximum offset applied with the 1588 Timer Adjust Register */
+#define GMAC_TA_MAX_NSEC     ((int32_t)GMAC_TA_ITDT_Msk)
+
+#define NSEC_PER_SEC         1000000000
+
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+
+#define ETH_TYPE_IPV4        0x0800
+#define IP_PROTO_TCP         6
+#define IP_PROTO_UDP         17
+
+/* Screening type 2 enable bits, a register without them is free */
+#define GMAC_ST2RPQ_ENABLE_BITS (GMAC_ST2RPQ_VLANE | GMAC_ST2RPQ_ETHE |\
+		GMAC_ST2RPQ_COMPAE | GMAC_ST2RPQ_COMPBE | GMAC_ST2RPQ_COMPCE)
+
+/* Screening type 2 compare words match 16 bits of the frame, the first byte
+ * being compared with the low byte of the compare and mask values. */
+#define GMAC_ST2_BYTES(first, second) ((first) | ((second) << 8))
+
+#endif /* CONFIG_HAVE_GMAC_QUEUES */
+
 /*---------------------------------------------------------------------------
  *         Types
  *---------------------------------------------------------------------------*/
@@ -68,6 +100,12 @@ struct _gmacd_irq_handler {
 	uint32_t      irq;
 };
 
+struct _gmacd_ptp_event {
+	uint32_t                 it;
+	uint8_t                  event;
+	enum _gmac_ptp_event_reg reg;
+};
+
 /*---------------------------------------------------------------------------
  *         IRQ Handlers
  *---------------------------------------------------------------------------*/
@@ -97,6 +135,18 @@ static struct _gmacd_irq_handler _gmacd_irq_handlers[] = {
 #endif
 };
 
+/* PTP event frames, with the 1588 timer registers latched by them */
+static const struct _gmacd_ptp_event _gmacd_ptp_events[] = {
+	{ GMAC_IER_SFR,    ETH_PTP_SYNC_RX,        GMAC_PTP_EVENT_RX },
+	{ GMAC_IER_SFT,    ETH_PTP_SYNC_TX,        GMAC_PTP_EVENT_TX },
+	{ GMAC_IER_DRQFR,  ETH_PTP_DELAY_REQ_RX,   GMAC_PTP_EVENT_RX },
+	{ GMAC_IER_DRQFT,  ETH_PTP_DELAY_REQ_TX,   GMAC_PTP_EVENT_TX },
+	{ GMAC_IER_PDRQFR, ETH_PTP_PDELAY_REQ_RX,  GMAC_PTP_PEER_EVENT_RX },
+	{ GMAC_IER_PDRQFT, ETH_PTP_PDELAY_REQ_TX,  GMAC_PTP_PEER_EVENT_TX },
+	{ GMAC_IER_PDRSFR, ETH_PTP_PDELAY_RESP_RX, GMAC_PTP_PEER_EVENT_RX },
+	{ GMAC_IER_PDRSFT, ETH_PTP_PDELAY_RESP_TX, GMAC_PTP_PEER_EVENT_TX },
+};
+
 /*---------------------------------------------------------------------------
  *         Dummy Buffers for unconfigured queues
  *---------------------------------------------------------------------------*/
@@ -161,12 +211,14 @@ static void _gmacd_reset_rx(struct _ethd* gmacd, uint8_t queue)
 	gmac_receive_enable(gmacd->gmac, false);
 
 	/* Setup the RX descriptors */
-	q->rx_head = 0;
+	RING_CLEAR(q->rx_head, q->rx_tail);
+	q->rx_held = 0;
+	q->rx_csum = ETH_RX_CSUM_NONE;
 	for (i = 0; i < q->rx_size; i++) {
 		q->rx_desc[i].addr = addr & ETH_RX_ADDR_MASK;
 		dsb();
 		q->rx_desc[i].status = 0;
-		addr += ETH_RX_UNITSIZE;
+		addr += q->rx_unitsize;
 	}
 	q->rx_desc[q->rx_size - 1].addr |= ETH_RX_ADDR_WRAP;
 
@@ -184,6 +236,7 @@ static void _gmacd_tx_complete_handler(struct _ethd* gmacd, uint8_t queue)
 	struct _ethd_queue* q = &gmacd->queues[queue];
 	struct _eth_desc *desc;
 	ethd_callback_t callback;
+	struct _eth_tx_release* release;
 	uint32_t tsr;
 
 	//printf("<TX>\r\n");
@@ -217,6 +270,15 @@ static void _gmacd_tx_complete_handler(struct _ethd* gmacd, uint8_t queue)
 				callback(queue, tsr);
 		}
 
+		/* Give back the buffers of a frame sent without copy */
+		if (q->tx_releases) {
+			release = &q->tx_releases[q->tx_tail];
+			if (release->callback) {
+				release->callback(queue, tsr, release->arg);
+				release->callback = NULL;
+			}
+		}
+
 		/* Go to next frame */
 		RING_INC(q->tx_tail, q->tx_size);
 	}
@@ -241,6 +303,7 @@ static void _gmacd_tx_error_handler(struct _ethd* gmacd, uint8_t queue)
 	struct _ethd_queue* q = &gmacd->queues[queue];
 	struct _eth_desc* desc;
 	ethd_callback_t callback;
+	struct _eth_tx_release* release;
 	uint32_t tsr;
 
 	printf("<TXERR>\r\n");
@@ -277,6 +340,8 @@ static void _gmacd_tx_error_handler(struct _ethd* gmacd, uint8_t queue)
 		 */
 		if (desc->status & ETH_TX_STATUS_USED)
 			tx_completed = 1;
+		else
+			q->stats.tx_errors++;
 
 		/* Go to the last buffer descriptor of the frame */
 		while ((desc->status & ETH_TX_STATUS_LASTBUF) == 0) {
@@ -292,6 +357,15 @@ static void _gmacd_tx_error_handler(struct _ethd* gmacd, uint8_t queue)
 				callback(queue, tx_completed ? GMAC_TSR_TXCOMP : 0);
 		}
 
+		/* Give back the buffers of a frame sent without copy */
+		if (q->tx_releases) {
+			release = &q->tx_releases[q->tx_tail];
+			if (release->callback) {
+				release->callback(queue, tx_completed ? GMAC_TSR_TXCOMP : 0, release->arg);
+				release->callback = NULL;
+			}
+		}
+
 		/* Go to next frame */
 		RING_INC(q->tx_tail, q->tx_size);
 	}
@@ -309,6 +383,42 @@ static void _gmacd_tx_error_handler(struct _ethd* gmacd, uint8_t queue)
 		q->tx_wakeup_callback(queue);
 }
 
+/**
+ *  \brief Save the timestamps of the PTP event frames and invoke the PTP
+ *  callback.
+ *  \param gmacd Pointer to GMAC Driver instance.
+ *  \param isr Interrupt status.
+ */
+static void _gmacd_ptp_handler(struct _ethd* gmacd, uint32_t isr)
+{
+	struct _eth_timestamp* ts;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(_gmacd_ptp_events); i++) {
+		const struct _gmacd_ptp_event* ev = &_gmacd_ptp_events[i];
+		if (!(isr & ev->it))
+			continue;
+		ts = &gmacd->ptp_events[ev->event];
+		gmac_get_ptp_event_time(gmacd->gmac, ev->reg, &ts->sec, &ts->nsec);
+		dmb();
+		gmacd->ptp_pending[ev->event] = 1;
+		if (gmacd->ptp_callback)
+			gmacd->ptp_callback(ev->event, ts);
+	}
+}
+
+/**
+ *  \brief Get the nominal 1588 timer increment, for a timer counting
+ *  nanoseconds at the peripheral clock rate.
+ *  \param gmacd Pointer to GMAC Driver instance.
+ *  \return Increment in 1/65536 ns.
+ */
+static uint32_t _gmacd_ptp_nominal_increment(struct _ethd* gmacd)
+{
+	uint32_t clock = pmc_get_peripheral_clock(get_gmac_id_from_addr(gmacd->gmac));
+	return (uint32_t)(((uint64_t)NSEC_PER_SEC << 16) / clock);
+}
+
 /**
  *  \brief GMAC Interrupt handler
  *  \param gmacd Pointer to GMAC Driver instance.
@@ -328,9 +438,23 @@ static void _gmacd_handler(struct _ethd * gmacd, uint8_t queue)
 			rsr = gmac_get_rx_status(gmac);
 			gmac_clear_rx_status(gmac, rsr);
 
-			/* Invoke callback */
-			if (q->rx_callback)
-				q->rx_callback(queue, rsr);
+			/* Ignore RX events while the queue is being polled */
+			if (!q->rx_polling) {
+				q->rx_stats.interrupts++;
+
+				/* Mask RX interrupts until the queue is drained */
+				if (q->rx_coalesce) {
+					gmac_disable_it(gmacd->gmac, queue, GMAC_INT_RX_BITS);
+					q->rx_polling = true;
+					if (q->rx_holdoff)
+						timer_start_timeout(&q->rx_holdoff_timeout,
+								q->rx_holdoff);
+				}
+
+				/* Invoke callback */
+				if (q->rx_callback)
+					q->rx_callback(queue, rsr);
+			}
 		}
 
 		/* TX error */
@@ -348,6 +472,11 @@ static void _gmacd_handler(struct _ethd * gmacd, uint8_t queue)
 		if (isr & GMAC_IER_HRESP) {
 			trace_error("HRESP not OK\n\r");
 		}
+
+		/* PTP event frame, only reported on queue 0 */
+		if ((isr & GMAC_INT_PTP_BITS) && (gmacd->offload & ETH_OFFLOAD_PTP)) {
+			_gmacd_ptp_handler(gmacd, isr);
+		}
 	}
 }
 
@@ -376,6 +505,9 @@ void gmacd_configure(struct _ethd * gmacd,
 
 	/* Initialize struct */
 	gmacd->gmac = gmac;
+	gmacd->offload_caps = ETH_OFFLOAD_RX_CSUM | GMAC_OFFLOAD_TX_CSUM |
+		ETH_OFFLOAD_PTP;
+	gmacd->offload = 0;
 
 	gmac_configure(gmac);
 
@@ -404,7 +536,7 @@ void gmacd_configure(struct _ethd * gmacd,
 
 	for (i = 0; i < GMAC_NUM_QUEUES; i++) {
 		gmacd_setup_queue(gmacd, i,
-				DUMMY_BUFFERS, dummy_buffer, dummy_rx_desc,
+				DUMMY_BUFFERS, DUMMY_UNITSIZE, dummy_buffer, dummy_rx_desc,
 				DUMMY_BUFFERS, dummy_buffer, dummy_tx_desc,
 				NULL);
 	}
@@ -416,9 +548,12 @@ void gmacd_configure(struct _ethd * gmacd,
  * \param gmacd Pointer to GMAC Driver instance.
  * \param rx_buffer Pointer to allocated buffer for RX. The address should
  *                  be 8-byte aligned and the size should be
- *                  ETH_RX_UNITSIZE * wRxSize.
+ *                  rx_unitsize * wRxSize.
  * \param rx_desc      Pointer to allocated RX descriptor list.
  * \param wRxSize   RX size, in number of registered units (RX descriptors).
+ * \param rx_unitsize Size of each RX buffer, multiple of
+ *                  GMAC_RX_UNITSIZE_ALIGN from ETH_RX_UNITSIZE up to
+ *                  GMAC_RX_UNITSIZE_MAX.
  * \param tx_buffer Pointer to allocated buffer for TX. The address should
  *                  be 8-byte aligned and the size should be
  *                  ETH_TX_UNITSIZE * wTxSize.
@@ -430,7 +565,7 @@ void gmacd_configure(struct _ethd * gmacd,
  *       adjusted and the list size is reduced by one.
  */
 uint8_t gmacd_setup_queue(struct _ethd* gmacd, uint8_t queue,
-		uint16_t rx_size, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
+		uint16_t rx_size, uint16_t rx_unitsize, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
 		uint16_t tx_size, uint8_t* tx_buffer, struct _eth_desc* tx_desc,
 		ethd_callback_t *tx_callbacks)
 {
@@ -439,6 +574,10 @@ uint8_t gmacd_setup_queue(struct _ethd* gmacd, uint8_t queue,
 
 	if (rx_size <= 1 || tx_size <= 1)
 		return ETH_PARAM;
+	if (rx_unitsize < ETH_RX_UNITSIZE ||
+	    rx_unitsize > GMAC_RX_UNITSIZE_MAX ||
+	    (rx_unitsize % GMAC_RX_UNITSIZE_ALIGN) != 0)
+		return ETH_PARAM;
 
 	/* Assign RX buffers */
 	if (((uint32_t)rx_buffer & 0x7)
@@ -449,7 +588,14 @@ uint8_t gmacd_setup_queue(struct _ethd* gmacd, uint8_t queue,
 	q->rx_buffer = (uint8_t*)((uint32_t)rx_buffer & 0xFFFFFFF8);
 	q->rx_desc = (struct _eth_desc *)((uint32_t)rx_desc & 0xFFFFFFF8);
 	q->rx_size = rx_size;
+	q->rx_unitsize = rx_unitsize;
+	q->rx_budget = 0;
 	q->rx_callback = NULL;
+	q->rx_coalesce = false;
+	q->rx_polling = false;
+	q->rx_holdoff = 0;
+	memset(&q->rx_stats, 0, sizeof(q->rx_stats));
+	memset(&q->stats, 0, sizeof(q->stats));
 
 	/* Assign TX buffers */
 	if (((uint32_t)tx_buffer & 0x7)
@@ -461,9 +607,11 @@ uint8_t gmacd_setup_queue(struct _ethd* gmacd, uint8_t queue,
 	q->tx_desc = (struct _eth_desc*)((uint32_t)tx_desc & 0xFFFFFFF8);
 	q->tx_size = tx_size;
 	q->tx_callbacks = tx_callbacks;
+	q->tx_releases = NULL;
 	q->tx_wakeup_callback = NULL;
 
 	/* Reset TX & RX */
+	gmac_set_rx_buffer_size(gmac, queue, rx_unitsize);
 	_gmacd_reset_rx(gmacd, queue);
 	_gmacd_reset_tx(gmacd, queue);
 
@@ -481,6 +629,96 @@ void gmacd_start(struct _ethd * gmacd)
 	gmac_enable_statistics_write(gmacd->gmac, true);
 }
 
+/**
+ * Enable/Disable the checksum offload engines and the PTP timestamping.
+ * \param gmacd Pointer to GMAC Driver instance.
+ * \param offload Mask of ETH_OFFLOAD_* flags to enable.
+ */
+void gmacd_set_offload(struct _ethd* gmacd, uint32_t offload)
+{
+	gmac_enable_rx_checksum_offload(gmacd->gmac,
+			(offload & ETH_OFFLOAD_RX_CSUM) != 0);
+	gmac_enable_tx_checksum_offload(gmacd->gmac,
+			(offload & ETH_OFFLOAD_TX_CSUM) != 0);
+
+	if ((offload & ETH_OFFLOAD_PTP) && !(gmacd->offload & ETH_OFFLOAD_PTP)) {
+		/* Start the 1588 timer at the nominal rate */
+		gmac_set_tsu_increment(gmacd->gmac,
+				_gmacd_ptp_nominal_increment(gmacd));
+		gmac_enable_it(gmacd->gmac, 0, GMAC_INT_PTP_BITS);
+	} else if (!(offload & ETH_OFFLOAD_PTP)) {
+		gmac_disable_it(gmacd->gmac, 0, GMAC_INT_PTP_BITS);
+	}
+}
+
+/**
+ * Read the 1588 timer.
+ * \param gmacd Pointer to GMAC Driver instance.
+ * \param ts Timer value.
+ */
+void gmacd_ptp_get_time(struct _ethd* gmacd, struct _eth_timestamp* ts)
+{
+	gmac_get_tsu_time(gmacd->gmac, &ts->sec, &ts->nsec);
+}
+
+/**
+ * Set the 1588 timer.
+ * \param gmacd Pointer to GMAC Driver instance.
+ * \param ts New timer value.
+ */
+void gmacd_ptp_set_time(struct _ethd* gmacd, const struct _eth_timestamp* ts)
+{
+	gmac_set_tsu_time(gmacd->gmac, ts->sec, ts->nsec);
+}
+
+/**
+ * Step the 1588 timer. Small offsets are applied by the hardware without
+ * stopping the timer, larger ones by reading and setting it.
+ * \param gmacd Pointer to GMAC Driver instance.
+ * \param nsec Signed offset in nanoseconds.
+ */
+void gmacd_ptp_adjust_time(struct _ethd* gmacd, int32_t nsec)
+{
+	struct _eth_timestamp ts;
+	int64_t t;
+
+	if (nsec >= -GMAC_TA_MAX_NSEC && nsec <= GMAC_TA_MAX_NSEC) {
+		gmac_adjust_tsu_time(gmacd->gmac, nsec);
+		return;
+	}
+
+	gmacd_ptp_get_time(gmacd, &ts);
+	t = (int64_t)ts.sec * NSEC_PER_SEC + ts.nsec + nsec;
+	if (t < 0)
+		t = 0;
+	ts.sec = (uint32_t)(t / NSEC_PER_SEC);
+	ts.nsec = (uint32_t)(t % NSEC_PER_SEC);
+	gmacd_ptp_set_time(gmacd, &ts);
+}
+
+/**
+ * Trim the 1588 timer frequency.
+ * \param gmacd Pointer to GMAC Driver instance.
+ * \param ppb Frequency offset from the nominal rate, in parts per billion.
+ */
+void gmacd_ptp_adjust_freq(struct _ethd* gmacd, int32_t ppb)
+{
+	uint64_t incr = _gmacd_ptp_nominal_increment(gmacd);
+
+	incr = incr * (uint64_t)(NSEC_PER_SEC + (int64_t)ppb) / NSEC_PER_SEC;
+	gmac_set_tsu_increment(gmacd->gmac, (uint32_t)incr);
+}
+
+/**
+ * Enable/Disable reception of jumbo frames.
+ * \param gmacd Pointer to GMAC Driver instance.
+ * \param enable Accept frames up to GMAC_MAX_JUMBO_FRAME_LENGTH bytes.
+ */
+void gmacd_enable_jumbo_frames(struct _ethd* gmacd, bool enable)
+{
+	gmac_enable_jumbo_frames(gmacd->gmac, enable);
+}
+
 /**
  * Reset TX & RX queue & statistics
  * \param gmacd Pointer to GMAC Driver instance.
@@ -519,6 +757,240 @@ void gmacd_set_rx_callback(struct _ethd* gmacd, uint8_t queue, ethd_callback_t c
 	}
 }
 
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+
+/**
+ * \brief Find a free screening type 2 compare register and program it.
+ * \param used Mask of the compare registers already in use, updated.
+ * \return Index of the compare register or -1 if none is free.
+ */
+static int _gmacd_add_st2_compare(Gmac* gmac, uint32_t* used,
+		uint32_t offset, uint16_t value, uint16_t mask)
+{
+	int i;
+
+	for (i = 0; i < GMAC_NUM_ST2_COMPARES; i++) {
+		if (!(*used & (1u << i))) {
+			gmac_set_st2_compare(gmac, i,
+					GMAC_ST2CW0_COMPVAL(value) | GMAC_ST2CW0_MASKVAL(mask),
+					offset);
+			*used |= 1u << i;
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * \brief Install a screening type 1 rule, matching the UDP destination port
+ * of IPv4 frames. The DS field compare of these registers covers the whole
+ * byte, ECN bits included, so it is not used.
+ */
+static uint8_t _gmacd_add_st1_screener(struct _ethd* gmacd,
+		const struct _eth_screener* screener)
+{
+	uint32_t st1rpq;
+	int i;
+
+	for (i = 0; i < GMAC_NUM_ST1_SCREENERS; i++) {
+		st1rpq = gmac_get_st1_screener(gmacd->gmac, i);
+		if (st1rpq & (GMAC_ST1RPQ_DSTCE | GMAC_ST1RPQ_UDPE))
+			continue;
+
+		st1rpq = GMAC_ST1RPQ_QNB(screener->queue) |
+			GMAC_ST1RPQ_UDPE | GMAC_ST1RPQ_UDPM(screener->port);
+		gmac_set_st1_screener(gmacd->gmac, i, st1rpq);
+		return ETH_OK;
+	}
+	return ETH_NO_RESOURCE;
+}
+
+/**
+ * \brief Install a screening type 2 rule, matching the VLAN priority, the
+ * EtherType and up to three 16-bit fields of the IPv4 and TCP/UDP headers.
+ */
+static uint8_t _gmacd_add_st2_screener(struct _ethd* gmacd,
+		const struct _eth_screener* screener)
+{
+	Gmac* gmac = gmacd->gmac;
+	uint8_t match = screener->match;
+	uint16_t ethertype = screener->ethertype;
+	uint32_t used = 0;
+	uint32_t st2rpq, enabled;
+	int i, index = -1, et = -1;
+	int cmp[3], num_cmp = 0;
+
+	/* IP fields are only at the expected offsets in IPv4 frames */
+	if (match & (ETH_SCREENER_DSCP | ETH_SCREENER_UDP_PORT | ETH_SCREENER_TCP_PORT)) {
+		if ((match & ETH_SCREENER_ETHERTYPE) && ethertype != ETH_TYPE_IPV4)
+			return ETH_PARAM;
+		match |= ETH_SCREENER_ETHERTYPE;
+		ethertype = ETH_TYPE_IPV4;
+	}
+
+	/* Find a free screener and the EtherType/compare registers in use */
+	for (i = 0; i < GMAC_NUM_ST2_SCREENERS; i++) {
+		st2rpq = gmac_get_st2_screener(gmac, i);
+		enabled = st2rpq & GMAC_ST2RPQ_ENABLE_BITS;
+		if (!enabled) {
+			if (index < 0)
+				index = i;
+			continue;
+		}
+		if ((st2rpq & GMAC_ST2RPQ_ETHE) && (match & ETH_SCREENER_ETHERTYPE)) {
+			uint8_t idx = (st2rpq & GMAC_ST2RPQ_I2ETH_Msk) >> GMAC_ST2RPQ_I2ETH_Pos;
+			if (gmac_get_st2_ethertype(gmac, idx) == ethertype)
+				et = idx;
+		}
+		if (st2rpq & GMAC_ST2RPQ_COMPAE)
+			used |= 1u << ((st2rpq & GMAC_ST2RPQ_COMPA_Msk) >> GMAC_ST2RPQ_COMPA_Pos);
+		if (st2rpq & GMAC_ST2RPQ_COMPBE)
+			used |= 1u << ((st2rpq & GMAC_ST2RPQ_COMPB_Msk) >> GMAC_ST2RPQ_COMPB_Pos);
+		if (st2rpq & GMAC_ST2RPQ_COMPCE)
+			used |= 1u << ((st2rpq & GMAC_ST2RPQ_COMPC_Msk) >> GMAC_ST2RPQ_COMPC_Pos);
+	}
+	if (index < 0)
+		return ETH_NO_RESOURCE;
+
+	st2rpq = GMAC_ST2RPQ_QNB(screener->queue);
+
+	if (match & ETH_SCREENER_VLAN_PRIO)
+		st2rpq |= GMAC_ST2RPQ_VLANE | GMAC_ST2RPQ_VLANP(screener->vlan_prio);
+
+	if (match & ETH_SCREENER_ETHERTYPE) {
+		if (et < 0) {
+			uint32_t et_used = 0;
+			for (i = 0; i < GMAC_NUM_ST2_SCREENERS; i++) {
+				uint32_t reg = gmac_get_st2_screener(gmac, i);
+				if (reg & GMAC_ST2RPQ_ETHE)
+					et_used |= 1u << ((reg & GMAC_ST2RPQ_I2ETH_Msk) >> GMAC_ST2RPQ_I2ETH_Pos);
+			}
+			for (i = 0; i < GMAC_NUM_ST2_ETHERTYPES; i++) {
+				if (!(et_used & (1u << i))) {
+					et = i;
+					break;
+				}
+			}
+			if (et < 0)
+				return ETH_NO_RESOURCE;
+			gmac_set_st2_ethertype(gmac, et, ethertype);
+		}
+		st2rpq |= GMAC_ST2RPQ_ETHE | GMAC_ST2RPQ_I2ETH(et);
+	}
+
+	/* DSCP: upper 6 bits of the second byte of the IPv4 header, the ECN
+	 * bits are masked */
+	if (match & ETH_SCREENER_DSCP)
+		cmp[num_cmp++] = _gmacd_add_st2_compare(gmac, &used,
+				GMAC_ST2CW1_OFFSSTRT_ETHERTYPE | GMAC_ST2CW1_OFFSVAL(0),
+				GMAC_ST2_BYTES(0, screener->dscp << 2),
+				GMAC_ST2_BYTES(0, 0xfc));
+
+	if (match & (ETH_SCREENER_UDP_PORT | ETH_SCREENER_TCP_PORT)) {
+		/* Protocol: 10th byte of the IPv4 header, after the TTL */
+		uint8_t proto = (match & ETH_SCREENER_TCP_PORT) ? IP_PROTO_TCP : IP_PROTO_UDP;
+		cmp[num_cmp++] = _gmacd_add_st2_compare(gmac, &used,
+				GMAC_ST2CW1_OFFSSTRT_ETHERTYPE | GMAC_ST2CW1_OFFSVAL(8),
+				GMAC_ST2_BYTES(0, proto),
+				GMAC_ST2_BYTES(0, 0xff));
+
+		/* Destination port, in network order after the source port */
+		cmp[num_cmp++] = _gmacd_add_st2_compare(gmac, &used,
+				GMAC_ST2CW1_OFFSSTRT_IP | GMAC_ST2CW1_OFFSVAL(2),
+				GMAC_ST2_BYTES(screener->port >> 8, screener->port & 0xff),
+				0xffff);
+	}
+
+	for (i = 0; i < num_cmp; i++)
+		if (cmp[i] < 0)
+			return ETH_NO_RESOURCE;
+	if (num_cmp > 0)
+		st2rpq |= GMAC_ST2RPQ_COMPAE | GMAC_ST2RPQ_COMPA(cmp[0]);
+	if (num_cmp > 1)
+		st2rpq |= GMAC_ST2RPQ_COMPBE | GMAC_ST2RPQ_COMPB(cmp[1]);
+	if (num_cmp > 2)
+		st2rpq |= GMAC_ST2RPQ_COMPCE | GMAC_ST2RPQ_COMPC(cmp[2]);
+
+	gmac_set_st2_screener(gmac, index, st2rpq);
+	return ETH_OK;
+}
+
+#endif /* CONFIG_HAVE_GMAC_QUEUES */
+
+/**
+ * \brief Install a RX screening rule steering the matching frames to a
+ * priority queue. Rules on the UDP port only use the screening type 1
+ * registers, the other rules use the screening type 2 registers.
+ * \param gmacd Pointer to GMAC Driver instance.
+ * \param screener Rule to install.
+ * \return ETH_OK, ETH_PARAM or ETH_NO_RESOURCE.
+ */
+uint8_t gmacd_add_screener(struct _ethd* gmacd, const struct _eth_screener* screener)
+{
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+	uint8_t match = screener->match;
+
+	if (screener->queue >= GMAC_NUM_QUEUES ||
+	    gmacd->queues[screener->queue].rx_buffer == dummy_buffer)
+		return ETH_PARAM;
+	if (!match || (match & ~(ETH_SCREENER_ETHERTYPE | ETH_SCREENER_VLAN_PRIO |
+			ETH_SCREENER_DSCP | ETH_SCREENER_UDP_PORT | ETH_SCREENER_TCP_PORT)))
+		return ETH_PARAM;
+	if ((match & ETH_SCREENER_UDP_PORT) && (match & ETH_SCREENER_TCP_PORT))
+		return ETH_PARAM;
+	if (screener->vlan_prio > 7 || screener->dscp > 63)
+		return ETH_PARAM;
+
+	if (match == ETH_SCREENER_UDP_PORT)
+		return _gmacd_add_st1_screener(gmacd, screener);
+	else
+		return _gmacd_add_st2_screener(gmacd, screener);
+#else
+	return ETH_PARAM;
+#endif
+}
+
+/**
+ * \brief Remove all the RX screening rules.
+ * \param gmacd Pointer to GMAC Driver instance.
+ */
+void gmacd_clear_screeners(struct _ethd* gmacd)
+{
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+	gmac_clear_screeners(gmacd->gmac);
+#endif
+}
+
+/**
+ * \brief Mask/Unmask the RX interrupts of a queue, used for RX interrupt
+ * coalescing. The RX complete interrupt is only unmasked if a RX callback
+ * is registered.
+ *  \param gmacd Pointer to GMAC Driver instance.
+ *  \param enable Unmask the RX interrupts.
+ */
+void gmacd_enable_rx_it(struct _ethd* gmacd, uint8_t queue, bool enable)
+{
+	struct _ethd_queue* q = &gmacd->queues[queue];
+	uint32_t bits = GMAC_INT_RX_BITS;
+
+	if (enable) {
+		if (!q->rx_callback)
+			bits &= ~GMAC_IER_RCOMP;
+		gmac_enable_it(gmacd->gmac, queue, bits);
+	} else {
+		gmac_disable_it(gmacd->gmac, queue, bits);
+	}
+}
+
+/**
+ * \brief Accumulate the statistics registers of the GMAC.
+ *  \param gmacd Pointer to GMAC Driver instance.
+ */
+void gmacd_update_stats(struct _ethd* gmacd)
+{
+	gmac_read_statistics(gmacd->gmac, &gmacd->mac_stats);
+}
+
 const struct _ethd_op _gmac_op = {
 	.configure = (_ethd_configure)gmacd_configure,
 	.setup_queue = (_ethd_setup_queue)gmacd_setup_queue,
@@ -528,8 +1000,21 @@ const struct _ethd_op _gmac_op = {
 	.get_mac_addr = (_eth_get_mac_addr)gmac_get_mac_addr,
 	.start_transmission =(_eth_start_transmission)gmac_start_transmission,
 	.send_sg = (_ethd_send_sg)ethd_send_sg,
+	.send_sg_zero_copy = (_ethd_send_sg_zero_copy)ethd_send_sg_zero_copy,
 	.send = (_ethd_send)ethd_send,
 	.poll = (_ethd_poll)ethd_poll,
+	.rx_loan = (_ethd_rx_loan)ethd_rx_loan,
+	.rx_return = (_ethd_rx_return)ethd_rx_return,
+	.set_offload = (_ethd_set_offload)gmacd_set_offload,
+	.enable_jumbo_frames = (_ethd_enable_jumbo_frames)gmacd_enable_jumbo_frames,
+	.add_screener = (_ethd_add_screener)gmacd_add_screener,
+	.clear_screeners = (_ethd_clear_screeners)gmacd_clear_screeners,
+	.ptp_get_time = (_ethd_ptp_get_time)gmacd_ptp_get_time,
+	.ptp_set_time = (_ethd_ptp_set_time)gmacd_ptp_set_time,
+	.ptp_adjust_time = (_ethd_ptp_adjust_time)gmacd_ptp_adjust_time,
+	.ptp_adjust_freq = (_ethd_ptp_adjust_freq)gmacd_ptp_adjust_freq,
+	.update_stats = (_ethd_update_stats)gmacd_update_stats,
 	.set_rx_callback = (_ethd_set_rx_callback)gmacd_set_rx_callback,
+	.enable_rx_it = (_ethd_enable_rx_it)gmacd_enable_rx_it,
 	.set_tx_wakeup_callback = (_ethd_set_tx_wakeup_callback)ethd_set_tx_wakeup_callback,
 };
@@ -40,7 +40,8 @@
  *    and ethd_set_tx_wakeup_callback().
  * -# Send ethernet packets using ethd_send(), ethd_get_tx_load() is used
  *    to get the free space in TX queue.
- * -# Check and obtain received ethernet packets via ethd_poll().
+ * -# Check and obtain received ethernet packets via ethd_poll(), or
+ *    borrow them without copy via ethd_rx_loan() and ethd_rx_return().
  *
  * \sa \ref gmacb_module, \ref gmac_module
  *
@@ -100,7 +101,7 @@ extern "C" {
 extern void gmacd_configure(struct _ethd* gmacd, Gmac *pHw, uint8_t enableCAF, uint8_t enableNBC);
 
 extern uint8_t gmacd_setup_queue(struct _ethd* gmacd, uint8_t queue,
-		uint16_t rx_size, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
+		uint16_t rx_size, uint16_t rx_unitsize, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
 		uint16_t tx_size, uint8_t* tx_buffer, struct _eth_desc* tx_desc,
 		ethd_callback_t *tx_callbacks);
 
@@ -108,6 +109,21 @@ extern void gmacd_start(struct _ethd* gmacd);
 
 extern void gmacd_reset(struct _ethd* gmacd);
 
+extern void gmacd_set_offload(struct _ethd* gmacd, uint32_t offload);
+
+extern void gmacd_ptp_get_time(struct _ethd* gmacd, struct _eth_timestamp* ts);
+
+extern void gmacd_ptp_set_time(struct _ethd* gmacd, const struct _eth_timestamp* ts);
+
+extern void gmacd_ptp_adjust_time(struct _ethd* gmacd, int32_t nsec);
+
+extern void gmacd_ptp_adjust_freq(struct _ethd* gmacd, int32_t ppb);
+
+extern uint8_t gmacd_add_screener(struct _ethd* gmacd,
+		const struct _eth_screener* screener);
+
+extern void gmacd_clear_screeners(struct _ethd* gmacd);
+
 extern uint8_t gmacd_send_sg(struct _ethd* gmacd, uint8_t queue,
 		const struct _eth_sg_list* sgl, ethd_callback_t callback);
 
@@ -119,9 +135,15 @@ extern uint32_t gmacd_get_tx_load(struct _ethd* gmacd, uint8_t queue);
 extern uint8_t gmacd_poll(struct _ethd* gmacd, uint8_t queue,
 		uint8_t* buffer, uint32_t buffer_size, uint32_t* recv_size);
 
+extern void gmacd_enable_jumbo_frames(struct _ethd* gmacd, bool enable);
+
 extern void gmacd_set_rx_callback(struct _ethd *gmacd, uint8_t queue,
 		ethd_callback_t callback);
 
+extern void gmacd_update_stats(struct _ethd* gmacd);
+
+extern void gmacd_enable_rx_it(struct _ethd* gmacd, uint8_t queue, bool enable);
+
 /** @}*/
 
 #ifdef __cplusplus
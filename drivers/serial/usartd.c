@@ -65,8 +65,6 @@ static void _usartd_dma_write_callback(struct dma_channel* channel, void* args)
 	uint8_t iface = (uint32_t)args;
 	assert(iface < USART_IFACE_COUNT);
 
-	dma_free_channel(channel);
-
 	if (_serial[iface]->tx.callback)
 		_serial[iface]->tx.callback(iface, _serial[iface]->tx.cb_args);
 
@@ -89,7 +87,6 @@ static void _usartd_dma_read_callback(struct dma_channel* channel, void* args)
 	dma_fifo_flush(channel);
 
 	desc->rx.transferred = dma_get_transferred_data_len(channel, desc->dma.rx.cfg.chunk_size, desc->dma.rx.cfg.len);
-	dma_free_channel(channel);
 
 	if (desc->rx.transferred > 0) {
 		cache_invalidate_region(desc->dma.rx.cfg.da, desc->rx.transferred);
@@ -103,16 +100,33 @@ static void _usartd_dma_read_callback(struct dma_channel* channel, void* args)
 	mutex_unlock(&desc->rx.mutex);
 }
 
-static void _usartd_dma_read(uint8_t iface)
+static void _usartd_dma_reserve(uint8_t iface)
 {
 	assert(iface < USART_IFACE_COUNT);
 	struct _usart_desc* desc = _serial[iface];
 	uint32_t id = get_usart_id_from_addr(desc->addr);
 
-	memset(&desc->dma.rx.cfg, 0x0, sizeof(desc->dma.rx.cfg));
+	/* Channels are kept between transfers, and only rearmed */
+	if (!desc->dma.rx.channel) {
+		desc->dma.rx.channel = dma_allocate_channel(id, DMA_PERIPH_MEMORY);
+		assert(desc->dma.rx.channel);
+		dma_set_callback(desc->dma.rx.channel, _usartd_dma_read_callback, (void *)(uint32_t)iface);
+	}
+	if (!desc->dma.tx.channel) {
+		desc->dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
+		assert(desc->dma.tx.channel);
+		dma_set_callback(desc->dma.tx.channel, _usartd_dma_write_callback, (void*)(uint32_t)iface);
+	}
+}
 
-	desc->dma.rx.channel = dma_allocate_channel(id, DMA_PERIPH_MEMORY);
-	assert(desc->dma.rx.channel);
+static void _usartd_dma_read(uint8_t iface)
+{
+	assert(iface < USART_IFACE_COUNT);
+	struct _usart_desc* desc = _serial[iface];
+
+	_usartd_dma_reserve(iface);
+
+	memset(&desc->dma.rx.cfg, 0x0, sizeof(desc->dma.rx.cfg));
 
 	desc->dma.rx.cfg.sa = (void *)&desc->addr->US_RHR;
 	desc->dma.rx.cfg.da = desc->rx.buffer.data;
@@ -123,7 +137,6 @@ static void _usartd_dma_read(uint8_t iface)
 	desc->dma.rx.cfg.len = desc->rx.buffer.size;
 	dma_configure_transfer(desc->dma.rx.channel, &desc->dma.rx.cfg);
 
-	dma_set_callback(desc->dma.rx.channel, _usartd_dma_read_callback, (void *)(uint32_t)iface);
 	usart_enable_it(desc->addr, US_IER_TIMEOUT);
 	usart_restart_rx_timeout(desc->addr);
 	dma_start_transfer(desc->dma.rx.channel);
@@ -133,12 +146,10 @@ static void _usartd_dma_write(uint8_t iface)
 {
 	assert(iface < USART_IFACE_COUNT);
 	struct _usart_desc* desc = _serial[iface];
-	uint32_t id = get_usart_id_from_addr(desc->addr);
 
-	memset(&desc->dma.tx.cfg, 0x0, sizeof(desc->dma.tx.cfg));
+	_usartd_dma_reserve(iface);
 
-	desc->dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
-	assert(desc->dma.tx.channel);
+	memset(&desc->dma.tx.cfg, 0x0, sizeof(desc->dma.tx.cfg));
 
 	desc->dma.tx.cfg.sa = desc->tx.buffer.data;
 	desc->dma.tx.cfg.da = (void *)&desc->addr->US_THR;
@@ -149,7 +160,6 @@ static void _usartd_dma_write(uint8_t iface)
 	desc->dma.tx.cfg.len = desc->tx.buffer.size;
 	dma_configure_transfer(desc->dma.tx.channel, &desc->dma.tx.cfg);
 
-	dma_set_callback(desc->dma.tx.channel, _usartd_dma_write_callback, (void*)(uint32_t)iface);
 	cache_clean_region(desc->dma.tx.cfg.sa, desc->dma.tx.cfg.len);
 	dma_start_transfer(desc->dma.tx.channel);
 }
@@ -268,6 +278,9 @@ void usartd_configure(uint8_t iface, struct _usart_desc* config)
 	if (config->use_fifo)
 		usart_fifo_enable(config->addr);
 #endif
+
+	if (config->transfer_mode == USARTD_MODE_DMA)
+		_usartd_dma_reserve(iface);
 }
 
 uint32_t usartd_transfer(uint8_t iface, struct _buffer* buf, usartd_callback_t cb, void* user_args)
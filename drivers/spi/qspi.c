@@ -64,9 +64,12 @@ static void qspi_memcpy(uint8_t *dst, const uint8_t *src, int count, bool use_dm
 	uint32_t rc;
 #ifdef CONFIG_HAVE_QSPI_DMA
 	if (use_dma) {
-		dma_ch = dma_allocate_channel(DMA_PERIPH_MEMORY, DMA_PERIPH_MEMORY);
-		if (!dma_ch)
-			trace_fatal("Couldn't allocate XDMA channel\n\r");
+		/* The channel is kept between copies, and only rearmed */
+		if (!dma_ch) {
+			dma_ch = dma_allocate_channel(DMA_PERIPH_MEMORY, DMA_PERIPH_MEMORY);
+			if (!dma_ch)
+				trace_fatal("Couldn't allocate XDMA channel\n\r");
+		}
 		dma_cfg.da = (void *)dst;
 		dma_cfg.sa = (void *)src;
 		dma_cfg.len = count;
@@ -76,9 +79,6 @@ static void qspi_memcpy(uint8_t *dst, const uint8_t *src, int count, bool use_dm
 			trace_fatal("Couldn't start xDMA transfer\n\r");
 		while (!dma_is_transfer_done(dma_ch))
 			dma_poll();
-		dma_stop_transfer(dma_ch);
-		dma_free_channel(dma_ch);
-		dma_ch = NULL;
 		dsb();
 	} else
 #endif
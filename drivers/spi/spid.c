@@ -87,41 +87,47 @@ static void _spid_dma_callback(struct dma_channel *channel, void *arg)
 {
 	struct _spi_desc* desc = (struct _spi_desc*)arg;
 
-	if (channel == desc->xfer.dma.rx.channel ||
-		channel == desc->xfer.dma.tx.channel)
-		/* free channel */
-		dma_free_channel(channel);
-	else
+	if (channel != desc->xfer.dma.rx.channel &&
+		channel != desc->xfer.dma.tx.channel)
 		trace_fatal("Invalid DMA channel!\r\n");
 
+	/* Wait for both channels to complete */
+	if (!dma_is_transfer_done(desc->xfer.dma.rx.channel) ||
+		!dma_is_transfer_done(desc->xfer.dma.tx.channel))
+		return;
+
 	/* For read, invalidate region */
-	if (channel == desc->xfer.dma.rx.channel)
+	if (desc->xfer.dma.rx.cfg.upd_da_per_data)
 		cache_invalidate_region(desc->xfer.dma.rx.cfg.da, desc->xfer.dma.rx.cfg.len);
 
 	/* process next buffer */
 	_spid_transfer_next_buffer(desc);
 }
 
-static void _spid_dma_free_callback(struct dma_channel *channel, void *arg)
+static void _spid_dma_reserve(struct _spi_desc* desc)
 {
-	struct _spi_desc* desc = (struct _spi_desc*)arg;
+	uint32_t id = get_spi_id_from_addr(desc->addr);
 
-	if (channel == desc->xfer.dma.rx.channel ||
-		channel == desc->xfer.dma.tx.channel)
-		/* free channel */
-		dma_free_channel(channel);
+	/* Channels are kept between transfers, and only rearmed */
+	if (!desc->xfer.dma.tx.channel) {
+		desc->xfer.dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
+		assert(desc->xfer.dma.tx.channel);
+		dma_set_callback(desc->xfer.dma.tx.channel, _spid_dma_callback, (void*)desc);
+	}
+	if (!desc->xfer.dma.rx.channel) {
+		desc->xfer.dma.rx.channel = dma_allocate_channel(id, DMA_PERIPH_MEMORY);
+		assert(desc->xfer.dma.rx.channel);
+		dma_set_callback(desc->xfer.dma.rx.channel, _spid_dma_callback, (void*)desc);
+	}
 }
 
 static void _spid_dma_write(struct _spi_desc* desc, uint8_t *buf, uint32_t len)
 {
-	uint32_t id = get_spi_id_from_addr(desc->addr);
-
 	cache_clean_region(buf, len);
 
-	memset(&desc->xfer.dma.tx.cfg, 0, sizeof(desc->xfer.dma.tx.cfg));
+	_spid_dma_reserve(desc);
 
-	desc->xfer.dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
-	assert(desc->xfer.dma.tx.channel);
+	memset(&desc->xfer.dma.tx.cfg, 0, sizeof(desc->xfer.dma.tx.cfg));
 
 	desc->xfer.dma.tx.cfg.da = (void*)&desc->addr->SPI_TDR;
 	desc->xfer.dma.tx.cfg.sa = buf;
@@ -132,13 +138,9 @@ static void _spid_dma_write(struct _spi_desc* desc, uint8_t *buf, uint32_t len)
 	desc->xfer.dma.tx.cfg.blk_size = 0;
 	desc->xfer.dma.tx.cfg.len = len;
 	dma_configure_transfer(desc->xfer.dma.tx.channel, &desc->xfer.dma.tx.cfg);
-	dma_set_callback(desc->xfer.dma.tx.channel, _spid_dma_callback, (void*)desc);
 
 	memset(&desc->xfer.dma.rx.cfg, 0, sizeof(desc->xfer.dma.rx.cfg));
 
-	desc->xfer.dma.rx.channel = dma_allocate_channel(id, DMA_PERIPH_MEMORY);
-	assert(desc->xfer.dma.rx.channel);
-
 	desc->xfer.dma.rx.cfg.sa = (void*)&desc->addr->SPI_RDR;
 	desc->xfer.dma.rx.cfg.da = &_garbage;
 	desc->xfer.dma.rx.cfg.upd_sa_per_data = 0;
@@ -148,7 +150,6 @@ static void _spid_dma_write(struct _spi_desc* desc, uint8_t *buf, uint32_t len)
 	desc->xfer.dma.rx.cfg.blk_size = 0;
 	desc->xfer.dma.rx.cfg.len = len;
 	dma_configure_transfer(desc->xfer.dma.rx.channel, &desc->xfer.dma.rx.cfg);
-	dma_set_callback(desc->xfer.dma.rx.channel, _spid_dma_free_callback, (void*)desc);
 
 	dma_start_transfer(desc->xfer.dma.rx.channel);
 	dma_start_transfer(desc->xfer.dma.tx.channel);
@@ -156,13 +157,10 @@ static void _spid_dma_write(struct _spi_desc* desc, uint8_t *buf, uint32_t len)
 
 static void _spid_dma_read(struct _spi_desc* desc, uint8_t *buf, uint32_t len)
 {
-	uint32_t id = get_spi_id_from_addr(desc->addr);
+	_spid_dma_reserve(desc);
 
 	memset(&desc->xfer.dma.tx.cfg, 0, sizeof(desc->xfer.dma.tx.cfg));
 
-	desc->xfer.dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
-	assert(desc->xfer.dma.tx.channel);
-
 	desc->xfer.dma.tx.cfg.da = (void*)&desc->addr->SPI_TDR;
 	desc->xfer.dma.tx.cfg.sa = &_garbage;
 	desc->xfer.dma.tx.cfg.upd_sa_per_data = 0;
@@ -172,13 +170,9 @@ static void _spid_dma_read(struct _spi_desc* desc, uint8_t *buf, uint32_t len)
 	desc->xfer.dma.tx.cfg.blk_size = 0;
 	desc->xfer.dma.tx.cfg.len = len;
 	dma_configure_transfer(desc->xfer.dma.tx.channel, &desc->xfer.dma.tx.cfg);
-	dma_set_callback(desc->xfer.dma.tx.channel, _spid_dma_free_callback, (void*)desc);
 
 	memset(&desc->xfer.dma.rx.cfg, 0, sizeof(desc->xfer.dma.rx.cfg));
 
-	desc->xfer.dma.rx.channel = dma_allocate_channel(id, DMA_PERIPH_MEMORY);
-	assert(desc->xfer.dma.rx.channel);
-
 	desc->xfer.dma.rx.cfg.sa = (void*)&desc->addr->SPI_RDR;
 	desc->xfer.dma.rx.cfg.da = buf;
 	desc->xfer.dma.rx.cfg.upd_sa_per_data = 0;
@@ -188,7 +182,6 @@ static void _spid_dma_read(struct _spi_desc* desc, uint8_t *buf, uint32_t len)
 	desc->xfer.dma.rx.cfg.blk_size = 0;
 	desc->xfer.dma.rx.cfg.len = len;
 	dma_configure_transfer(desc->xfer.dma.rx.channel, &desc->xfer.dma.rx.cfg);
-	dma_set_callback(desc->xfer.dma.rx.channel, _spid_dma_callback, (void*)desc);
 
 	dma_start_transfer(desc->xfer.dma.rx.channel);
 	dma_start_transfer(desc->xfer.dma.tx.channel);
@@ -424,6 +417,9 @@ void spid_configure(struct _spi_desc* desc)
 	irq_add_handler(id, _spid_handler, desc);
 	irq_enable(id);
 
+	if (desc->transfer_mode == SPID_MODE_DMA)
+		_spid_dma_reserve(desc);
+
 	spi_enable(desc->addr);
 }
 
@@ -0,0 +1,235 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \page cache_benchmark Cache Benchmark Example
+ *
+ *  \section Purpose
+ *
+ *  This example measures, with the PMU cycle counter, the cost of cleaning
+ *  and invalidating regions of increasing size line by line, and compares it
+ *  with the cost of whole-cache operations. It reports the smallest region
+ *  size for which the whole-cache operation is faster, for the L1 cache and,
+ *  when present, for the L2 cache.
+ *
+ *  \section Requirements
+ *
+ *  This package can be used with SAMA5D2, SAMA5D3 and SAMA5D4 boards (the
+ *  ARM926 of SAM9XX5 devices has no PMU).
+ *
+ *  \section Usage
+ *
+ *  -# Build the program and download it inside the evaluation board.
+ *  -# On the computer, open and configure a terminal application
+ *     (e.g. HyperTerminal on Microsoft Windows) with these settings:
+ *    - 115200 bauds
+ *    - 8 bits of data
+ *    - No parity
+ *    - 1 stop bit
+ *    - No flow control
+ *  -# Start the application.
+ *  -# The measurements are printed, followed by the suggested values of
+ *     CACHE_L1_FLUSH_THRESHOLD and CACHE_L2_FLUSH_THRESHOLD. The suggested
+ *     thresholds are applied with cache_set_flush_threshold().
+ *
+ *  \section References
+ *  - cache_benchmark/main.c
+ *  - cache.h
+ */
+
+/** \file
+ *
+ *  This file contains all the specific code for the cache benchmark example.
+ *
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "board.h"
+#include "chip.h"
+#include "trace.h"
+#include "compiler.h"
+
+#include "core/arm_cp15_pmu.h"
+#include "misc/cache.h"
+#include "misc/console.h"
+#include "peripherals/l2cc.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** Smallest and largest measured region sizes (in bytes) */
+#define MIN_SIZE (1024)
+#define MAX_SIZE (1024 * 1024)
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+/** Region and whole-cache variants of one maintenance operation */
+struct _cache_op {
+	const char *name;
+	void (*region)(uint32_t start, uint32_t end);
+	void (*whole)(void);
+	bool clean_l1;	/* push the dirty lines down to L2 first */
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+CACHE_ALIGNED_DDR static uint8_t buffer[MAX_SIZE];
+
+static const struct _cache_op l1_ops[] = {
+	{ "L1 clean", cp15_dcache_clean_region, cp15_dcache_clean, false },
+	{ "L1 clean+inv", cp15_dcache_clean_invalidate_region,
+	  cp15_dcache_clean_invalidate, false },
+};
+
+#ifdef CONFIG_HAVE_L2CC
+static const struct _cache_op l2_ops[] = {
+	{ "L2 clean", l2cc_clean_region, l2cc_clean, true },
+};
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Time one operation on a freshly dirtied region.
+ * \return elapsed cycles
+ */
+static uint32_t _measure(const struct _cache_op *op, uint32_t size, bool whole)
+{
+	uint32_t start;
+
+	/* dirty the lines so that the operation has data to write back */
+	memset(buffer, (uint8_t)size, size);
+	if (op->clean_l1)
+		cp15_dcache_clean();
+	dsb();
+
+	start = cp15_get_cycle_counter();
+	if (whole)
+		op->whole();
+	else
+		op->region((uint32_t)buffer, (uint32_t)buffer + size);
+	return (cp15_get_cycle_counter() - start) * CP15_PMU_CYCLES_PER_TICK;
+}
+
+/**
+ * \brief Measure an operation for all region sizes.
+ * \return the smallest size for which the whole-cache operation is faster,
+ * or 0 if it never is.
+ */
+static uint32_t _find_crossover(const struct _cache_op *op)
+{
+	uint32_t size, crossover = 0;
+
+	printf("\r\n-- %s --\r\n", op->name);
+	printf("    size    region     whole\r\n");
+	for (size = MIN_SIZE; size <= MAX_SIZE; size *= 2) {
+		uint32_t region = _measure(op, size, false);
+		uint32_t whole = _measure(op, size, true);
+
+		printf("%8u %9u %9u\r\n", (unsigned)size,
+		       (unsigned)region, (unsigned)whole);
+		if (!crossover && whole <= region)
+			crossover = size;
+	}
+	return crossover;
+}
+
+/**
+ * \brief Keep the largest crossover of a set of operations.
+ */
+static uint32_t _run_ops(const struct _cache_op *ops, int count)
+{
+	uint32_t threshold = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		uint32_t crossover = _find_crossover(&ops[i]);
+		if (!crossover) {
+			/* whole-cache operation never wins */
+			return 0;
+		}
+		if (crossover > threshold)
+			threshold = crossover;
+	}
+	return threshold;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ *  \brief Cache benchmark Application entry point.
+ *
+ *  \return Unused (ANSI-C compatibility).
+ */
+int main(void)
+{
+	uint32_t l1_threshold, l2_threshold = 0;
+
+	/* Output example information */
+	console_example_info("Cache Benchmark Example");
+
+	if (!cp15_dcache_is_enabled()) {
+		printf("Data cache is disabled, nothing to measure\r\n");
+		while (1);
+	}
+
+	cp15_pmu_start_cycle_counter();
+
+	l1_threshold = _run_ops(l1_ops, ARRAY_SIZE(l1_ops));
+#ifdef CONFIG_HAVE_L2CC
+	if (l2cc_is_enabled())
+		l2_threshold = _run_ops(l2_ops, ARRAY_SIZE(l2_ops));
+#endif
+
+	printf("\r\nSuggested CACHE_L1_FLUSH_THRESHOLD: %u\r\n",
+	       (unsigned)l1_threshold);
+#ifdef CONFIG_HAVE_L2CC
+	printf("Suggested CACHE_L2_FLUSH_THRESHOLD: %u\r\n",
+	       (unsigned)l2_threshold);
+#endif
+	cache_set_flush_threshold(l1_threshold, l2_threshold);
+
+	while (1);
+}
@@ -0,0 +1,405 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \page eth_lwip_perf ETH lwIP Throughput Example
+ *
+ *  \section Purpose
+ *
+ *  This project measures the TCP throughput and the CPU load of the lwIP
+ *  network interface. It can be built with or without the zero-copy path of
+ *  the network interface (ETHIF_ZERO_COPY) to compare both.
+ *
+ *  \section Requirements
+ *
+ * - On-board ethernet interface.
+ *
+ *  \section Description
+ *
+ *  The example runs two TCP servers:
+ *  - a discard server on port 9, which drops all the received data,
+ *  - an echo server on port 7, which sends back all the received data.
+ *
+ *  Every second, the received and sent throughputs and the CPU load are
+ *  displayed on the console. The CPU load is computed from the number of
+ *  iterations of the main loop, compared with the number of iterations
+ *  measured without traffic at startup.
+ *
+ *  RX interrupt coalescing is enabled on the ETH queue: the RX interrupt is
+ *  masked while the main loop drains the queue, and the average number of
+ *  frames handled per RX interrupt is displayed as well.
+ *
+ *  Pressing 's' on the console dumps the MAC and driver statistics, which
+ *  show where frames are dropped under load.
+ *
+ *  \section Usage
+ *
+ *  -# Build the program and download it inside the evaluation board.
+ *     To measure the copying network interface, uncomment the
+ *     ETHIF_ZERO_COPY line of the example Makefile and rebuild.
+ *  -# On the computer, open and configure a terminal application
+ *     (e.g. HyperTerminal on Microsoft Windows) with these settings:
+ *    - 115200 bauds
+ *    - 8 bits of data
+ *    - No parity
+ *    - 1 stop bit
+ *    - No flow control
+ *  -# Connect an Ethernet cable between the evaluation board and the
+ *     computer.
+ *  -# Start the application. It will display the following message on the
+ *     terminal:
+ *    \code
+ *    -- ETH lwIP Throughput Example xxx --
+ *    -- xxxxxx-xx
+ *    -- Compiled: xxx xx xxxx xx:xx:xx --
+ *      MAC 3a:1f:34:08:54:54
+ *    - Host IP  192.168.1.3
+ *    - Calibrating idle loop... xxxxxx iterations/s
+ *    \endcode
+ *  -# Send data to the board, for example:
+ *    \code
+ *    dd if=/dev/zero bs=64k count=1000 | nc 192.168.1.3 9
+ *    \endcode
+ *    The following line is displayed every second:
+ *    \code
+ *    RX xxxxx kbit/s, TX xxxxx kbit/s, CPU xx%, xx frames/IRQ
+ *    \endcode
+ *
+ *  \note
+ *  Make sure the IP adress of the device( the board) and the computer are in
+ *  the same network.
+ */
+
+/** \file
+ *
+ *  This file contains all the specific code for the eth_lwip_perf example.
+ *
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "board.h"
+#include "board_eth.h"
+#include "timer.h"
+
+#include "network/ethd.h"
+
+#include "misc/console.h"
+
+#include "liblwip.h"
+#include "lwip/opt.h"
+#include "lwip/tcp.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** TCP port of the echo server */
+#define ECHO_PORT 7
+
+/** TCP port of the discard server */
+#define DISCARD_PORT 9
+
+/** Statistics display period, in timer ticks (ms) */
+#define REPORT_PERIOD 1000
+
+/** Maximum number of frames received in one polling round */
+#define RX_BUDGET 16
+
+/** Minimum interval between two RX interrupts, in timer ticks (ms) */
+#define RX_HOLDOFF 1
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+typedef err_t (*tcp_recv_fn)(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err);
+
+/*---------------------------------------------------------------------------
+ *         Variables
+ *---------------------------------------------------------------------------*/
+
+/* The MAC address used for demo */
+static uint8_t _mac_addr[6];
+
+/* The IP address used for demo (ping ...) */
+static uint8_t _ip_addr[4] = {192, 168, 1, 3};
+
+/* Set the default router's IP address. */
+static const uint8_t _gw_ip_addr[4] = {192, 168, 1, 2};
+
+/* The NetMask address */
+static const uint8_t _netmask[4] = {255, 255, 255, 0};
+
+/* Bytes received and sent since the last report */
+static uint32_t _rx_bytes;
+static uint32_t _tx_bytes;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * Input the eth number to use
+ */
+static uint8_t select_eth_port(void)
+{
+	uint8_t key, send_port = 0;
+
+	if (ETH_IFACE_COUNT < 2)
+		return send_port;
+
+	while (1) {
+		printf("\n\r");
+		printf("Input an eth number '0' or '1' to initialize:\n\r");
+		printf("=>");
+		key = console_get_char();
+		printf("%c\r\n", key);
+
+		if (key == '0') {
+			send_port = 0;
+			break;
+		} else if (key == '1') {
+			send_port = 1;
+			break;
+		}
+	}
+
+	return send_port;
+}
+
+/**
+ * Called when data has been received on a discard connection.
+ */
+static err_t discard_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+	if (err != ERR_OK)
+		return err;
+
+	if (p == NULL) {
+		/* The remote end has closed the connection */
+		tcp_close(pcb);
+		return ERR_OK;
+	}
+
+	_rx_bytes += p->tot_len;
+	tcp_recved(pcb, p->tot_len);
+	pbuf_free(p);
+	return ERR_OK;
+}
+
+/**
+ * Called when data has been received on an echo connection. The data is
+ * refused, and presented again later by lwIP, while the send buffer is full.
+ */
+static err_t echo_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+	struct pbuf *q;
+
+	if (err != ERR_OK)
+		return err;
+
+	if (p == NULL) {
+		/* The remote end has closed the connection */
+		tcp_close(pcb);
+		return ERR_OK;
+	}
+
+	if (tcp_sndbuf(pcb) < p->tot_len ||
+	    pcb->snd_queuelen + pbuf_clen(p) > TCP_SND_QUEUELEN)
+		return ERR_MEM;
+
+	for (q = p; q != NULL; q = q->next) {
+		if (tcp_write(pcb, q->payload, q->len, TCP_WRITE_FLAG_COPY) != ERR_OK)
+			return ERR_MEM;
+	}
+	tcp_output(pcb);
+
+	_rx_bytes += p->tot_len;
+	_tx_bytes += p->tot_len;
+	tcp_recved(pcb, p->tot_len);
+	pbuf_free(p);
+	return ERR_OK;
+}
+
+/**
+ * Called when a connection has been accepted on one of the servers.
+ */
+static err_t server_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+	tcp_setprio(pcb, TCP_PRIO_MIN);
+	tcp_recv(pcb, (tcp_recv_fn)arg);
+	return ERR_OK;
+}
+
+/**
+ * Start a TCP server listening on the given port.
+ */
+static err_t server_init(uint16_t port, tcp_recv_fn recv)
+{
+	struct tcp_pcb *pcb;
+	err_t err;
+
+	pcb = tcp_new();
+	if (pcb == NULL) {
+		printf("E: tcp_new\n\r");
+		return ERR_MEM;
+	}
+
+	err = tcp_bind(pcb, NULL, port);
+	if (err != ERR_OK) {
+		printf("E: tcp_bind %x\n\r", err);
+		return err;
+	}
+
+	pcb = tcp_listen(pcb);
+	if (pcb == NULL) {
+		printf("E: tcp_listen\n\r");
+		return ERR_MEM;
+	}
+
+	tcp_arg(pcb, recv);
+	tcp_accept(pcb, server_accept);
+	return ERR_OK;
+}
+
+/**
+ * Count the number of iterations of the main loop done in one report
+ * period, without any traffic.
+ */
+static uint32_t calibrate_idle_loop(struct netif *netif)
+{
+	uint64_t start = timer_get_tick();
+	uint32_t iterations = 0;
+
+	while (timer_get_interval(start, timer_get_tick()) < REPORT_PERIOD) {
+		ethif_poll(netif);
+		iterations++;
+	}
+
+	return iterations;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ *  \brief eth_lwip_perf example entry point.
+ *
+ *  \return Unused (ANSI-C compatibility).
+ */
+int main(void)
+{
+	struct ip_addr ipaddr, netmask, gw;
+	struct netif NetIf, *netif;
+	struct _eth_rx_coalesce_stats stats;
+	uint8_t eth_port = 0;
+	uint32_t idle_iterations, iterations = 0, load;
+	uint64_t start, elapsed;
+
+	/* Output example information */
+	console_example_info("ETH lwIP Throughput Example");
+
+	/* User select the port number for multiple eth */
+	eth_port = select_eth_port();
+	ethd_get_mac_addr(board_get_eth(eth_port), 0, _mac_addr);
+
+	/* Display MAC & IP settings */
+	printf(" - MAC%d %02x:%02x:%02x:%02x:%02x:%02x\n\r", eth_port,
+	       _mac_addr[0], _mac_addr[1], _mac_addr[2],
+	       _mac_addr[3], _mac_addr[4], _mac_addr[5]);
+	printf(" - Host IP  %d.%d.%d.%d\n\r", _ip_addr[0], _ip_addr[1], _ip_addr[2], _ip_addr[3]);
+	printf(" - Network interface: RX %s, TX %s\n\r",
+	       ETHIF_ZERO_COPY ? "zero-copy" : "copy",
+	       ETHIF_ZERO_COPY && ETHIF_ZERO_COPY_TX ? "zero-copy" : "copy");
+
+	/* Initialize lwIP modules */
+	lwip_init();
+
+	IP4_ADDR(&gw, _gw_ip_addr[0], _gw_ip_addr[1], _gw_ip_addr[2], _gw_ip_addr[3]);
+	IP4_ADDR(&ipaddr, _ip_addr[0], _ip_addr[1], _ip_addr[2], _ip_addr[3]);
+	IP4_ADDR(&netmask, _netmask[0], _netmask[1], _netmask[2], _netmask[3]);
+
+	netif = netif_add(&NetIf, &ipaddr, &netmask, &gw, NULL, ethif_init, ip_input);
+	netif_set_default(netif);
+	netif_set_up(netif);
+
+	/* Poll the received frames with the RX interrupt masked */
+	ethd_set_rx_budget(board_get_eth(eth_port), 0, RX_BUDGET);
+	ethd_set_rx_coalescing(board_get_eth(eth_port), 0, true, RX_HOLDOFF);
+
+	printf(" - Calibrating idle loop... ");
+	idle_iterations = calibrate_idle_loop(netif);
+	printf("%u iterations/s\n\r", (unsigned)idle_iterations);
+
+	/* Initialize TCP servers */
+	if (server_init(DISCARD_PORT, discard_recv) != ERR_OK ||
+	    server_init(ECHO_PORT, echo_recv) != ERR_OK)
+		return -1;
+	printf("Send data to TCP port %d (discard) or %d (echo)\n\r",
+	       DISCARD_PORT, ECHO_PORT);
+
+	start = timer_get_tick();
+	while (1) {
+		/* Run polling tasks */
+		ethif_poll(netif);
+		iterations++;
+
+		if (console_is_rx_ready() && console_get_char() == 's')
+			ethd_dump_stats(board_get_eth(eth_port));
+
+		elapsed = timer_get_interval(start, timer_get_tick());
+		if (elapsed < REPORT_PERIOD)
+			continue;
+
+		if (_rx_bytes || _tx_bytes) {
+			load = 0;
+			if (iterations < idle_iterations)
+				load = 100 - (100ull * iterations) / idle_iterations;
+			ethd_get_rx_coalesce_stats(board_get_eth(eth_port), 0, &stats);
+			printf("RX %u kbit/s, TX %u kbit/s, CPU %u%%, %u frames/IRQ\n\r",
+			       (unsigned)((8ull * _rx_bytes) / elapsed),
+			       (unsigned)((8ull * _tx_bytes) / elapsed),
+			       (unsigned)load,
+			       (unsigned)(stats.interrupts ? stats.frames / stats.interrupts : 0));
+		}
+
+		ethd_reset_rx_coalesce_stats(board_get_eth(eth_port), 0);
+		_rx_bytes = 0;
+		_tx_bytes = 0;
+		iterations = 0;
+		start = timer_get_tick();
+	}
+}
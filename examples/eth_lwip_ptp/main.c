@@ -0,0 +1,588 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \page eth_lwip_ptp ETH lwIP PTP Slave Example
+ *
+ *  \section Purpose
+ *
+ *  This project synchronizes the IEEE 1588 timer of the GMAC with a PTP
+ *  master on the network, using the hardware timestamps of the PTP event
+ *  frames.
+ *
+ *  \section Requirements
+ *
+ * - On-board GMAC ethernet interface.
+ * - A PTPv2 master on the network, using the end-to-end delay mechanism
+ *   over UDP/IPv4 (e.g. ptp4l -4 -E on Linux).
+ *
+ *  \section Description
+ *
+ *  The example implements a minimal PTPv2 ordinary clock, slave only, in
+ *  domain 0. It follows the first master it hears from (no best master
+ *  clock algorithm).
+ *
+ *  For each Sync message (with its Follow_Up if the master is two-step), a
+ *  Delay_Req message is sent, and the offset from the master is computed
+ *  with the timestamps latched by the GMAC when the Sync message was
+ *  received and the Delay_Req message was sent. Large offsets are corrected
+ *  by stepping the timer, small ones by trimming its frequency with a
+ *  proportional-integral servo.
+ *
+ *  \section Usage
+ *
+ *  -# Build the program and download it inside the evaluation board.
+ *  -# On the computer, open and configure a terminal application
+ *     (e.g. HyperTerminal on Microsoft Windows) with these settings:
+ *    - 115200 bauds
+ *    - 8 bits of data
+ *    - No parity
+ *    - 1 stop bit
+ *    - No flow control
+ *  -# Connect an Ethernet cable between the evaluation board and the
+ *     network of the PTP master.
+ *  -# Start the application. It will display the following message on the
+ *     terminal:
+ *    \code
+ *    -- ETH lwIP PTP Slave Example xxx --
+ *    -- xxxxxx-xx
+ *    -- Compiled: xxx xx xxxx xx:xx:xx --
+ *      MAC 3a:1f:34:08:54:54
+ *    - Host IP  192.168.1.3
+ *    \endcode
+ *  -# Start the PTP master. The following line is displayed for each Sync
+ *     message:
+ *    \code
+ *    offset xxx ns, delay xxx ns, freq xxx ppb
+ *    \endcode
+ *
+ *  \note
+ *  Make sure the IP adress of the device( the board) and the PTP master are
+ *  in the same network.
+ */
+
+/** \file
+ *
+ *  This file contains all the specific code for the eth_lwip_ptp example.
+ *
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "board.h"
+#include "board_eth.h"
+
+#include "network/ethd.h"
+
+#include "misc/console.h"
+
+#include "liblwip.h"
+#include "lwip/opt.h"
+#include "lwip/udp.h"
+#include "lwip/igmp.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** UDP ports of the PTP event and general messages */
+#define PTP_EVENT_PORT     319
+#define PTP_GENERAL_PORT   320
+
+/** PTP message types */
+#define PTP_SYNC           0x0
+#define PTP_DELAY_REQ      0x1
+#define PTP_FOLLOW_UP      0x8
+#define PTP_DELAY_RESP     0x9
+
+/** PTP message layout */
+#define PTP_HEADER_LEN     34
+#define PTP_SYNC_LEN       44
+#define PTP_DELAY_REQ_LEN  44
+#define PTP_DELAY_RESP_LEN 54
+#define PTP_PORT_ID_LEN    10
+
+#define PTP_OFF_TYPE       0
+#define PTP_OFF_VERSION    1
+#define PTP_OFF_LENGTH     2
+#define PTP_OFF_DOMAIN     4
+#define PTP_OFF_FLAGS      6
+#define PTP_OFF_CORRECTION 8
+#define PTP_OFF_PORT_ID    20
+#define PTP_OFF_SEQUENCE   30
+#define PTP_OFF_CONTROL    32
+#define PTP_OFF_INTERVAL   33
+#define PTP_OFF_TIMESTAMP  34
+#define PTP_OFF_REQ_PORT_ID 44
+
+/** twoStepFlag, in the first byte of the flags */
+#define PTP_FLAG_TWO_STEP  0x02
+
+/** Offsets above which the timer is stepped, in ns */
+#define PTP_STEP_THRESHOLD 100000
+
+/** Frequency correction limit, in ppb */
+#define PTP_MAX_PPB        500000
+
+#define NSEC_PER_SEC       1000000000ll
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+/** PTP slave state */
+struct _ptp_slave {
+	struct netif* netif;
+	struct _ethd* ethd;
+	struct udp_pcb* event_pcb;
+	struct udp_pcb* general_pcb;
+
+	uint8_t port_id[PTP_PORT_ID_LEN];   /**< Our port identity */
+	uint8_t master_id[PTP_PORT_ID_LEN]; /**< Port identity of the master */
+	bool has_master;
+
+	/* Sync waiting for its Follow_Up */
+	bool sync_pending;
+	uint16_t sync_seq;
+	int64_t t2;
+	int64_t sync_correction;
+
+	/* Last master to slave delay (t2 - t1), in ns */
+	int64_t ms_delay;
+
+	/* Delay_Req waiting for its Delay_Resp */
+	bool delay_pending;
+	uint16_t delay_seq;
+
+	/* Mean path delay, in ns */
+	int64_t path_delay;
+	bool has_path_delay;
+
+	/* Servo */
+	int64_t integral;
+	int32_t ppb;
+};
+
+/*---------------------------------------------------------------------------
+ *         Variables
+ *---------------------------------------------------------------------------*/
+
+/* The MAC address used for demo */
+static uint8_t _mac_addr[6];
+
+/* The IP address used for demo (ping ...) */
+static uint8_t _ip_addr[4] = {192, 168, 1, 3};
+
+/* Set the default router's IP address. */
+static const uint8_t _gw_ip_addr[4] = {192, 168, 1, 2};
+
+/* The NetMask address */
+static const uint8_t _netmask[4] = {255, 255, 255, 0};
+
+/* The PTP primary multicast group */
+static const uint8_t _ptp_group[4] = {224, 0, 1, 129};
+
+static struct _ptp_slave _ptp;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * Input the eth number to use
+ */
+static uint8_t select_eth_port(void)
+{
+	uint8_t key, send_port = 0;
+
+	if (ETH_IFACE_COUNT < 2)
+		return send_port;
+
+	while (1) {
+		printf("\n\r");
+		printf("Input an eth number '0' or '1' to initialize:\n\r");
+		printf("=>");
+		key = console_get_char();
+		printf("%c\r\n", key);
+
+		if (key == '0') {
+			send_port = 0;
+			break;
+		} else if (key == '1') {
+			send_port = 1;
+			break;
+		}
+	}
+
+	return send_port;
+}
+
+static uint16_t get_be16(const uint8_t* buf)
+{
+	return (buf[0] << 8) | buf[1];
+}
+
+static uint32_t get_be32(const uint8_t* buf)
+{
+	return ((uint32_t)buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+}
+
+static void put_be16(uint8_t* buf, uint16_t value)
+{
+	buf[0] = value >> 8;
+	buf[1] = value & 0xff;
+}
+
+/**
+ * Get the correctionField of a message, in ns
+ */
+static int64_t get_correction(const uint8_t* msg)
+{
+	int64_t correction = ((uint64_t)get_be32(&msg[PTP_OFF_CORRECTION]) << 32) |
+		get_be32(&msg[PTP_OFF_CORRECTION + 4]);
+	return correction >> 16;
+}
+
+/**
+ * Get the timestamp of a message (the 16 upper bits of the seconds are
+ * ignored), in ns
+ */
+static int64_t get_timestamp(const uint8_t* msg)
+{
+	uint32_t sec = get_be32(&msg[PTP_OFF_TIMESTAMP + 2]);
+	uint32_t nsec = get_be32(&msg[PTP_OFF_TIMESTAMP + 6]);
+	return sec * NSEC_PER_SEC + nsec;
+}
+
+static int64_t timestamp_to_ns(const struct _eth_timestamp* ts)
+{
+	return ts->sec * NSEC_PER_SEC + ts->nsec;
+}
+
+/**
+ * Step the timer by the given offset, in ns
+ */
+static void ptp_step(struct _ptp_slave* ptp, int64_t offset)
+{
+	struct _eth_timestamp ts;
+	int64_t now;
+
+	if (offset > -NSEC_PER_SEC && offset < NSEC_PER_SEC) {
+		ethd_ptp_adjust_time(ptp->ethd, (int32_t)offset);
+	} else {
+		ethd_ptp_get_time(ptp->ethd, &ts);
+		now = timestamp_to_ns(&ts) + offset;
+		ts.sec = now / NSEC_PER_SEC;
+		ts.nsec = now % NSEC_PER_SEC;
+		ethd_ptp_set_time(ptp->ethd, &ts);
+	}
+
+	/* The measurements in progress are not valid anymore */
+	ptp->sync_pending = false;
+	ptp->delay_pending = false;
+	ptp->integral = 0;
+}
+
+/**
+ * Send a Delay_Req message. Its transmission time is latched by the GMAC.
+ */
+static void ptp_send_delay_req(struct _ptp_slave* ptp)
+{
+	struct _eth_timestamp ts;
+	struct ip_addr group;
+	struct pbuf* p;
+	uint8_t* msg;
+
+	p = pbuf_alloc(PBUF_TRANSPORT, PTP_DELAY_REQ_LEN, PBUF_RAM);
+	if (p == NULL)
+		return;
+
+	msg = p->payload;
+	memset(msg, 0, PTP_DELAY_REQ_LEN);
+	msg[PTP_OFF_TYPE] = PTP_DELAY_REQ;
+	msg[PTP_OFF_VERSION] = 2;
+	put_be16(&msg[PTP_OFF_LENGTH], PTP_DELAY_REQ_LEN);
+	memcpy(&msg[PTP_OFF_PORT_ID], ptp->port_id, PTP_PORT_ID_LEN);
+	put_be16(&msg[PTP_OFF_SEQUENCE], ++ptp->delay_seq);
+	msg[PTP_OFF_CONTROL] = 1;
+	msg[PTP_OFF_INTERVAL] = 0x7f;
+
+	/* Forget the timestamp of the previous Delay_Req */
+	ethd_ptp_get_event(ptp->ethd, ETH_PTP_DELAY_REQ_TX, &ts);
+
+	IP4_ADDR(&group, _ptp_group[0], _ptp_group[1], _ptp_group[2], _ptp_group[3]);
+	if (udp_sendto(ptp->event_pcb, p, &group, PTP_EVENT_PORT) == ERR_OK)
+		ptp->delay_pending = true;
+	pbuf_free(p);
+}
+
+/**
+ * Compute the offset from the master once t1 and t2 are known, and correct
+ * the timer.
+ */
+static void ptp_sync(struct _ptp_slave* ptp, int64_t t1, int64_t t2, int64_t correction)
+{
+	int64_t offset;
+
+	ptp->ms_delay = t2 - t1 - correction;
+	offset = ptp->ms_delay - (ptp->has_path_delay ? ptp->path_delay : 0);
+
+	if (offset > PTP_STEP_THRESHOLD || offset < -PTP_STEP_THRESHOLD) {
+		printf("step %d ms\n\r", (int)(offset / 1000000));
+		ptp_step(ptp, -offset);
+		ptp->has_path_delay = false;
+		return;
+	}
+
+	/* Proportional-integral servo, for one Sync per second */
+	ptp->integral += offset;
+	ptp->ppb = (int32_t)(-(offset * 7) / 10 - (ptp->integral * 3) / 10);
+	if (ptp->ppb > PTP_MAX_PPB)
+		ptp->ppb = PTP_MAX_PPB;
+	else if (ptp->ppb < -PTP_MAX_PPB)
+		ptp->ppb = -PTP_MAX_PPB;
+	ethd_ptp_adjust_freq(ptp->ethd, ptp->ppb);
+
+	printf("offset %d ns, delay %d ns, freq %d ppb\n\r", (int)offset,
+	       (int)ptp->path_delay, (int)ptp->ppb);
+
+	ptp_send_delay_req(ptp);
+}
+
+/**
+ * Check the header of a message, and select the master
+ */
+static bool ptp_check_message(struct _ptp_slave* ptp, const uint8_t* msg, u16_t len)
+{
+	if (len < PTP_HEADER_LEN || (msg[PTP_OFF_VERSION] & 0x0f) != 2 ||
+	    msg[PTP_OFF_DOMAIN] != 0)
+		return false;
+
+	if (!ptp->has_master) {
+		if ((msg[PTP_OFF_TYPE] & 0x0f) != PTP_SYNC)
+			return false;
+		memcpy(ptp->master_id, &msg[PTP_OFF_PORT_ID], PTP_PORT_ID_LEN);
+		ptp->has_master = true;
+		printf("Master %02x%02x%02x.%02x%02x.%02x%02x%02x-%d\n\r",
+		       msg[20], msg[21], msg[22], msg[23], msg[24], msg[25],
+		       msg[26], msg[27], get_be16(&msg[28]));
+	}
+
+	return memcmp(ptp->master_id, &msg[PTP_OFF_PORT_ID], PTP_PORT_ID_LEN) == 0;
+}
+
+/**
+ * Called when a PTP event message has been received
+ */
+static void ptp_event_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+		struct ip_addr *addr, u16_t port)
+{
+	struct _ptp_slave* ptp = (struct _ptp_slave*)arg;
+	uint8_t msg[PTP_SYNC_LEN];
+	struct _eth_timestamp ts;
+	u16_t len;
+
+	len = pbuf_copy_partial(p, msg, sizeof(msg), 0);
+	pbuf_free(p);
+
+	if (!ptp_check_message(ptp, msg, len) ||
+	    (msg[PTP_OFF_TYPE] & 0x0f) != PTP_SYNC || len < PTP_SYNC_LEN)
+		return;
+
+	/* t2, latched by the GMAC when the Sync was received */
+	if (ethd_ptp_get_event(ptp->ethd, ETH_PTP_SYNC_RX, &ts) != ETH_OK)
+		return;
+
+	if (msg[PTP_OFF_FLAGS] & PTP_FLAG_TWO_STEP) {
+		/* t1 is in the Follow_Up */
+		ptp->sync_pending = true;
+		ptp->sync_seq = get_be16(&msg[PTP_OFF_SEQUENCE]);
+		ptp->t2 = timestamp_to_ns(&ts);
+		ptp->sync_correction = get_correction(msg);
+	} else {
+		ptp->sync_pending = false;
+		ptp_sync(ptp, get_timestamp(msg), timestamp_to_ns(&ts),
+			 get_correction(msg));
+	}
+}
+
+/**
+ * Called when a PTP general message has been received
+ */
+static void ptp_general_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+		struct ip_addr *addr, u16_t port)
+{
+	struct _ptp_slave* ptp = (struct _ptp_slave*)arg;
+	uint8_t msg[PTP_DELAY_RESP_LEN];
+	struct _eth_timestamp ts;
+	int64_t t3, t4;
+	u16_t len;
+
+	len = pbuf_copy_partial(p, msg, sizeof(msg), 0);
+	pbuf_free(p);
+
+	if (!ptp_check_message(ptp, msg, len))
+		return;
+
+	switch (msg[PTP_OFF_TYPE] & 0x0f) {
+	case PTP_FOLLOW_UP:
+		if (!ptp->sync_pending || len < PTP_SYNC_LEN ||
+		    get_be16(&msg[PTP_OFF_SEQUENCE]) != ptp->sync_seq)
+			break;
+		ptp->sync_pending = false;
+		ptp_sync(ptp, get_timestamp(msg), ptp->t2,
+			 ptp->sync_correction + get_correction(msg));
+		break;
+
+	case PTP_DELAY_RESP:
+		if (!ptp->delay_pending || len < PTP_DELAY_RESP_LEN ||
+		    get_be16(&msg[PTP_OFF_SEQUENCE]) != ptp->delay_seq ||
+		    memcmp(&msg[PTP_OFF_REQ_PORT_ID], ptp->port_id, PTP_PORT_ID_LEN))
+			break;
+		ptp->delay_pending = false;
+
+		/* t3, latched by the GMAC when the Delay_Req was sent */
+		if (ethd_ptp_get_event(ptp->ethd, ETH_PTP_DELAY_REQ_TX, &ts) != ETH_OK)
+			break;
+		t3 = timestamp_to_ns(&ts);
+		t4 = get_timestamp(msg) - get_correction(msg);
+
+		ptp->path_delay = (ptp->ms_delay + (t4 - t3)) / 2;
+		ptp->has_path_delay = true;
+		break;
+	}
+}
+
+/**
+ * Start the PTP slave on the given interface
+ */
+static err_t ptp_init(struct _ptp_slave* ptp, struct netif* netif, struct _ethd* ethd)
+{
+	struct ip_addr group;
+	uint8_t* mac = netif->hwaddr;
+
+	memset(ptp, 0, sizeof(*ptp));
+	ptp->netif = netif;
+	ptp->ethd = ethd;
+
+	/* Clock identity derived from the MAC address (EUI-64), port 1 */
+	ptp->port_id[0] = mac[0];
+	ptp->port_id[1] = mac[1];
+	ptp->port_id[2] = mac[2];
+	ptp->port_id[3] = 0xff;
+	ptp->port_id[4] = 0xfe;
+	ptp->port_id[5] = mac[3];
+	ptp->port_id[6] = mac[4];
+	ptp->port_id[7] = mac[5];
+	put_be16(&ptp->port_id[8], 1);
+
+	/* Start the IEEE 1588 timer and the timestamping */
+	if (ethd_set_offload(ethd, ethd_get_offload(ethd) | ETH_OFFLOAD_PTP) != ETH_OK) {
+		printf("E: PTP not supported by the interface\n\r");
+		return ERR_IF;
+	}
+
+	IP4_ADDR(&group, _ptp_group[0], _ptp_group[1], _ptp_group[2], _ptp_group[3]);
+	if (igmp_joingroup(&netif->ip_addr, &group) != ERR_OK) {
+		printf("E: igmp_joingroup\n\r");
+		return ERR_IF;
+	}
+
+	ptp->event_pcb = udp_new();
+	ptp->general_pcb = udp_new();
+	if (ptp->event_pcb == NULL || ptp->general_pcb == NULL) {
+		printf("E: udp_new\n\r");
+		return ERR_MEM;
+	}
+	if (udp_bind(ptp->event_pcb, IP_ADDR_ANY, PTP_EVENT_PORT) != ERR_OK ||
+	    udp_bind(ptp->general_pcb, IP_ADDR_ANY, PTP_GENERAL_PORT) != ERR_OK) {
+		printf("E: udp_bind\n\r");
+		return ERR_USE;
+	}
+	udp_recv(ptp->event_pcb, ptp_event_recv, ptp);
+	udp_recv(ptp->general_pcb, ptp_general_recv, ptp);
+
+	return ERR_OK;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ *  \brief eth_lwip_ptp example entry point.
+ *
+ *  \return Unused (ANSI-C compatibility).
+ */
+int main(void)
+{
+	struct ip_addr ipaddr, netmask, gw;
+	struct netif NetIf, *netif;
+	uint8_t eth_port = 0;
+
+	/* Output example information */
+	console_example_info("ETH lwIP PTP Slave Example");
+
+	/* User select the port number for multiple eth */
+	eth_port = select_eth_port();
+	ethd_get_mac_addr(board_get_eth(eth_port), 0, _mac_addr);
+
+	/* Display MAC & IP settings */
+	printf(" - MAC%d %02x:%02x:%02x:%02x:%02x:%02x\n\r", eth_port,
+	       _mac_addr[0], _mac_addr[1], _mac_addr[2],
+	       _mac_addr[3], _mac_addr[4], _mac_addr[5]);
+	printf(" - Host IP  %d.%d.%d.%d\n\r", _ip_addr[0], _ip_addr[1], _ip_addr[2], _ip_addr[3]);
+
+	/* Initialize lwIP modules */
+	lwip_init();
+
+	IP4_ADDR(&gw, _gw_ip_addr[0], _gw_ip_addr[1], _gw_ip_addr[2], _gw_ip_addr[3]);
+	IP4_ADDR(&ipaddr, _ip_addr[0], _ip_addr[1], _ip_addr[2], _ip_addr[3]);
+	IP4_ADDR(&netmask, _netmask[0], _netmask[1], _netmask[2], _netmask[3]);
+
+	netif = netif_add(&NetIf, &ipaddr, &netmask, &gw, NULL, ethif_init, ip_input);
+	netif_set_default(netif);
+	netif_set_up(netif);
+
+	/* Initialize the PTP slave */
+	if (ptp_init(&_ptp, netif, board_get_eth(eth_port)) != ERR_OK)
+		return -1;
+	printf("Waiting for a PTP master...\n\r");
+
+	while (1) {
+		/* Run polling tasks */
+		ethif_poll(netif);
+	}
+}
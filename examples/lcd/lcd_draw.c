@@ -42,7 +42,10 @@
 
 #include "board.h"
 #include "compiler.h"
+#include "intmath.h"
 
+#include "dma/dma.h"
+#include "misc/cache.h"
 #include "peripherals/lcdc.h"
 
 #include "lcd_draw.h"
@@ -53,6 +56,14 @@
 #include <stdlib.h>
 #include <assert.h>
 
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** Rows copied per DMA transfer by lcd_draw_image(). On DMAC each row takes
+ * one item of the pool of DMA_LL_POOL_SIZE items shared by all channels. */
+#define BLIT_DMA_ROWS 32
+
 /*----------------------------------------------------------------------------
  *        Local variable
  *----------------------------------------------------------------------------*/
@@ -60,10 +71,56 @@
 /** Front color cache */
 static uint32_t front_color;
 
+/** DMA channel used for image blits */
+static struct dma_channel *blit_channel;
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
 
+/**
+ * Copy a rectangle of height rows of len bytes with 2D DMA transfers of at
+ * most BLIT_DMA_ROWS rows.
+ * \return the number of rows copied, the remaining ones have to be copied by
+ * the CPU
+ */
+static uint32_t _blit_dma(uint8_t *dst, const uint8_t *src, uint32_t len,
+			  uint32_t height, uint32_t src_stride, uint32_t dst_stride)
+{
+	struct dma_xfer_2d_cfg cfg;
+	uint32_t align = (uint32_t)dst | (uint32_t)src | len | src_stride | dst_stride;
+	uint32_t row;
+
+	if (height == 0 || len == 0)
+		return height;
+	if (!blit_channel)
+		blit_channel = dma_allocate_channel(DMA_PERIPH_MEMORY, DMA_PERIPH_MEMORY);
+	if (!blit_channel)
+		return 0;
+
+	cfg.data_width = (align & 3) ? DMA_DATA_WIDTH_BYTE : DMA_DATA_WIDTH_WORD;
+	cfg.chunk_size = DMA_CHUNK_SIZE_1;
+	cfg.width = len / DMA_DATA_WIDTH_IN_BYTE(cfg.data_width);
+	cfg.src_stride = src_stride;
+	cfg.dst_stride = dst_stride;
+
+	/* The last row ends after len bytes, not at the next stride */
+	cache_clean_region(src, (height - 1) * src_stride + len);
+	cache_clean_region(dst, (height - 1) * dst_stride + len);
+	for (row = 0; row < height; row += cfg.height) {
+		cfg.sa = src + row * src_stride;
+		cfg.da = dst + row * dst_stride;
+		cfg.height = min_u32(height - row, BLIT_DMA_ROWS);
+		if (dma_configure_2d_transfer(blit_channel, &cfg) != DMA_OK)
+			break;
+		dma_start_transfer(blit_channel);
+		while (!dma_is_transfer_done(blit_channel))
+			dma_poll();
+	}
+	cache_invalidate_region(dst, (height - 1) * dst_stride + len);
+	return row;
+}
+
 /**
  * Hide canvas layer
  */
@@ -667,7 +724,11 @@ void lcd_draw_image(uint32_t dwX, uint32_t dwY, const uint8_t * pImage,
 	pDst = pDisp->buffer;
 	pDst = &pDst[dwX * cw + dwY * rl];
 
-	for (i = 0; i < height; i++) {
+	i = _blit_dma(pDst, pSrc, rws, height, rls, rl);
+	pSrc = &pSrc[i * rls];
+	pDst = &pDst[i * rl];
+
+	for (; i < height; i++) {
 		memcpy(pDst, pSrc, rws);
 		pSrc = &pSrc[rls];
 		pDst = &pDst[rl];
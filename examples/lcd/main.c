@@ -99,6 +99,8 @@
 #include "peripherals/pmc.h"
 #include "gpio/pio.h"
 
+#include "dma/dma.h"
+
 #include "misc/cache.h"
 #include "misc/console.h"
 #include "misc/led.h"
@@ -164,6 +166,11 @@
 /** Height for HEO */
 #define HEO_H       (BOARD_LCD_HEIGHT * 2 /3)
 
+/** Width of the image drawn on OVR1 */
+#define IMG_W       64
+/** Height of the image drawn on OVR1 */
+#define IMG_H       96
+
 /** Number of blocks in vertical */
 #define N_BLK_VERT    4
 /** Number of blocks in horizontal */
@@ -188,6 +195,9 @@ CACHE_ALIGNED_DDR static uint8_t _ovr2_buffer[SIZE_LCD_BUFFER_OVR2];
 /** High End Overlay buffer */
 CACHE_ALIGNED_DDR static uint8_t _heo_buffer[SIZE_LCD_BUFFER_HEO];
 
+/** Gradient image copied to OVR1 by lcd_draw_image() */
+CACHE_ALIGNED_DDR static uint8_t _image[IMG_W * IMG_H * 3];
+
 /** Test pattern source */
 static uint32_t test_colors[N_BLK_HOR*N_BLK_VERT] = {
     COLOR_BLACK,  COLOR_Aqua,  COLOR_BLUE,  COLOR_Fuchsia,  COLOR_GRAY,  COLOR_GREEN,
@@ -284,6 +294,23 @@ static void test_pattern_24RGB (uint8_t *lcd_base)
 	}
 }
 
+/**
+ * Fill the OVR1 image with a 24-bit gradient
+ */
+static void _build_image(void)
+{
+	uint16_t x, y;
+	uint8_t *pix = _image;
+
+	for (y = 0; y < IMG_H; y++) {
+		for (x = 0; x < IMG_W; x++) {
+			*pix++ = 255 * x / (IMG_W - 1);
+			*pix++ = 255 * y / (IMG_H - 1);
+			*pix++ = 0xFF;
+		}
+	}
+}
+
 /**
  * Turn ON LCD, show base .
  */
@@ -350,6 +377,8 @@ static void _LcdOn(void)
 	lcdc_create_canvas(LCDC_OVR1, _ovr1_buffer, 24, SCR_X(wOvr1X),
 			   SCR_Y(wOvr1Y), wOvr1W, wOvr1H);
 	lcd_fill(OVR1_BG);
+	_build_image();
+	lcd_draw_image(0, 0, _image, IMG_W, IMG_H);
 	cache_clean_region(_ovr1_buffer, sizeof(_ovr1_buffer));
 
 	printf("- LCD ON\n\r");
@@ -646,6 +675,9 @@ extern int main(void)
 	/* Output example information */
 	console_example_info("LCD Example");
 
+	/* Used by lcd_draw_image() */
+	dma_initialize(false);
+
 	/* Configure LCD */
 	_LcdOn();
 
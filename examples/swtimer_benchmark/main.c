@@ -0,0 +1,224 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \page swtimer_benchmark Software Timer Benchmark Example
+ *
+ *  \section Purpose
+ *
+ *  This example measures the cost of the software timer wheel (swtimer.h)
+ *  with 10000 active timers.
+ *
+ *  \section Requirements
+ *
+ *  This package can be used with SAMA5 and SAM9XX5.
+ *
+ *  \section Description
+ *
+ *  NUM_TIMERS timers are armed with pseudo-random delays of up to MAX_DELAY
+ *  ticks. The wheel is then advanced tick by tick until all of them have
+ *  expired, checking that every callback ran once, on its deadline. The
+ *  time of each operation is measured with timer_get_timestamp().
+ *
+ *  \section Usage
+ *
+ *  -# Build the program and download it inside the evaluation board.
+ *  -# On the computer, open and configure a terminal application
+ *     (e.g. HyperTerminal on Microsoft Windows) with these settings:
+ *    - 115200 bauds
+ *    - 8 bits of data
+ *    - No parity
+ *    - 1 stop bit
+ *    - No flow control
+ *  -# Start the application. The average cost of arm, re-arm and cancel
+ *     operations, and the average and worst cost of a tick are printed.
+ *
+ *  \section References
+ *  - swtimer_benchmark/main.c
+ *  - swtimer.h
+ */
+
+/** \file
+ *
+ *  This file contains all the specific code for the software timer benchmark
+ *  example.
+ *
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "board.h"
+#include "chip.h"
+#include "trace.h"
+#include "compiler.h"
+#include "rand.h"
+#include "swtimer.h"
+#include "timer.h"
+
+#include "misc/console.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** Number of active timers */
+#define NUM_TIMERS 10000
+
+/** Longest delay (in ticks) */
+#define MAX_DELAY 100000
+
+/*----------------------------------------------------------------------------
+ *        Local types
+ *----------------------------------------------------------------------------*/
+
+struct _bench_timer {
+	struct _swtimer timer;
+	uint64_t deadline;
+	uint32_t fired;
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct _bench_timer timers[NUM_TIMERS];
+
+static uint64_t current_tick;
+static uint32_t late;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static int _timer_expired(void* arg)
+{
+	struct _bench_timer* t = (struct _bench_timer*)arg;
+
+	t->fired++;
+	if (t->deadline != current_tick)
+		late++;
+	return 0;
+}
+
+static uint32_t _elapsed_ns(uint64_t start)
+{
+	return (uint32_t)timer_timestamp_to_ns(timer_get_timestamp() - start);
+}
+
+static void _arm_all(const char* name)
+{
+	uint64_t start;
+	int i;
+
+	start = timer_get_timestamp();
+	for (i = 0; i < NUM_TIMERS; i++) {
+		uint32_t delay = 1 + (rand() % MAX_DELAY);
+		uint64_t now = current_tick;
+
+		timers[i].deadline = now + delay;
+		swtimer_arm(&timers[i].timer, delay);
+	}
+	printf("%-8s %6u ns/timer\r\n", name,
+	       (unsigned)(_elapsed_ns(start) / NUM_TIMERS));
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ *  \brief Software timer benchmark entry point.
+ *
+ *  \return Unused (ANSI-C compatibility).
+ */
+int main(void)
+{
+	uint64_t start, worst = 0, total;
+	uint32_t fired = 0;
+	int i;
+
+	/* Output example information */
+	console_example_info("Software Timer Benchmark Example");
+
+	srand(0);
+	for (i = 0; i < NUM_TIMERS; i++)
+		swtimer_init(&timers[i].timer, _timer_expired, &timers[i]);
+
+	/* drive the wheel with a synthetic clock, far enough ahead of the
+	 * system tick for the latter never to catch up */
+	current_tick = timer_get_tick() + (1ull << 32);
+	swtimer_advance(current_tick);
+
+	/* arm, then re-arm the timers while pending */
+	_arm_all("arm");
+	_arm_all("re-arm");
+
+	/* cancel all, then arm them again */
+	start = timer_get_timestamp();
+	for (i = 0; i < NUM_TIMERS; i++)
+		swtimer_cancel(&timers[i].timer);
+	printf("%-8s %6u ns/timer\r\n", "cancel",
+	       (unsigned)(_elapsed_ns(start) / NUM_TIMERS));
+	_arm_all("arm");
+
+	/* run all timers tick by tick */
+	total = timer_get_timestamp();
+	for (i = 0; i < MAX_DELAY; i++) {
+		uint64_t elapsed;
+
+		current_tick++;
+		start = timer_get_timestamp();
+		fired += swtimer_advance(current_tick);
+		elapsed = timer_get_timestamp() - start;
+		if (elapsed > worst)
+			worst = elapsed;
+	}
+	total = timer_get_timestamp() - total;
+
+	printf("tick     %6u ns average, %u ns worst\r\n",
+	       (unsigned)(timer_timestamp_to_ns(total) / MAX_DELAY),
+	       (unsigned)timer_timestamp_to_ns(worst));
+
+	for (i = 0; i < NUM_TIMERS; i++)
+		if (timers[i].fired != 1 || swtimer_is_pending(&timers[i].timer))
+			break;
+	if (i == NUM_TIMERS && fired == NUM_TIMERS && !late)
+		printf("All %u timers expired once, on time\r\n",
+		       (unsigned)NUM_TIMERS);
+	else
+		printf("Error: %u callbacks, %u late\r\n",
+		       (unsigned)fired, (unsigned)late);
+
+	while (1);
+}
@@ -30,6 +30,8 @@
 #ifndef _CC_H
 #define _CC_H
 
+#include "chksum.h"
+
 /* Define platform endianness */
 #define BYTE_ORDER LITTLE_ENDIAN
 
@@ -77,6 +79,9 @@ typedef u32_t mem_ptr_t;
     #error "This compiler does not support."
 #endif
 
+/* Use the optimized Internet checksum */
+#define LWIP_CHKSUM chksum_compute
+
 /* No assert */
 #define LWIP_NOASSERT
 
@@ -66,7 +66,9 @@
  * MEM_SIZE: the size of the heap memory. If the application will send
  * a lot of data that needs to be copied, this should be set high.
  */
+#ifndef MEM_SIZE
 #define MEM_SIZE                        1600
+#endif
 
 /**
  * MEMP_OVERFLOW_CHECK: memp overflow protection reserves a configurable
@@ -94,8 +96,11 @@
  * MEMP_NUM_PBUF: the number of memp struct pbufs (used for PBUF_ROM and PBUF_REF).
  * If the application sends a lot of data out of ROM (or other static memory),
  * this should be set high.
+ * With ETHIF_ZERO_COPY, each RX buffer of a received frame uses one of them.
  */
-#define MEMP_NUM_PBUF                   4
+#ifndef MEMP_NUM_PBUF
+#define MEMP_NUM_PBUF                   32
+#endif
 
 /**
  * MEMP_NUM_RAW_PCB: Number of raw connection PCBs
@@ -126,7 +131,9 @@
  * MEMP_NUM_TCP_SEG: the number of simultaneously queued TCP segments.
  * (requires the LWIP_TCP option)
  */
+#ifndef MEMP_NUM_TCP_SEG
 #define MEMP_NUM_TCP_SEG                5
+#endif
 
 /**
  * MEMP_NUM_SYS_TIMEOUT: the number of simulateously active timeouts.
@@ -148,10 +155,59 @@
 /**
  * PBUF_POOL_SIZE: the number of buffers in the pbuf pool.
  */
+#ifndef PBUF_POOL_SIZE
 #define PBUF_POOL_SIZE                  6
+#endif
 
 /* PBUF_POOL_BUFSIZE: the size of each pbuf in the pbuf pool. */
+#ifndef PBUF_POOL_BUFSIZE
 #define PBUF_POOL_BUFSIZE               256
+#endif
+
+/*
+   -----------------------------------
+   ---------- Netif options ----------
+   -----------------------------------
+*/
+/**
+ * ETHIF_ZERO_COPY==1: Received TCP segments are passed to the stack as
+ * PBUF_REF pbufs pointing to the ETH RX buffers. Other frames are still
+ * copied, since lwIP modifies them in place. With the 128-byte RX buffers of
+ * the EMAC, a segment would use a dozen PBUF_REF pbufs, so it is enabled by
+ * default only on devices with GMAC interfaces only, whose RX buffers hold a
+ * whole frame.
+ */
+#ifndef ETHIF_ZERO_COPY
+#if defined(CONFIG_HAVE_GMAC) && !defined(CONFIG_HAVE_EMAC)
+#define ETHIF_ZERO_COPY                 1
+#else
+#define ETHIF_ZERO_COPY                 0
+#endif
+#endif
+
+/**
+ * ETHIF_ZERO_COPY_TX==1 (requires ETHIF_ZERO_COPY): Sent pbufs other than
+ * TCP segments are given to the ETH driver without being copied. lwIP has no
+ * way to know when the MAC is done with a pbuf: the application must not
+ * modify the pbufs it sends (e.g. with udp_send()) until they are freed.
+ */
+#ifndef ETHIF_ZERO_COPY_TX
+#define ETHIF_ZERO_COPY_TX              0
+#endif
+
+/**
+ * ETHIF_CHECKSUM_OFFLOAD==1: IP/TCP/UDP checksums are generated and IP/TCP
+ * checksums are verified by the MAC instead of lwIP. All the interfaces must
+ * support it, so it is enabled by default only on devices with GMAC
+ * interfaces only, except SAMA5D4 whose GMAC cannot generate checksums.
+ */
+#ifndef ETHIF_CHECKSUM_OFFLOAD
+#if defined(CONFIG_HAVE_GMAC) && !defined(CONFIG_HAVE_EMAC) && !defined(CONFIG_SOC_SAMA5D4)
+#define ETHIF_CHECKSUM_OFFLOAD          1
+#else
+#define ETHIF_CHECKSUM_OFFLOAD          0
+#endif
+#endif
 
 /*
    ---------------------------------
@@ -284,7 +340,9 @@
 /**
  * LWIP_UDP==1: Turn on UDP.
  */
+#ifndef LWIP_UDP
 #define LWIP_UDP                        0
+#endif
 
 /*
    ---------------------------------
@@ -301,7 +359,9 @@
  * TCP_WND: The size of a TCP window.  This must be at least
  * (2 * TCP_MSS) for things to work well
  */
+#ifndef TCP_WND
 #define TCP_WND                         1024
+#endif
 
 /**
  * TCP_SYNMAXRTX: Maximum number of retransmissions of SYN segments.
@@ -321,12 +381,16 @@
  * when opening a connection. For the transmit size, this MSS sets
  * an upper limit on the MSS advertised by the remote host.
  */
+#ifndef TCP_MSS
 #define TCP_MSS                         128
+#endif
 
 /**
  * TCP_SND_BUF: TCP sender buffer space (bytes).
  */
+#ifndef TCP_SND_BUF
 #define TCP_SND_BUF                     1536
+#endif
 
 /**
  * TCP_SND_QUEUELEN: TCP sender buffer space (pbufs). This must be at least
@@ -366,6 +430,21 @@
 #define LWIP_SOCKET                     0
 
 
+/*
+   --------------------------------------
+   ---------- Checksum options ----------
+   --------------------------------------
+*/
+#if ETHIF_CHECKSUM_OFFLOAD
+#define CHECKSUM_GEN_IP                 0
+#define CHECKSUM_GEN_UDP                0
+#define CHECKSUM_GEN_TCP                0
+#define CHECKSUM_CHECK_IP               0
+/* the MAC does not verify IP fragments, which are mostly UDP */
+#define CHECKSUM_CHECK_UDP              1
+#define CHECKSUM_CHECK_TCP              0
+#endif
+
 /*
    ----------------------------------------
    ---------- Statistics options ----------
@@ -55,10 +55,13 @@
 #include "lwip/pbuf.h"
 #include "lwip/sys.h"
 #include "lwip/stats.h"
+#include "lwip/inet_chksum.h"
 #include "netif/etharp.h"
 
+#include "ring.h"
 #include "timer.h"
 #include "lwip/tcp.h"
+#include "lwip/igmp.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -71,6 +74,48 @@
 #define IFNAME0 'e'
 #define IFNAME1 'n'
 
+/* Number of RX queues polled, the highest queue first. Frames are steered
+ * to queues 1 and above by the screeners installed with
+ * ethd_add_screener() */
+#ifndef ETHIF_RX_QUEUES
+#ifdef CONFIG_GMAC_PRIO_QUEUES
+#define ETHIF_RX_QUEUES ETH_NUM_QUEUES
+#else
+#define ETHIF_RX_QUEUES 1
+#endif
+#endif
+
+#if LWIP_SNMP
+/* Period in ms of the MIB-II interface counters update */
+#ifndef ETHIF_SNMP_PERIOD
+#define ETHIF_SNMP_PERIOD 1000
+#endif
+#endif
+
+#if ETHIF_ZERO_COPY
+
+/* Maximum number of RX buffers of a received frame */
+#define ETHIF_RX_SG_SIZE \
+	((ETH_MAX_FRAME_LENGTH + ETH_RX_UNITSIZE - 1) / ETH_RX_UNITSIZE)
+
+/* Maximum number of pbufs of a frame sent without copy */
+#define ETHIF_TX_SG_SIZE 8
+
+/* Number of received frames that can be held by the stack */
+#ifndef ETHIF_RX_FRAMES
+#define ETHIF_RX_FRAMES 8
+#endif
+
+#if ETHIF_ZERO_COPY_TX
+/* Number of pbufs sent without copy and not freed yet, frames are copied
+ * beyond */
+#ifndef ETHIF_TX_PBUFS
+#define ETHIF_TX_PBUFS 32
+#endif
+#endif
+
+#endif /* ETHIF_ZERO_COPY */
+
 /*----------------------------------------------------------------------------
  *        Types
  *----------------------------------------------------------------------------*/
@@ -82,6 +127,16 @@ typedef struct _timers_info {
 	void (*timer_func)(void);
 } timers_info;
 
+#if ETHIF_ZERO_COPY
+/* Received frame lent by the ETH driver to the stack */
+struct _ethif_rx_frame {
+	struct pbuf*        p;
+	struct netif*       netif;
+	uint8_t             queue;
+	struct _eth_rx_loan loan;
+};
+#endif
+
 /*---------------------------------------------------------------------------
  *         Variables
  *---------------------------------------------------------------------------*/
@@ -97,9 +152,28 @@ static timers_info timers_table[] = {
 #if LWIP_DHCP
 	{ 0, DHCP_COARSE_TIMER_SECS, dhcp_coarse_tmr},
 	{ 0, DHCP_FINE_TIMER_MSECS,  dhcp_fine_tmr},
+#endif
+	/* LWIP_IGMP */
+#if LWIP_IGMP
+	{ 0, IGMP_TMR_INTERVAL,      igmp_tmr},
 #endif
 };
 
+#if ETHIF_ZERO_COPY
+/* Received frames wrapped into PBUF_REF pbufs */
+static struct _ethif_rx_frame rx_frames[ETHIF_RX_FRAMES];
+
+#if ETHIF_ZERO_COPY_TX
+/* Sent pbufs to free, filled from the TX completion interrupt. The ring
+ * holds at most ETHIF_TX_PBUFS - 1 entries, tx_pbufs_pending ensures no
+ * more pbufs are in flight. */
+static struct pbuf* tx_pbufs[ETHIF_TX_PBUFS];
+static volatile uint16_t tx_pbufs_head;
+static volatile uint16_t tx_pbufs_tail;
+static uint16_t tx_pbufs_pending;
+#endif
+#endif
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -135,8 +209,51 @@ static void timers_update(void)
 	}
 }
 
+#if LWIP_SNMP
+/**
+ * Update the MIB-II interface counters of the netif from the MAC and driver
+ * statistics
+ */
+static void ethif_update_snmp(struct netif *netif, struct _ethd* ethd)
+{
+	static uint64_t last_update;
+	struct _eth_stats stats;
+	uint32_t nucast, drops;
+	int i;
+
+	if (timer_get_interval(last_update, timer_get_tick()) < ETHIF_SNMP_PERIOD)
+		return;
+	last_update = timer_get_tick();
+
+	/* The driver counters are cumulative, MIB-II counters wrap at 32 bits */
+	ethd_get_stats(ethd, &stats);
+
+	nucast = stats.mac.rx_broadcast + stats.mac.rx_multicast;
+	netif->ifinoctets = (uint32_t)stats.mac.rx_octets;
+	netif->ifinnucastpkts = nucast;
+	netif->ifinucastpkts = stats.mac.rx_frames - nucast;
+
+	nucast = stats.mac.tx_broadcast + stats.mac.tx_multicast;
+	netif->ifoutoctets = (uint32_t)stats.mac.tx_octets;
+	netif->ifoutnucastpkts = nucast;
+	netif->ifoutucastpkts = stats.mac.tx_frames - nucast;
+
+	drops = stats.mac.rx_resource_errors + stats.mac.rx_overruns;
+	for (i = 0; i < ETH_NUM_QUEUES; i++)
+		drops += stats.queues[i].rx_fragments
+		       + stats.queues[i].rx_no_eof
+		       + stats.queues[i].rx_too_small;
+	netif->ifindiscards = drops;
+
+	drops = 0;
+	for (i = 0; i < ETH_NUM_QUEUES; i++)
+		drops += stats.queues[i].tx_busy + stats.queues[i].tx_errors;
+	netif->ifoutdiscards = drops;
+}
+#endif /* LWIP_SNMP */
+
 /* Forward declarations. */
-static void  ethif_input(struct netif *netif);
+static u8_t  ethif_input(struct netif *netif, uint8_t queue);
 static err_t ethif_output(struct netif *netif, struct pbuf *p, struct ip_addr *ipaddr);
 
 static void glow_level_init(struct netif *netif, struct _ethd* ethd)
@@ -153,19 +270,22 @@ static void glow_level_init(struct netif *netif, struct _ethd* ethd)
 
 	/* device capabilities */
 	netif->flags = NETIF_FLAG_BROADCAST;
+#if LWIP_IGMP
+	netif->flags |= NETIF_FLAG_IGMP;
+#endif
 }
 
 /**
  * This function should do the actual transmission of the packet. The packet is
  * contained in the pbuf that is passed to the function. This pbuf
- * might be chained.
+ * might be chained. The packet is copied into a single buffer.
  *
  * @param netif the lwip network interface structure for this ethif
  * @param p the MAC packet to send (e.g. IP packet including MAC addresses and type)
  * @return ERR_OK if the packet could be sent
  *         an err_t value if the packet couldn't be sent
  */
-static err_t glow_level_output(struct netif *netif, struct pbuf *p)
+static err_t glow_level_output_copy(struct netif *netif, struct pbuf *p)
 {
     struct pbuf *q;
     uint8_t buf[1514];
@@ -199,15 +319,18 @@ static err_t glow_level_output(struct netif *netif, struct pbuf *p)
     return ERR_OK;
 }
 
+#if !ETHIF_ZERO_COPY
 /**
  * Should allocate a pbuf and transfer the bytes of the incoming
  * packet from the interface into the pbuf.
  *
  * @param netif the lwip network interface structure for this ethif
+ * @param queue the RX queue to read from
+ * @param csum checksums verified by the MAC (ETH_RX_CSUM_*)
  * @return a pbuf filled with the received packet (including MAC header)
  *         NULL on memory error
  */
-static struct pbuf *glow_level_input(struct netif *netif)
+static struct pbuf *glow_level_input_copy(struct netif *netif, uint8_t queue, uint8_t *csum)
 {
     struct pbuf *p, *q;
     u16_t len;
@@ -219,12 +342,13 @@ static struct pbuf *glow_level_input(struct netif *netif)
 
     /* Obtain the size of the packet and put it into the "len"
        variable. */
-    rc = ethd_poll(board_get_eth(netif->num), 0, buf, (uint32_t)sizeof(buf), (uint32_t*)&frmlen);
+    rc = ethd_poll(board_get_eth(netif->num), queue, buf, (uint32_t)sizeof(buf), (uint32_t*)&frmlen);
     if (rc != ETH_OK)
     {
       return NULL;
     }
     len = frmlen;
+    *csum = ethd_get_rx_csum(board_get_eth(netif->num), queue);
 
 #if ETH_PAD_SIZE
     len += ETH_PAD_SIZE;      /* allow room for Ethernet padding */
@@ -260,6 +384,310 @@ static struct pbuf *glow_level_input(struct netif *netif)
     }
     return p;
 }
+#endif /* !ETHIF_ZERO_COPY */
+
+#if ETHIF_ZERO_COPY
+
+/**
+ * Tell if a frame must be given to the stack in a PBUF_POOL pbuf: lwIP 1.3.2
+ * cannot move the payload pointer of a PBUF_REF pbuf before its initial
+ * position, which it does to reply to ICMP echo requests and to send ICMP
+ * port unreachable errors in response to UDP packets. Only the unfragmented
+ * TCP segments are thus passed without copy.
+ *
+ * @param p the first pbuf of the frame, the Ethernet header (with its
+ *          padding word) is at p->payload
+ * @return 1 if the frame must be copied, 0 otherwise
+ */
+static u8_t _ethif_rx_needs_copy(struct pbuf *p)
+{
+	const struct eth_hdr *ethhdr = p->payload;
+	const struct ip_hdr *iphdr;
+
+	if (htons(ethhdr->type) != ETHTYPE_IP)
+		return 0;
+	if (p->len < sizeof(struct eth_hdr) + IP_HLEN)
+		return 1;
+	iphdr = (const struct ip_hdr *)((const u8_t *)p->payload + sizeof(struct eth_hdr));
+	if (IPH_PROTO(iphdr) != IP_PROTO_TCP)
+		return 1;
+	/* fragments are kept by the reassembly code */
+	return (IPH_OFFSET(iphdr) & htons(IP_MF | IP_OFFMASK)) != 0;
+}
+
+#if ETHIF_ZERO_COPY_TX
+/**
+ * Called by the ETH driver, from interrupt context, once a frame sent
+ * without copy has been released. The pbuf is freed later by ethif_poll().
+ */
+static void _ethif_tx_release(uint8_t queue, uint32_t status, void* arg)
+{
+	tx_pbufs[tx_pbufs_head] = (struct pbuf*)arg;
+	RING_INC(tx_pbufs_head, ETHIF_TX_PBUFS);
+}
+#endif
+
+/**
+ * Free the pbufs sent without copy, and give back to the ETH driver the
+ * received frames the stack does not reference anymore.
+ */
+static void _ethif_free_pbufs(void)
+{
+	struct _ethif_rx_frame* frame;
+	int i;
+
+#if ETHIF_ZERO_COPY_TX
+	while (!RING_EMPTY(tx_pbufs_head, tx_pbufs_tail)) {
+		pbuf_free(tx_pbufs[tx_pbufs_tail]);
+		RING_INC(tx_pbufs_tail, ETHIF_TX_PBUFS);
+		tx_pbufs_pending--;
+	}
+#endif
+
+	for (i = 0; i < ETHIF_RX_FRAMES; i++) {
+		frame = &rx_frames[i];
+		/* Only the reference taken by glow_level_input() remains */
+		if (frame->p && frame->p->ref == 1) {
+			pbuf_free(frame->p);
+			frame->p = NULL;
+			ethd_rx_return(board_get_eth(frame->netif->num), frame->queue, &frame->loan);
+		}
+	}
+}
+
+#if ETHIF_ZERO_COPY_TX
+/**
+ * Tell if a frame can be sent without copy. lwIP 1.3.2 rewrites the headers
+ * of queued TCP segments when it (re)transmits them, possibly while the MAC
+ * is still reading a previous transmission: TCP segments are always copied.
+ *
+ * @param p the MAC packet to send
+ * @return 1 if the frame can be sent without copy, 0 otherwise
+ */
+static u8_t _ethif_tx_zero_copy(struct pbuf *p)
+{
+	const struct eth_hdr *ethhdr = p->payload;
+	const struct ip_hdr *iphdr;
+
+	if (tx_pbufs_pending >= ETHIF_TX_PBUFS - 1)
+		return 0;
+	if (htons(ethhdr->type) != ETHTYPE_IP)
+		return 1;
+	if (p->len < sizeof(struct eth_hdr) + IP_HLEN)
+		return 0;
+	iphdr = (const struct ip_hdr *)((const u8_t *)p->payload + sizeof(struct eth_hdr));
+	return IPH_PROTO(iphdr) != IP_PROTO_TCP;
+}
+
+/**
+ * This function should do the actual transmission of the packet. Each pbuf
+ * of the chain is mapped onto one TX descriptor, and a reference on the
+ * chain is kept until the ETH driver has sent it.
+ *
+ * @param netif the lwip network interface structure for this ethif
+ * @param p the MAC packet to send (e.g. IP packet including MAC addresses and type)
+ * @return ERR_OK if the packet could be sent
+ *         an err_t value if the packet couldn't be sent
+ */
+static err_t glow_level_output(struct netif *netif, struct pbuf *p)
+{
+	struct _eth_sg sg[ETHIF_TX_SG_SIZE];
+	struct _eth_sg_list sgl;
+	struct pbuf *q;
+	uint32_t i = 0;
+	uint8_t rc;
+
+	if (!_ethif_tx_zero_copy(p))
+		return glow_level_output_copy(netif, p);
+
+	for (q = p; q != NULL && i < ARRAY_SIZE(sg); q = q->next) {
+		uint8_t* payload = q->payload;
+		uint16_t len = q->len;
+#if ETH_PAD_SIZE
+		/* skip the padding word */
+		if (q == p) {
+			payload += ETH_PAD_SIZE;
+			len -= ETH_PAD_SIZE;
+		}
+#endif
+		if (len == 0)
+			continue;
+		sg[i].buffer = payload;
+		sg[i].size = len;
+		sg[i].next = NULL;
+		if (i > 0)
+			sg[i - 1].next = &sg[i];
+		i++;
+	}
+
+	if (q == NULL) {
+		sgl.size = i;
+		sgl.entries = sg;
+
+		pbuf_ref(p);
+		rc = ethd_send_sg_zero_copy(board_get_eth(netif->num), 0, &sgl,
+				_ethif_tx_release, p);
+		if (rc == ETH_OK) {
+			tx_pbufs_pending++;
+			LINK_STATS_INC(link.xmit);
+			return ERR_OK;
+		}
+		pbuf_free(p);
+		if (rc == ETH_TX_BUSY)
+			return ERR_BUF;
+	}
+
+	/* Chain too long for the TX queue, send a copy */
+	return glow_level_output_copy(netif, p);
+}
+#else /* !ETHIF_ZERO_COPY_TX */
+
+static err_t glow_level_output(struct netif *netif, struct pbuf *p)
+{
+	return glow_level_output_copy(netif, p);
+}
+
+#endif /* ETHIF_ZERO_COPY_TX */
+
+/**
+ * Wrap the RX buffers of the incoming packet into a chain of PBUF_REF pbufs.
+ * The buffers are given back to the ETH driver by ethif_poll() once the
+ * stack has freed the chain. Frames lwIP may modify in place are copied
+ * into a PBUF_POOL chain (see _ethif_rx_needs_copy()).
+ *
+ * @param netif the lwip network interface structure for this ethif
+ * @param queue the RX queue to read from
+ * @param csum checksums verified by the MAC (ETH_RX_CSUM_*)
+ * @return a pbuf chain mapping the received packet (including MAC header)
+ *         NULL on memory error
+ */
+static struct pbuf *glow_level_input(struct netif *netif, uint8_t queue, uint8_t *csum)
+{
+	struct _ethd* ethd = board_get_eth(netif->num);
+	struct _ethif_rx_frame* frame = NULL;
+	struct _eth_sg sg[ETHIF_RX_SG_SIZE];
+	struct pbuf *p = NULL, *q;
+	uint32_t i;
+
+	/* Leave the packet in the RX queue if the stack holds too many
+	 * frames */
+	for (i = 0; i < ETHIF_RX_FRAMES; i++) {
+		if (rx_frames[i].p == NULL) {
+			frame = &rx_frames[i];
+			break;
+		}
+	}
+	if (frame == NULL)
+		return NULL;
+
+	frame->loan.sgl.entries = sg;
+	frame->loan.sgl.size = ARRAY_SIZE(sg);
+	if (ethd_rx_loan(ethd, queue, &frame->loan) != ETH_OK)
+		return NULL;
+
+	for (i = 0; i < frame->loan.sgl.size; i++) {
+		uint8_t* payload = sg[i].buffer;
+		uint16_t len = sg[i].size;
+#if ETH_PAD_SIZE
+		/* the padding word precedes the first buffer, it is never
+		 * accessed */
+		if (i == 0) {
+			payload -= ETH_PAD_SIZE;
+			len += ETH_PAD_SIZE;
+		}
+#endif
+		q = pbuf_alloc(PBUF_RAW, len, PBUF_REF);
+		if (q == NULL) {
+			/* drop packet(); */
+			if (p != NULL)
+				pbuf_free(p);
+			ethd_rx_return(ethd, queue, &frame->loan);
+			LINK_STATS_INC(link.memerr);
+			LINK_STATS_INC(link.drop);
+			return NULL;
+		}
+		q->payload = payload;
+		if (p == NULL)
+			p = q;
+		else
+			pbuf_cat(p, q);
+	}
+	frame->loan.sgl.entries = NULL;
+	*csum = frame->loan.csum;
+
+	if (_ethif_rx_needs_copy(p)) {
+		q = pbuf_alloc(PBUF_RAW, p->tot_len, PBUF_POOL);
+		if (q != NULL)
+			pbuf_copy(q, p);
+		pbuf_free(p);
+		ethd_rx_return(ethd, queue, &frame->loan);
+		if (q == NULL) {
+			/* drop packet(); */
+			LINK_STATS_INC(link.memerr);
+			LINK_STATS_INC(link.drop);
+			return NULL;
+		}
+		LINK_STATS_INC(link.recv);
+		return q;
+	}
+
+	/* Keep a reference to know when the stack is done with the frame */
+	pbuf_ref(p);
+	frame->p = p;
+	frame->netif = netif;
+	frame->queue = queue;
+
+	LINK_STATS_INC(link.recv);
+	return p;
+}
+
+#else /* !ETHIF_ZERO_COPY */
+
+static err_t glow_level_output(struct netif *netif, struct pbuf *p)
+{
+	return glow_level_output_copy(netif, p);
+}
+
+static struct pbuf *glow_level_input(struct netif *netif, uint8_t queue, uint8_t *csum)
+{
+	return glow_level_input_copy(netif, queue, csum);
+}
+
+#endif /* ETHIF_ZERO_COPY */
+
+#if ETHIF_CHECKSUM_OFFLOAD
+/**
+ * Tell if an incoming IP packet can be passed to lwIP, which only verifies
+ * the UDP checksums. Packets with bad checksums are dropped by the MAC, but
+ * some packets are not verified at all: their IP header is verified here, and
+ * IP fragments, whose transport checksum the MAC never verifies, are passed
+ * up so that UDP datagrams are verified by lwIP once reassembled.
+ *
+ * @param p the IP packet
+ * @param csum checksums verified by the MAC (ETH_RX_CSUM_*)
+ * @return 1 if the packet can be passed to lwIP, 0 otherwise
+ */
+static u8_t ethif_checksum_verified(struct pbuf *p, uint8_t csum)
+{
+	struct ip_hdr *iphdr = p->payload;
+	u16_t hlen = IPH_HL(iphdr) * 4;
+
+	if (csum == ETH_RX_CSUM_NONE &&
+	    (p->len < hlen || inet_chksum(iphdr, hlen) != 0))
+		return 0;
+
+	switch (IPH_PROTO(iphdr)) {
+	case IP_PROTO_TCP:
+		/* lwIP does not verify TCP segments, so TCP fragments, which
+		 * TCP senders avoid with the DF flag, cannot be accepted */
+		return csum == ETH_RX_CSUM_TCP;
+	default:
+		/* UDP, UDP-Lite and the other protocols (e.g. ICMP) are
+		 * verified by lwIP, fragmented or not */
+		return 1;
+	}
+}
+#endif
 
 /**
  * This function is called by the TCP/IP stack when an IP packet
@@ -281,17 +709,20 @@ static err_t ethif_output(struct netif *netif, struct pbuf *p, struct ip_addr *i
  * the appropriate input function is called.
  *
  * @param netif the lwip network interface structure for this ethif
+ * @param queue the RX queue to read from
+ * @return 1 if a packet has been read, 0 otherwise
  */
 
-static void ethif_input(struct netif *netif)
+static u8_t ethif_input(struct netif *netif, uint8_t queue)
 {
     struct eth_hdr *ethhdr;
     struct pbuf *p;
+    uint8_t csum = ETH_RX_CSUM_NONE;
 
     /* move received packet into a new pbuf */
-    p = glow_level_input(netif);
+    p = glow_level_input(netif, queue, &csum);
     /* no packet could be read, silently ignore this */
-    if (p == NULL) return;
+    if (p == NULL) return 0;
     /* points to packet payload, which starts with an Ethernet header */
     ethhdr = p->payload;
 
@@ -300,6 +731,15 @@ static void ethif_input(struct netif *netif)
         case ETHTYPE_IP:
             /* skip Ethernet header */
             pbuf_header(p, -(s16_t)sizeof(struct eth_hdr));
+#if ETHIF_CHECKSUM_OFFLOAD
+            /* lwIP does not verify the checksums */
+            if (!ethif_checksum_verified(p, csum)) {
+                LINK_STATS_INC(link.chkerr);
+                LINK_STATS_INC(link.drop);
+                pbuf_free(p);
+                break;
+            }
+#endif
             /* pass to network layer */
             netif->input(p, netif);
             break;
@@ -313,6 +753,7 @@ static void ethif_input(struct netif *netif)
             p = NULL;
             break;
         }
+    return 1;
 }
 
 /*----------------------------------------------------------------------------
@@ -327,11 +768,21 @@ static void ethif_input(struct netif *netif)
  */
 err_t ethif_init(struct netif *netif)
 {
+	struct _ethd* ethd = board_get_eth(netif->num);
+
+#if ETHIF_CHECKSUM_OFFLOAD
+	/* lwIP neither verifies nor generates the IP/TCP/UDP checksums */
+	if (ethd_set_offload(ethd, ETH_OFFLOAD_RX_CSUM | ETH_OFFLOAD_TX_CSUM) != ETH_OK) {
+		printf("E: checksum offload not supported by interface %d\n\r", netif->num);
+		return ERR_IF;
+	}
+#endif
+
 	netif->name[0] = IFNAME0;
 	netif->name[1] = IFNAME1;
 	netif->output = ethif_output;
 	netif->linkoutput = glow_level_output;
-	glow_level_init(netif, board_get_eth(netif->num));
+	glow_level_init(netif, ethd);
 	etharp_init();
 	return ERR_OK;
 }
@@ -343,8 +794,27 @@ err_t ethif_init(struct netif *netif)
  */
 void ethif_poll(struct netif *netif)
 {
+	struct _ethd* ethd = board_get_eth(netif->num);
+	uint16_t budget, count;
+	int queue;
+
 	/* Run periodic tasks */
 	timers_update();
+#if LWIP_SNMP
+	ethif_update_snmp(netif, ethd);
+#endif
 
-	ethif_input(netif);
+	/* Serve the highest priority queue first, each queue up to its
+	 * budget */
+	for (queue = ETHIF_RX_QUEUES - 1; queue >= 0; queue--) {
+		budget = ethd_get_rx_budget(ethd, queue);
+		for (count = 0; budget == 0 || count < budget; count++) {
+			if (!ethif_input(netif, queue))
+				break;
+		}
+		ethd_rx_poll_complete(ethd, queue);
+#if ETHIF_ZERO_COPY
+		_ethif_free_pbufs();
+#endif
+	}
 }
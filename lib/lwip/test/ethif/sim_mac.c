@@ -0,0 +1,360 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "board_eth.h"
+#include "misc/cache.h"
+#include "ring.h"
+#include "timer.h"
+#include "trace.h"
+
+#include "sim_mac.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Memory shared with the simulated MAC, addressed with 32 bits */
+struct _sim_dma {
+	/* room for the padding word lwIP adds before the first RX buffer */
+	uint8_t                guard[32];
+	uint8_t                rx_buffer[SIM_RX_SIZE * ETH_RX_UNITSIZE];
+	uint8_t                tx_buffer[SIM_TX_SIZE * ETH_TX_UNITSIZE];
+	struct _eth_desc       rx_desc[SIM_RX_SIZE];
+	struct _eth_desc       tx_desc[SIM_TX_SIZE];
+	ethd_callback_t        tx_callbacks[SIM_TX_SIZE];
+	struct _eth_tx_release tx_releases[SIM_TX_SIZE];
+};
+
+/** Simulated MAC state */
+struct _sim_mac {
+	struct _sim_dma* dma;
+	uint16_t rx_index;   /**< Next RX descriptor written by the MAC */
+	uint16_t tx_index;   /**< Next TX descriptor read by the MAC */
+	bool     hold_tx;
+	uint32_t tx_count;
+	struct _sim_frame capture[SIM_CAPTURE_SIZE];
+};
+
+/*----------------------------------------------------------------------------
+ *        Variables
+ *----------------------------------------------------------------------------*/
+
+uint32_t trace_level = TRACE_LEVEL_FATAL;
+
+static struct _ethd sim_ethd;
+
+static struct _sim_mac sim;
+
+static uint64_t sim_tick;
+
+static const uint8_t sim_mac_addr[6] = { 0x3a, 0x1f, 0x34, 0x08, 0x54, 0x54 };
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static void* _sim_addr(uint32_t addr)
+{
+	return (void*)(uintptr_t)addr;
+}
+
+/**
+ * Same layout as _gmacd_reset_rx() and _gmacd_reset_tx()
+ */
+static uint8_t _sim_setup_queue(void* eth, uint8_t queue,
+		uint16_t rx_size, uint16_t rx_unitsize, uint8_t* rx_buffer, struct _eth_desc* rx_desc,
+		uint16_t tx_size, uint8_t* tx_buffer, struct _eth_desc* tx_desc,
+		ethd_callback_t *tx_callbacks)
+{
+	struct _ethd* ethd = eth;
+	struct _ethd_queue* q = &ethd->queues[queue];
+	uint32_t i;
+
+	memset(q, 0, sizeof(*q));
+	q->rx_buffer = rx_buffer;
+	q->rx_desc = rx_desc;
+	q->rx_size = rx_size;
+	q->rx_unitsize = rx_unitsize;
+	for (i = 0; i < rx_size; i++) {
+		rx_desc[i].addr = (uint32_t)(uintptr_t)(rx_buffer + i * rx_unitsize);
+		rx_desc[i].status = 0;
+	}
+	rx_desc[rx_size - 1].addr |= ETH_RX_ADDR_WRAP;
+
+	q->tx_buffer = tx_buffer;
+	q->tx_desc = tx_desc;
+	q->tx_size = tx_size;
+	q->tx_callbacks = tx_callbacks;
+	for (i = 0; i < tx_size; i++) {
+		tx_desc[i].addr = (uint32_t)(uintptr_t)(tx_buffer + i * ETH_TX_UNITSIZE);
+		tx_desc[i].status = ETH_TX_STATUS_USED;
+	}
+	tx_desc[tx_size - 1].status |= ETH_TX_STATUS_WRAP;
+
+	sim.rx_index = 0;
+	sim.tx_index = 0;
+	return ETH_OK;
+}
+
+static void _sim_start(void* eth)
+{
+}
+
+static void _sim_get_mac_addr(void* eth, uint8_t sa_idx, uint8_t* mac)
+{
+	memcpy(mac, sim_mac_addr, sizeof(sim_mac_addr));
+}
+
+/**
+ * Read the TX descriptors the way the MAC does: every frame up to the first
+ * descriptor with the USED bit set, then write back USED into the first
+ * descriptor of each frame sent.
+ */
+static void _sim_transmit(void)
+{
+	struct _ethd_queue* q = &sim_ethd.queues[0];
+	struct _eth_desc* first;
+	struct _eth_desc* desc;
+	struct _sim_frame* frame;
+	uint32_t size;
+
+	while ((q->tx_desc[sim.tx_index].status & ETH_TX_STATUS_USED) == 0) {
+		frame = &sim.capture[sim.tx_count % SIM_CAPTURE_SIZE];
+		first = &q->tx_desc[sim.tx_index];
+		frame->size = 0;
+		frame->copied = _sim_addr(first->addr) >= (void*)q->tx_buffer &&
+			_sim_addr(first->addr) < (void*)(q->tx_buffer + q->tx_size * ETH_TX_UNITSIZE);
+		do {
+			desc = &q->tx_desc[sim.tx_index];
+			size = desc->status & ETH_RX_STATUS_LENGTH_MASK;
+			if (frame->size + size > sizeof(frame->data)) {
+				fprintf(stderr, "sim_mac: TX frame too long\n");
+				abort();
+			}
+			memcpy(frame->data + frame->size, _sim_addr(desc->addr), size);
+			frame->size += size;
+			RING_INC(sim.tx_index, q->tx_size);
+		} while ((desc->status & ETH_TX_STATUS_LASTBUF) == 0);
+		first->status |= ETH_TX_STATUS_USED;
+		sim.tx_count++;
+	}
+}
+
+/**
+ * Same processing as _gmacd_tx_complete_handler()
+ */
+static void _sim_tx_complete(void)
+{
+	struct _ethd_queue* q = &sim_ethd.queues[0];
+	struct _eth_desc* desc;
+	struct _eth_tx_release* release;
+
+	while (!RING_EMPTY(q->tx_head, q->tx_tail)) {
+		desc = &q->tx_desc[q->tx_tail];
+		if ((desc->status & ETH_TX_STATUS_USED) == 0)
+			break;
+
+		while ((desc->status & ETH_TX_STATUS_LASTBUF) == 0) {
+			RING_INC(q->tx_tail, q->tx_size);
+			desc = &q->tx_desc[q->tx_tail];
+		}
+
+		if (q->tx_callbacks && q->tx_callbacks[q->tx_tail])
+			q->tx_callbacks[q->tx_tail](0, 0);
+
+		if (q->tx_releases) {
+			release = &q->tx_releases[q->tx_tail];
+			if (release->callback) {
+				release->callback(0, 0, release->arg);
+				release->callback = NULL;
+			}
+		}
+
+		RING_INC(q->tx_tail, q->tx_size);
+	}
+}
+
+static void _sim_start_transmission(void* eth)
+{
+	if (!sim.hold_tx)
+		sim_mac_complete_tx();
+}
+
+static const struct _ethd_op _sim_op = {
+	.setup_queue = _sim_setup_queue,
+	.start = _sim_start,
+	.get_mac_addr = _sim_get_mac_addr,
+	.start_transmission = _sim_start_transmission,
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void sim_mac_init(bool tx_releases)
+{
+	if (!sim.dma) {
+		sim.dma = mmap(NULL, sizeof(struct _sim_dma),
+		               PROT_READ | PROT_WRITE,
+		               MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+		if (sim.dma == MAP_FAILED) {
+			perror("mmap");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	memset(&sim_ethd, 0, sizeof(sim_ethd));
+	sim_ethd.addr = &sim;
+	sim_ethd.op = &_sim_op;
+
+	sim.hold_tx = false;
+	sim.tx_count = 0;
+	ethd_setup_queue(&sim_ethd, 0,
+			SIM_RX_SIZE, ETH_RX_UNITSIZE, sim.dma->rx_buffer, sim.dma->rx_desc,
+			SIM_TX_SIZE, sim.dma->tx_buffer, sim.dma->tx_desc,
+			sim.dma->tx_callbacks);
+	if (tx_releases)
+		ethd_setup_tx_release(&sim_ethd, 0, sim.dma->tx_releases);
+	ethd_start(&sim_ethd);
+}
+
+void sim_mac_hold_tx(bool hold)
+{
+	sim.hold_tx = hold;
+}
+
+void sim_mac_complete_tx(void)
+{
+	_sim_transmit();
+	_sim_tx_complete();
+}
+
+bool sim_mac_rx(const void* frame, uint32_t size)
+{
+	struct _ethd_queue* q = &sim_ethd.queues[0];
+	const uint8_t* data = frame;
+	uint32_t count = (size + q->rx_unitsize - 1) / q->rx_unitsize;
+	uint32_t idx = sim.rx_index;
+	uint32_t i, len;
+
+	/* Drop the frame if the driver holds the descriptors needed */
+	for (i = 0; i < count; i++) {
+		if (q->rx_desc[idx].addr & ETH_RX_ADDR_OWN)
+			return false;
+		RING_INC(idx, q->rx_size);
+	}
+
+	for (i = 0; i < count; i++) {
+		struct _eth_desc* desc = &q->rx_desc[sim.rx_index];
+		len = size - i * q->rx_unitsize;
+		if (len > q->rx_unitsize)
+			len = q->rx_unitsize;
+		memcpy(_sim_addr(desc->addr & ETH_RX_ADDR_MASK),
+		       data + i * q->rx_unitsize, len);
+		desc->status = 0;
+		if (i == 0)
+			desc->status |= ETH_RX_STATUS_SOF;
+		if (i == count - 1)
+			desc->status |= ETH_RX_STATUS_EOF | size;
+		desc->addr |= ETH_RX_ADDR_OWN;
+		RING_INC(sim.rx_index, q->rx_size);
+	}
+	return true;
+}
+
+uint32_t sim_mac_tx_count(void)
+{
+	return sim.tx_count;
+}
+
+const struct _sim_frame* sim_mac_last_tx(void)
+{
+	if (!sim.tx_count)
+		return NULL;
+	return &sim.capture[(sim.tx_count - 1) % SIM_CAPTURE_SIZE];
+}
+
+uint32_t sim_mac_rx_held(void)
+{
+	return sim_ethd.queues[0].rx_held;
+}
+
+void sim_mac_advance(uint32_t ms)
+{
+	sim_tick += ms;
+}
+
+/*----------------------------------------------------------------------------
+ *        Board, cache and timer services
+ *----------------------------------------------------------------------------*/
+
+struct _ethd* board_get_eth(uint8_t iface)
+{
+	return &sim_ethd;
+}
+
+void cache_invalidate_region(void* start, uint32_t length)
+{
+}
+
+void cache_clean_region(const void* start, uint32_t length)
+{
+}
+
+uint64_t timer_get_tick(void)
+{
+	return sim_tick;
+}
+
+uint64_t timer_get_interval(uint64_t start, uint64_t end)
+{
+	return end - start;
+}
+
+void timer_start_timeout(struct _timeout* timeout, uint64_t count)
+{
+	timeout->start = sim_tick;
+	timeout->count = count;
+}
+
+uint8_t timer_timeout_reached(struct _timeout* timeout)
+{
+	return sim_tick - timeout->start >= timeout->count;
+}
@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Simulated MAC for the host build of the lwIP network interface. The
+ * generic ETH driver (ethd.c) runs unmodified on top of it: the simulated
+ * MAC owns the RX and TX descriptor rings the way the GMAC does, receives
+ * the frames injected by sim_mac_rx() and captures the frames it sends.
+ *
+ * The descriptors hold 32-bit addresses, all the buffers handed to the
+ * driver must thus live in the low 4GB: the harness is linked without PIE
+ * and the rings are mapped with MAP_32BIT.
+ */
+
+#ifndef _SIM_MAC_H_
+#define _SIM_MAC_H_
+
+#include "network/ethd.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+#define SIM_RX_SIZE 32 /**< RX descriptors */
+#define SIM_TX_SIZE 32 /**< TX descriptors */
+
+/** Frames kept by the capture, the oldest ones are overwritten */
+#define SIM_CAPTURE_SIZE 16
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Frame sent by the simulated MAC */
+struct _sim_frame {
+	bool     copied; /**< Sent from the TX buffers of the driver */
+	uint32_t size;
+	uint8_t  data[ETH_MAX_FRAME_LENGTH];
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Set up the simulated MAC and the ETH driver instance returned by
+ * board_get_eth(). The TX release ring is installed when tx_releases is set.
+ */
+extern void sim_mac_init(bool tx_releases);
+
+/**
+ * \brief Hold the sent frames in the TX ring until sim_mac_complete_tx() is
+ * called, as a busy link would.
+ */
+extern void sim_mac_hold_tx(bool hold);
+
+/**
+ * \brief Send the frames queued in the TX ring and run the TX completion
+ * the way the GMAC interrupt handler does.
+ */
+extern void sim_mac_complete_tx(void);
+
+/**
+ * \brief Receive a frame: write it into the free RX descriptors and hand
+ * them to the driver.
+ * \return false if the RX ring is full.
+ */
+extern bool sim_mac_rx(const void* frame, uint32_t size);
+
+/** \brief Number of frames sent since sim_mac_init() */
+extern uint32_t sim_mac_tx_count(void);
+
+/** \brief Last frame sent, NULL if none */
+extern const struct _sim_frame* sim_mac_last_tx(void);
+
+/** \brief Number of RX descriptors not given back to the simulated MAC */
+extern uint32_t sim_mac_rx_held(void);
+
+/** \brief Advance the system tick by ms milliseconds */
+extern void sim_mac_advance(uint32_t ms);
+
+#endif /* _SIM_MAC_H_ */
@@ -0,0 +1,540 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Host test of the lwIP network interface (netif/ethif.c) running over the
+ * generic ETH driver and a simulated MAC. The frames lwIP modifies in place
+ * (ICMP echo, ICMP port unreachable) must get valid replies whatever the RX
+ * mode, the TCP segments must reach the application and all the RX buffers
+ * must be given back to the MAC, and in the zero-copy TX mode the pbufs must
+ * all be freed once sent even when more frames are queued than the TX
+ * release ring holds.
+ *
+ * The benchmark prints the time spent in ethif_poll() per received TCP
+ * segment, to compare the builds with and without ETHIF_ZERO_COPY.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "lwip/opt.h"
+#include "lwip/init.h"
+#include "lwip/ip.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcp.h"
+#include "lwip/udp.h"
+#include "netif/etharp.h"
+#include "netif/ethif.h"
+
+#include "chksum.h"
+
+#include "sim_mac.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+			failures++; \
+		} \
+	} while (0)
+
+#define PEER_PORT    40000
+#define DISCARD_PORT 9
+#define CLOSED_PORT  9999
+
+#define TCP_DATA_SIZE 1460
+
+#define BENCH_SEGMENTS 20000
+
+#define UDP_BURST 48
+
+/* Frames sent without copy in this build */
+#define TX_ZERO_COPY (ETHIF_ZERO_COPY && ETHIF_ZERO_COPY_TX)
+
+#define ETH_HDR_SIZE 14
+#define IP_HDR_SIZE  20
+#define TCP_HDR_SIZE 20
+
+/*----------------------------------------------------------------------------
+ *        Variables
+ *----------------------------------------------------------------------------*/
+
+static int failures;
+
+static struct netif netif;
+
+static const uint8_t peer_mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const uint8_t dut_ip[4] = { 192, 168, 1, 3 };
+static const uint8_t peer_ip[4] = { 192, 168, 1, 2 };
+
+/* Peer side of the TCP connection */
+static uint32_t peer_seq;
+static uint32_t peer_ack;
+
+/* Data received by the discard server */
+static uint32_t rx_bytes;
+static uint32_t rx_ref_pbufs;
+
+/*----------------------------------------------------------------------------
+ *        Frame helpers
+ *----------------------------------------------------------------------------*/
+
+static void put16(uint8_t* p, uint16_t v)
+{
+	p[0] = v >> 8;
+	p[1] = v & 0xff;
+}
+
+static void put32(uint8_t* p, uint32_t v)
+{
+	put16(p, v >> 16);
+	put16(p + 2, v & 0xffff);
+}
+
+static uint16_t get16(const uint8_t* p)
+{
+	return (p[0] << 8) | p[1];
+}
+
+static uint32_t get32(const uint8_t* p)
+{
+	return ((uint32_t)get16(p) << 16) | get16(p + 2);
+}
+
+/* Internet checksum, stored as is into the frame */
+static uint16_t csum(const void* data, uint32_t len)
+{
+	return ~chksum_compute(data, len);
+}
+
+/* Checksum of a TCP or UDP header and payload with the pseudo header */
+static uint16_t csum_l4(const uint8_t* ip, const uint8_t* l4, uint16_t len)
+{
+	uint8_t buf[12 + ETH_MAX_FRAME_LENGTH];
+
+	memcpy(buf, ip + 12, 8);
+	buf[8] = 0;
+	buf[9] = ip[9];
+	put16(buf + 10, len);
+	memcpy(buf + 12, l4, len);
+	return csum(buf, 12 + len);
+}
+
+/* Build the Ethernet and IPv4 headers in front of a payload of len bytes
+ * already written at frame + 34, return the frame size */
+static uint32_t build_ip(uint8_t* frame, uint8_t proto, uint16_t len)
+{
+	uint8_t* ip = frame + ETH_HDR_SIZE;
+	uint16_t c;
+
+	memcpy(frame, netif.hwaddr, 6);
+	memcpy(frame + 6, peer_mac, 6);
+	put16(frame + 12, ETHTYPE_IP);
+
+	memset(ip, 0, IP_HDR_SIZE);
+	ip[0] = 0x45;
+	put16(ip + 2, IP_HDR_SIZE + len);
+	ip[8] = 64;
+	ip[9] = proto;
+	memcpy(ip + 12, peer_ip, 4);
+	memcpy(ip + 16, dut_ip, 4);
+	c = csum(ip, IP_HDR_SIZE);
+	memcpy(ip + 10, &c, 2);
+
+	return ETH_HDR_SIZE + IP_HDR_SIZE + len;
+}
+
+static uint32_t build_tcp(uint8_t* frame, uint8_t flags, uint32_t seq, uint32_t ack,
+		const void* data, uint16_t len)
+{
+	uint8_t* ip = frame + ETH_HDR_SIZE;
+	uint8_t* tcp = ip + IP_HDR_SIZE;
+	uint32_t size;
+	uint16_t c;
+
+	memset(tcp, 0, TCP_HDR_SIZE);
+	put16(tcp, PEER_PORT);
+	put16(tcp + 2, DISCARD_PORT);
+	put32(tcp + 4, seq);
+	put32(tcp + 8, ack);
+	tcp[12] = (TCP_HDR_SIZE / 4) << 4;
+	tcp[13] = flags;
+	put16(tcp + 14, 65535);
+	if (len)
+		memcpy(tcp + TCP_HDR_SIZE, data, len);
+
+	size = build_ip(frame, IP_PROTO_TCP, TCP_HDR_SIZE + len);
+	c = csum_l4(ip, tcp, TCP_HDR_SIZE + len);
+	memcpy(tcp + 16, &c, 2);
+	return size;
+}
+
+/* Check the IP header of a frame sent to the peer, return its payload */
+static const uint8_t* check_ip(const struct _sim_frame* f, uint8_t proto)
+{
+	const uint8_t* ip = f->data + ETH_HDR_SIZE;
+
+	CHECK(f->size >= ETH_HDR_SIZE + IP_HDR_SIZE);
+	CHECK(memcmp(f->data, peer_mac, 6) == 0);
+	CHECK(get16(f->data + 12) == ETHTYPE_IP);
+	CHECK(ip[9] == proto);
+	CHECK(memcmp(ip + 16, peer_ip, 4) == 0);
+	CHECK(csum(ip, IP_HDR_SIZE) == 0);
+	CHECK(get16(ip + 2) == f->size - ETH_HDR_SIZE);
+	return ip + IP_HDR_SIZE;
+}
+
+static void rx(const uint8_t* frame, uint32_t size)
+{
+	CHECK(sim_mac_rx(frame, size));
+	ethif_poll(&netif);
+}
+
+/*----------------------------------------------------------------------------
+ *        TCP discard server
+ *----------------------------------------------------------------------------*/
+
+static err_t discard_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+	struct pbuf* q;
+
+	if (p == NULL) {
+		tcp_close(pcb);
+		return ERR_OK;
+	}
+	for (q = p; q != NULL; q = q->next)
+		if (q->type == PBUF_REF)
+			rx_ref_pbufs++;
+	rx_bytes += p->tot_len;
+	tcp_recved(pcb, p->tot_len);
+	pbuf_free(p);
+	return ERR_OK;
+}
+
+static err_t discard_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+	tcp_recv(pcb, discard_recv);
+	return ERR_OK;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_arp(void)
+{
+	uint8_t frame[60];
+	const struct _sim_frame* f;
+	uint32_t count = sim_mac_tx_count();
+
+	printf("ARP request\n");
+
+	memset(frame, 0, sizeof(frame));
+	memset(frame, 0xff, 6);
+	memcpy(frame + 6, peer_mac, 6);
+	put16(frame + 12, ETHTYPE_ARP);
+	put16(frame + 14, 1);       /* Ethernet */
+	put16(frame + 16, ETHTYPE_IP);
+	frame[18] = 6;
+	frame[19] = 4;
+	put16(frame + 20, 1);       /* request */
+	memcpy(frame + 22, peer_mac, 6);
+	memcpy(frame + 28, peer_ip, 4);
+	memcpy(frame + 38, dut_ip, 4);
+	rx(frame, sizeof(frame));
+
+	CHECK(sim_mac_tx_count() == count + 1);
+	f = sim_mac_last_tx();
+	if (!f)
+		return;
+	CHECK(get16(f->data + 12) == ETHTYPE_ARP);
+	CHECK(get16(f->data + 20) == 2);
+	CHECK(memcmp(f->data + 22, netif.hwaddr, 6) == 0);
+	CHECK(memcmp(f->data + 38, peer_ip, 4) == 0);
+	CHECK(sim_mac_rx_held() == 0);
+}
+
+static void test_icmp_echo(void)
+{
+	uint8_t frame[ETH_MAX_FRAME_LENGTH];
+	uint8_t* icmp = frame + ETH_HDR_SIZE + IP_HDR_SIZE;
+	const uint8_t* reply;
+	const struct _sim_frame* f;
+	uint32_t count = sim_mac_tx_count();
+	uint16_t len = 8 + 300, c, i;
+
+	printf("ICMP echo request\n");
+
+	/* Long enough to span several RX buffers */
+	memset(icmp, 0, 8);
+	icmp[0] = 8;
+	put16(icmp + 4, 0x1234);
+	put16(icmp + 6, 1);
+	for (i = 8; i < len; i++)
+		icmp[i] = i;
+	c = csum(icmp, len);
+	memcpy(icmp + 2, &c, 2);
+	rx(frame, build_ip(frame, IP_PROTO_ICMP, len));
+
+	CHECK(sim_mac_tx_count() == count + 1);
+	f = sim_mac_last_tx();
+	if (!f || sim_mac_tx_count() == count)
+		return;
+	reply = check_ip(f, IP_PROTO_ICMP);
+	CHECK(reply[0] == 0);
+	CHECK(get16(reply + 4) == 0x1234);
+	CHECK(f->size == ETH_HDR_SIZE + IP_HDR_SIZE + len);
+	CHECK(csum(reply, len) == 0);
+	CHECK(memcmp(reply + 8, icmp + 8, len - 8) == 0);
+	CHECK(sim_mac_rx_held() == 0);
+}
+
+static void test_udp_unreachable(void)
+{
+	uint8_t frame[ETH_MAX_FRAME_LENGTH];
+	uint8_t* ip = frame + ETH_HDR_SIZE;
+	uint8_t* udp = ip + IP_HDR_SIZE;
+	const uint8_t* icmp;
+	const struct _sim_frame* f;
+	uint32_t count = sim_mac_tx_count();
+	uint16_t len = 8 + 32, c;
+
+	printf("UDP datagram to a closed port\n");
+
+	put16(udp, PEER_PORT);
+	put16(udp + 2, CLOSED_PORT);
+	put16(udp + 4, len);
+	memset(udp + 6, 0, 2);
+	memset(udp + 8, 0x5a, len - 8);
+	build_ip(frame, IP_PROTO_UDP, len);
+	c = csum_l4(ip, udp, len);
+	memcpy(udp + 6, &c, 2);
+	rx(frame, ETH_HDR_SIZE + IP_HDR_SIZE + len);
+
+	CHECK(sim_mac_tx_count() == count + 1);
+	f = sim_mac_last_tx();
+	if (!f || sim_mac_tx_count() == count)
+		return;
+	icmp = check_ip(f, IP_PROTO_ICMP);
+	CHECK(icmp[0] == ICMP_DUR);
+	CHECK(icmp[1] == ICMP_DUR_PORT);
+	/* the original IP header and the UDP header are quoted */
+	CHECK(memcmp(icmp + 8, ip, IP_HDR_SIZE + 8) == 0);
+	CHECK(sim_mac_rx_held() == 0);
+}
+
+static void test_tcp(void)
+{
+	uint8_t frame[ETH_MAX_FRAME_LENGTH];
+	uint8_t data[TCP_DATA_SIZE];
+	const uint8_t* tcp;
+	const struct _sim_frame* f;
+	uint32_t count = sim_mac_tx_count();
+	int i;
+
+	printf("TCP connection and data\n");
+
+	peer_seq = 1000;
+	rx(frame, build_tcp(frame, TCP_SYN, peer_seq, 0, NULL, 0));
+	CHECK(sim_mac_tx_count() == count + 1);
+	f = sim_mac_last_tx();
+	if (!f || sim_mac_tx_count() == count)
+		return;
+	tcp = check_ip(f, IP_PROTO_TCP);
+	CHECK((tcp[13] & (TCP_SYN | TCP_ACK)) == (TCP_SYN | TCP_ACK));
+	CHECK(get32(tcp + 8) == peer_seq + 1);
+	peer_seq++;
+	peer_ack = get32(tcp + 4) + 1;
+
+	rx(frame, build_tcp(frame, TCP_ACK, peer_seq, peer_ack, NULL, 0));
+
+	memset(data, 0xa5, sizeof(data));
+	rx_bytes = 0;
+	rx_ref_pbufs = 0;
+	for (i = 0; i < 8; i++) {
+		rx(frame, build_tcp(frame, TCP_ACK | TCP_PSH, peer_seq, peer_ack,
+		                    data, sizeof(data)));
+		peer_seq += sizeof(data);
+		CHECK(sim_mac_rx_held() == 0);
+	}
+	CHECK(rx_bytes == 8 * sizeof(data));
+	CHECK((rx_ref_pbufs != 0) == (ETHIF_ZERO_COPY != 0));
+
+	/* Let the delayed ACK go */
+	sim_mac_advance(TCP_FAST_INTERVAL + 1);
+	ethif_poll(&netif);
+	f = sim_mac_last_tx();
+	tcp = check_ip(f, IP_PROTO_TCP);
+	CHECK(get32(tcp + 8) == peer_seq);
+	/* lwIP rewrites the TCP segments it retransmits */
+	CHECK(f->copied);
+}
+
+static void test_tx_burst(void)
+{
+	struct udp_pcb* pcb;
+	struct pbuf* p[UDP_BURST];
+	struct ip_addr dst;
+	uint32_t count = sim_mac_tx_count();
+	uint32_t sent = 0;
+	int i;
+
+	printf("UDP burst with the TX completion held\n");
+
+	pcb = udp_new();
+	CHECK(pcb != NULL);
+	if (!pcb)
+		return;
+	udp_bind(pcb, IP_ADDR_ANY, PEER_PORT);
+	IP4_ADDR(&dst, peer_ip[0], peer_ip[1], peer_ip[2], peer_ip[3]);
+
+	sim_mac_hold_tx(true);
+	for (i = 0; i < UDP_BURST; i++) {
+		p[i] = pbuf_alloc(PBUF_TRANSPORT, 64, PBUF_RAM);
+		CHECK(p[i] != NULL);
+		if (!p[i])
+			break;
+		memset(p[i]->payload, i, 64);
+		if (udp_sendto(pcb, p[i], &dst, PEER_PORT) == ERR_OK)
+			sent++;
+	}
+	/* More frames than the TX ring holds have been offered */
+	CHECK(sent < UDP_BURST);
+	CHECK(sent >= SIM_TX_SIZE / 2);
+
+	sim_mac_hold_tx(false);
+	sim_mac_complete_tx();
+	ethif_poll(&netif);
+	CHECK(sim_mac_tx_count() == count + sent);
+	CHECK(sim_mac_last_tx()->copied == !TX_ZERO_COPY);
+
+	/* Only the reference taken here remains */
+	for (i = 0; i < UDP_BURST && p[i]; i++) {
+		CHECK(p[i]->ref == 1);
+		pbuf_free(p[i]);
+	}
+
+	/* The ring is usable again */
+	p[0] = pbuf_alloc(PBUF_TRANSPORT, 64, PBUF_RAM);
+	CHECK(udp_sendto(pcb, p[0], &dst, PEER_PORT) == ERR_OK);
+	CHECK(sim_mac_tx_count() == count + sent + 1);
+	ethif_poll(&netif);
+	CHECK(p[0]->ref == 1);
+	pbuf_free(p[0]);
+
+	udp_remove(pcb);
+}
+
+static void bench_tcp_rx(void)
+{
+	uint8_t frame[ETH_MAX_FRAME_LENGTH];
+	uint8_t data[TCP_DATA_SIZE];
+	struct timespec t0, t1;
+	uint64_t ns = 0;
+	uint32_t size;
+	int i;
+
+	memset(data, 0x3c, sizeof(data));
+	rx_bytes = 0;
+	for (i = 0; i < BENCH_SEGMENTS; i++) {
+		size = build_tcp(frame, TCP_ACK | TCP_PSH, peer_seq, peer_ack,
+		                 data, sizeof(data));
+		peer_seq += sizeof(data);
+		if (!sim_mac_rx(frame, size))
+			break;
+
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		ethif_poll(&netif);
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		ns += (t1.tv_sec - t0.tv_sec) * 1000000000ull
+		    + t1.tv_nsec - t0.tv_nsec;
+	}
+	CHECK(rx_bytes == (uint64_t)BENCH_SEGMENTS * sizeof(data));
+	CHECK(sim_mac_rx_held() == 0);
+
+	printf("TCP RX: %u segments of %u bytes, %llu ns per segment\n",
+	       BENCH_SEGMENTS, TCP_DATA_SIZE,
+	       (unsigned long long)(ns / BENCH_SEGMENTS));
+}
+
+/*----------------------------------------------------------------------------
+ *        Main
+ *----------------------------------------------------------------------------*/
+
+int main(void)
+{
+	struct ip_addr ipaddr, netmask, gw;
+	struct tcp_pcb* pcb;
+
+	printf("ethif: RX %s, TX %s\n",
+	       ETHIF_ZERO_COPY ? "zero-copy" : "copy",
+	       TX_ZERO_COPY ? "zero-copy" : "copy");
+
+	sim_mac_init(TX_ZERO_COPY);
+
+	lwip_init();
+	IP4_ADDR(&ipaddr, dut_ip[0], dut_ip[1], dut_ip[2], dut_ip[3]);
+	IP4_ADDR(&netmask, 255, 255, 255, 0);
+	IP4_ADDR(&gw, peer_ip[0], peer_ip[1], peer_ip[2], peer_ip[3]);
+	netif_add(&netif, &ipaddr, &netmask, &gw, NULL, ethif_init, ip_input);
+	netif_set_default(&netif);
+	netif_set_up(&netif);
+
+	pcb = tcp_new();
+	tcp_bind(pcb, IP_ADDR_ANY, DISCARD_PORT);
+	pcb = tcp_listen(pcb);
+	tcp_accept(pcb, discard_accept);
+
+	test_arp();
+	test_icmp_echo();
+	test_udp_unreachable();
+	test_tcp();
+	test_tx_burst();
+	bench_tcp_rx();
+
+	if (failures) {
+		printf("%d check(s) failed\n", failures);
+		return EXIT_FAILURE;
+	}
+	printf("all checks passed\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2013, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "network/ethd.h"
+
+#include "uip.h"
+#include "uip_arch.h"
+
+#include "eth_tapdev.h"
+
+#include "chksum.h"
+
+#if UIP_ARCH_CHKSUM
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define BUF ((struct uip_tcpip_hdr *)&uip_buf[UIP_LLH_LEN])
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static u16_t chksum(u16_t sum, const u8_t *data, u16_t len)
+{
+	/* Return sum in host byte order. */
+	return chksum_add(sum, ntohs(chksum_compute(data, len)));
+}
+
+static u16_t upper_layer_chksum(u8_t proto)
+{
+	u16_t upper_layer_len;
+	u16_t sum;
+
+	upper_layer_len = (((u16_t)(BUF->len[0]) << 8) + BUF->len[1]) - UIP_IPH_LEN;
+
+	/* First sum pseudoheader. */
+
+	/* IP protocol and length fields. This addition cannot carry. */
+	sum = upper_layer_len + proto;
+	/* Sum IP source and destination addresses. */
+	sum = chksum(sum, (u8_t *)&BUF->srcipaddr[0], 2 * sizeof(uip_ipaddr_t));
+
+	/* Sum TCP header and data. */
+	sum = chksum(sum, &uip_buf[UIP_IPH_LEN + UIP_LLH_LEN], upper_layer_len);
+
+	return (sum == 0) ? 0xffff : htons(sum);
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * The checksums verified by the MAC for the frame in uip_buf are reported as
+ * valid (0xffff) without being computed. Only the IP header and the TCP or
+ * UDP checksums of unfragmented datagrams are verified by the MAC: the others
+ * (ICMP, fragments and the datagrams reassembled from them, frames received
+ * while offload is disabled) are computed here. The same functions are used
+ * to generate the checksums of the replies built in uip_buf: the checksum
+ * fields are then left to 0 and filled by the MAC, since eth_tapdev_init()
+ * always enables RX and TX checksum offload together.
+ */
+
+u16_t uip_chksum(u16_t *data, u16_t len)
+{
+	return htons(chksum(0, (u8_t *)data, len));
+}
+
+u16_t uip_ipchksum(void)
+{
+	u16_t sum;
+
+	if (eth_tapdev_rx_csum != ETH_RX_CSUM_NONE)
+		return 0xffff;
+
+	sum = chksum(0, &uip_buf[UIP_LLH_LEN], UIP_IPH_LEN);
+	return (sum == 0) ? 0xffff : htons(sum);
+}
+
+u16_t uip_tcpchksum(void)
+{
+	if (eth_tapdev_rx_csum == ETH_RX_CSUM_TCP)
+		return 0xffff;
+
+	return upper_layer_chksum(UIP_PROTO_TCP);
+}
+
+#if UIP_UDP_CHECKSUMS
+u16_t uip_udpchksum(void)
+{
+	if (eth_tapdev_rx_csum == ETH_RX_CSUM_UDP)
+		return 0xffff;
+
+	return upper_layer_chksum(UIP_PROTO_UDP);
+}
+#endif /* UIP_UDP_CHECKSUMS */
+
+#endif /* UIP_ARCH_CHKSUM */
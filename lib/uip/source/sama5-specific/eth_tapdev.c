@@ -42,17 +42,75 @@
 
 #include "eth_tapdev.h"
 
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/* Number of RX queues polled, the highest queue first */
+#ifdef CONFIG_GMAC_PRIO_QUEUES
+#define ETH_TAPDEV_RX_QUEUES ETH_NUM_QUEUES
+#else
+#define ETH_TAPDEV_RX_QUEUES 1
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported variables
+ *----------------------------------------------------------------------------*/
+
+uint8_t eth_tapdev_rx_csum = ETH_RX_CSUM_NONE;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Checksums verified by the MAC for the frame in uip_buf. None for an IP
+ * fragment: the MAC does not verify its TCP or UDP checksum, and the
+ * datagram uIP reassembles from it in uip_buf keeps this status.
+ */
+static uint8_t _rx_csum(struct _ethd* ethd, int queue)
+{
+	const struct uip_eth_hdr* eth = (struct uip_eth_hdr*)uip_buf;
+	const struct uip_tcpip_hdr* ip = (struct uip_tcpip_hdr*)&uip_buf[UIP_LLH_LEN];
+
+	/* More fragments flag or fragment offset */
+	if (eth->type == HTONS(UIP_ETHTYPE_IP) &&
+	    ((ip->ipoffset[0] & 0x3f) || ip->ipoffset[1]))
+		return ETH_RX_CSUM_NONE;
+	return ethd_get_rx_csum(ethd, queue);
+}
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
 
+void eth_tapdev_init(u8_t iface)
+{
+#if UIP_CONF_CHECKSUM_OFFLOAD
+	struct _ethd* ethd = board_get_eth(iface);
+	const uint32_t offload = ETH_OFFLOAD_RX_CSUM | ETH_OFFLOAD_TX_CSUM;
+
+	/* Checksums are computed by uIP if the MAC cannot do it */
+	if ((ethd_get_offload_caps(ethd) & offload) == offload)
+		ethd_set_offload(ethd, offload);
+#endif
+}
+
 uint32_t eth_tapdev_read(u8_t iface)
 {
+	struct _ethd* ethd = board_get_eth(iface);
 	uint32_t pkt_len = 0;
-	uint8_t rc = ethd_poll(board_get_eth(iface), 0, (uint8_t*)uip_buf, UIP_CONF_BUFFER_SIZE, &pkt_len);
-	if (rc != ETH_OK)
-		return 0;
-	return pkt_len;
+	int queue;
+
+	/* Frames steered to the priority queues are read first */
+	for (queue = ETH_TAPDEV_RX_QUEUES - 1; queue >= 0; queue--) {
+		if (ethd_poll(ethd, queue, (uint8_t*)uip_buf, UIP_CONF_BUFFER_SIZE, &pkt_len) == ETH_OK) {
+			eth_tapdev_rx_csum = _rx_csum(ethd, queue);
+			return pkt_len;
+		}
+	}
+	eth_tapdev_rx_csum = ETH_RX_CSUM_NONE;
+	return 0;
 }
 
 void eth_tapdev_send(u8_t iface)
@@ -30,6 +30,19 @@
 #ifndef __GTAPDEV_H__
 #define __GTAPDEV_H__
 
+/**
+ * Checksums verified by the ETH device for the frame in uip_buf
+ * (ETH_RX_CSUM_*).
+ */
+extern uint8_t eth_tapdev_rx_csum;
+
+/**
+ * Initialize the ETH device for uIP. Enables the checksum offload if
+ * UIP_CONF_CHECKSUM_OFFLOAD is set and the device supports it.
+ * \param iface Interface index
+ */
+void eth_tapdev_init(u8_t iface);
+
 /**
  * Read from ETH device.
  * \param iface Interface index
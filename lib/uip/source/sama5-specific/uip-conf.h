@@ -139,6 +139,21 @@ typedef unsigned short uip_stats_t;
  */
 #define UIP_CONF_STATISTICS      1
 
+/**
+ * Checksum offload on or off. When on, the IP/TCP/UDP checksums are
+ * generated by the ETH device if it supports it, and verified by it for
+ * unfragmented IP datagrams. The other checksums are computed by uIP.
+ *
+ * \hideinitializer
+ */
+#ifndef UIP_CONF_CHECKSUM_OFFLOAD
+#define UIP_CONF_CHECKSUM_OFFLOAD 1
+#endif
+
+#if UIP_CONF_CHECKSUM_OFFLOAD
+#define UIP_ARCH_CHKSUM          1
+#endif
+
 /**
  * The link level header length.
  *
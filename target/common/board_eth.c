@@ -62,6 +62,28 @@
 /* Number of buffer for TX */
 #define ETH_TX_BUFFERS  8
 
+/* Size of the RX buffers: the EMAC only supports 128-byte buffers, the GMAC
+ * can store a full-size frame in a single buffer */
+#ifdef CONFIG_HAVE_EMAC
+#define ETH_RX_BUFSIZE  ETH_RX_UNITSIZE
+#else
+#define ETH_RX_BUFSIZE  ETH_MAX_FRAME_LENGTH
+#endif
+
+#ifdef CONFIG_GMAC_PRIO_QUEUES
+/* Number of priority queues, frames are steered to them by screeners. Their
+ * buffers are only allocated when the application sets
+ * CONFIG_GMAC_PRIO_QUEUES, the GMAC driver otherwise points the queues to
+ * dummy descriptors. */
+#define ETH_PRIO_QUEUES (ETH_NUM_QUEUES - 1)
+
+/* Number of buffer for RX, per priority queue */
+#define ETH_PRIO_RX_BUFFERS  16
+
+/* Number of buffer for TX, per priority queue */
+#define ETH_PRIO_TX_BUFFERS  2
+#endif
+
 /*----------------------------------------------------------------------------
  *        Local variables
  *----------------------------------------------------------------------------*/
@@ -113,11 +135,35 @@ static uint8_t eth_tx_buffer[ETH_IFACE_COUNT][ETH_TX_BUFFERS * ETH_TX_UNITSIZE];
 
 /** RX Buffers */
 ALIGNED(32) SECTION(".region_ddr")
-static uint8_t eth_rx_buffer[ETH_IFACE_COUNT][ETH_RX_BUFFERS * ETH_RX_UNITSIZE];
+static uint8_t eth_rx_buffer[ETH_IFACE_COUNT][ETH_RX_BUFFERS * ETH_RX_BUFSIZE];
 
 /** TX callbacks list */
 static ethd_callback_t eth_tx_callback[ETH_IFACE_COUNT][ETH_TX_BUFFERS];
 
+/** TX release callbacks list, for frames sent without copy */
+static struct _eth_tx_release eth_tx_release[ETH_IFACE_COUNT][ETH_TX_BUFFERS];
+
+#ifdef CONFIG_GMAC_PRIO_QUEUES
+/** Priority queues TX descriptors list */
+ALIGNED(8) SECTION(".region_ddr_nocache")
+static struct _eth_desc eth_prio_txd[ETH_IFACE_COUNT][ETH_PRIO_QUEUES][ETH_PRIO_TX_BUFFERS];
+
+/** Priority queues RX descriptors list */
+ALIGNED(8) SECTION(".region_ddr_nocache")
+static struct _eth_desc eth_prio_rxd[ETH_IFACE_COUNT][ETH_PRIO_QUEUES][ETH_PRIO_RX_BUFFERS];
+
+/** Priority queues TX Buffers */
+ALIGNED(32) SECTION(".region_ddr")
+static uint8_t eth_prio_tx_buffer[ETH_IFACE_COUNT][ETH_PRIO_QUEUES][ETH_PRIO_TX_BUFFERS * ETH_TX_UNITSIZE];
+
+/** Priority queues RX Buffers */
+ALIGNED(32) SECTION(".region_ddr")
+static uint8_t eth_prio_rx_buffer[ETH_IFACE_COUNT][ETH_PRIO_QUEUES][ETH_PRIO_RX_BUFFERS * ETH_RX_BUFSIZE];
+
+/** Priority queues TX callbacks list */
+static ethd_callback_t eth_prio_tx_callback[ETH_IFACE_COUNT][ETH_PRIO_QUEUES][ETH_PRIO_TX_BUFFERS];
+#endif
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -184,9 +230,22 @@ void board_cfg_net(uint8_t iface)
 #endif /* BOARD_ETH1_ADDR */
 	}
 
-	ethd_setup_queue(&_ethd[iface], 0, ETH_RX_BUFFERS, eth_rx_buffer[iface], eth_rxd[iface],
+	ethd_setup_queue(&_ethd[iface], 0, ETH_RX_BUFFERS, ETH_RX_BUFSIZE, eth_rx_buffer[iface], eth_rxd[iface],
 			 ETH_TX_BUFFERS, eth_tx_buffer[iface], eth_txd[iface], eth_tx_callback[iface]);
+	ethd_setup_tx_release(&_ethd[iface], 0, eth_tx_release[iface]);
 	ethd_set_rx_callback(&_ethd[iface], 0, _eth_rx_callback);
+#ifdef CONFIG_GMAC_PRIO_QUEUES
+	/* The priority queues receive the frames matching the screeners
+	 * installed by the application */
+	int q;
+	for (q = 1; q <= ETH_PRIO_QUEUES; q++) {
+		ethd_setup_queue(&_ethd[iface], q,
+				 ETH_PRIO_RX_BUFFERS, ETH_RX_BUFSIZE, eth_prio_rx_buffer[iface][q - 1], eth_prio_rxd[iface][q - 1],
+				 ETH_PRIO_TX_BUFFERS, eth_prio_tx_buffer[iface][q - 1], eth_prio_txd[iface][q - 1],
+				 eth_prio_tx_callback[iface][q - 1]);
+		ethd_set_rx_callback(&_ethd[iface], q, _eth_rx_callback);
+	}
+#endif
 	ethd_set_mac_addr(&_ethd[iface], 0, _eth_mac_addr);
 	ethd_start(&_ethd[iface]);
 
@@ -144,7 +144,7 @@ irqHandler:
 
         ; Branch to interrupt handler in Supervisor mode
 
-        msr         CPSR_c, #ARM_MODE_SVC
+        msr         CPSR_c, #ARM_MODE_SVC | I_BIT
         stmfd       sp!, { r1-r3, r4, r12, lr}
 
         ; Check for 8-byte alignment and save lr plus a
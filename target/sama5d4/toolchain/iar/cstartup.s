@@ -80,6 +80,9 @@ F_BIT           DEFINE 0x40
         EXTERN  prefetch_abort_irq_handler
         EXTERN  data_abort_irq_handler
         EXTERN  software_interrupt_irq_handler
+#ifdef CONFIG_IRQ_STATS
+        EXTERN  irq_entry_cycles
+#endif
 
         DATA
 
@@ -165,6 +168,14 @@ irqHandler:
         mrs         lr, SPSR
         stmfd       sp!, {r0, lr}
 
+#ifdef CONFIG_IRQ_STATS
+        ; Record the cycle counter for the entry latency statistics
+
+        mrc         p15, 0, lr, c9, c13, 0
+        ldr         r0, =irq_entry_cycles
+        str         lr, [r0]
+#endif
+
         ; Write in the IVR to support Protect Mode
 
         ldr         lr, =AT91C_BASE_AIC
@@ -175,7 +186,7 @@ irqHandler:
 
         ; Branch to interrupt handler in Supervisor mode
 
-        msr         CPSR_c, #ARM_MODE_SVC
+        msr         CPSR_c, #ARM_MODE_SVC | I_BIT
         stmfd       sp!, { r1-r3, r4, r12, lr}
 
         ; Check for 8-byte alignment and save lr plus a
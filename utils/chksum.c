@@ -0,0 +1,271 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file */
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include "chksum.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/*------------------------------------------------------------------------------
+ *         Local definitions
+ *------------------------------------------------------------------------------*/
+
+#if defined(__GNUC__) && defined(__arm__) && !defined(__thumb__)
+/* Sum 32-byte blocks with an add-with-carry chain */
+#define CHKSUM_ARM_ASM
+#if defined(CONFIG_SOC_SAMA5D2) || defined(CONFIG_SOC_SAMA5D4)
+/* Sum 64-byte blocks with NEON pairwise additions into 64-bit lanes. The
+ * Cortex-A5 of SAMA5D3 has no NEON unit. */
+#define CHKSUM_NEON_ASM
+#endif
+#endif
+
+/*------------------------------------------------------------------------------
+ *         Local types
+ *------------------------------------------------------------------------------*/
+
+/* Words read from byte buffers */
+#if defined(__GNUC__)
+typedef uint16_t __attribute__((may_alias)) _chksum_u16_t;
+typedef uint32_t __attribute__((may_alias)) _chksum_u32_t;
+#else
+typedef uint16_t _chksum_u16_t;
+typedef uint32_t _chksum_u32_t;
+#endif
+
+/*------------------------------------------------------------------------------
+ *         Local functions
+ *------------------------------------------------------------------------------*/
+
+/**
+ * \brief Fold a sum of 32-bit words into a 16-bit ones' complement sum.
+ */
+static uint16_t _chksum_fold(uint64_t sum)
+{
+	uint32_t s;
+
+	sum = (sum & 0xffffffffu) + (sum >> 32);
+	sum = (sum & 0xffffffffu) + (sum >> 32);
+	s = (uint32_t)sum;
+	s = (s & 0xffff) + (s >> 16);
+	s = (s & 0xffff) + (s >> 16);
+	return (uint16_t)s;
+}
+
+/**
+ * \brief Sum the 32-bit words of a word-aligned buffer.
+ * \param w Start of the buffer, updated.
+ * \param len Length of the buffer, updated with the remaining bytes (< 4).
+ */
+static uint64_t _chksum_words(const _chksum_u32_t** w, uint32_t* len)
+{
+	const _chksum_u32_t* p = *w;
+	uint32_t n = *len;
+	uint64_t sum = 0;
+
+#ifdef CHKSUM_NEON_ASM
+	/* As for any VFP code here, the registers are not saved on exception
+	 * entry: interrupt handlers must not use the FPU */
+	if (n >= 64) {
+		uint32_t blocks = n / 64;
+		uint64_t acc;
+
+		n &= 63;
+		__asm__ (
+			".fpu   neon\n\t"
+			"vmov.i64 q4, #0\n\t"
+			"vmov.i64 q5, #0\n\t"
+			"1:\n\t"
+			"vld1.32 {d0-d3}, [%[p]]!\n\t"
+			"vld1.32 {d4-d7}, [%[p]]!\n\t"
+			"vpadal.u32 q4, q0\n\t"
+			"vpadal.u32 q5, q1\n\t"
+			"vpadal.u32 q4, q2\n\t"
+			"vpadal.u32 q5, q3\n\t"
+			"subs   %[n], %[n], #1\n\t"
+			"bne    1b\n\t"
+			"vadd.i64 q4, q4, q5\n\t"
+			"vadd.i64 d8, d8, d9\n\t"
+			"vmov   %Q[acc], %R[acc], d8\n\t"
+			: [acc] "=r" (acc), [p] "+r" (p), [n] "+r" (blocks)
+			:
+			: "d0", "d1", "d2", "d3", "d4", "d5", "d6", "d7",
+			  "d8", "d9", "d10", "d11", "cc", "memory");
+		sum = acc;
+	}
+#endif
+
+#ifdef CHKSUM_ARM_ASM
+	if (n >= 32) {
+		uint32_t blocks = n / 32;
+		uint32_t acc = 0;
+
+		n &= 31;
+		__asm__ (
+			"adds   %[acc], %[acc], #0\n\t"
+			"1:\n\t"
+			"ldmia  %[p]!, {r4, r5, r6, r8}\n\t"
+			"adcs   %[acc], %[acc], r4\n\t"
+			"adcs   %[acc], %[acc], r5\n\t"
+			"adcs   %[acc], %[acc], r6\n\t"
+			"adcs   %[acc], %[acc], r8\n\t"
+			"ldmia  %[p]!, {r4, r5, r6, r8}\n\t"
+			"adcs   %[acc], %[acc], r4\n\t"
+			"adcs   %[acc], %[acc], r5\n\t"
+			"adcs   %[acc], %[acc], r6\n\t"
+			"adcs   %[acc], %[acc], r8\n\t"
+			"sub    %[n], %[n], #1\n\t"
+			"teq    %[n], #0\n\t"
+			"bne    1b\n\t"
+			"adc    %[acc], %[acc], #0\n\t"
+			: [acc] "+r" (acc), [p] "+r" (p), [n] "+r" (blocks)
+			:
+			: "r4", "r5", "r6", "r8", "cc", "memory");
+		sum += acc;
+	}
+#endif
+
+	/* Carries accumulate in the upper word and are folded at the end */
+	while (n >= 16) {
+		sum += p[0];
+		sum += p[1];
+		sum += p[2];
+		sum += p[3];
+		p += 4;
+		n -= 16;
+	}
+	while (n >= 4) {
+		sum += *p++;
+		n -= 4;
+	}
+
+	*w = p;
+	*len = n;
+	return sum;
+}
+
+/**
+ * \brief Sum the last bytes (< 4) of a buffer, starting at an even offset.
+ */
+static uint32_t _chksum_tail(const uint8_t* p, uint32_t len)
+{
+	uint16_t t = 0;
+	uint32_t sum = 0;
+
+	if (len >= 2) {
+		sum += *(const _chksum_u16_t*)p;
+		p += 2;
+		len -= 2;
+	}
+	if (len) {
+		((uint8_t*)&t)[0] = *p;
+		sum += t;
+	}
+	return sum;
+}
+
+/*------------------------------------------------------------------------------
+ *         Exported functions
+ *------------------------------------------------------------------------------*/
+
+uint16_t chksum_compute(const void* data, uint32_t len)
+{
+	const uint8_t* p = (const uint8_t*)data;
+	const _chksum_u32_t* w;
+	uint64_t sum = 0;
+	uint16_t t = 0;
+	uint16_t res;
+	bool odd = ((uint32_t)p & 1) != 0;
+
+	/* Start at an even address: the first byte is the second one of a
+	 * 16-bit word, the sum is byte-swapped at the end */
+	if (odd && len) {
+		((uint8_t*)&t)[1] = *p++;
+		sum = t;
+		len--;
+	}
+
+	/* Start at a word-aligned address */
+	if (((uint32_t)p & 2) && len >= 2) {
+		sum += *(const _chksum_u16_t*)p;
+		p += 2;
+		len -= 2;
+	}
+
+	w = (const _chksum_u32_t*)p;
+	sum += _chksum_words(&w, &len);
+	sum += _chksum_tail((const uint8_t*)w, len);
+
+	res = _chksum_fold(sum);
+	if (odd)
+		res = (uint16_t)((res << 8) | (res >> 8));
+	return res;
+}
+
+uint16_t chksum_copy(void* dst, const void* src, uint32_t len)
+{
+	const _chksum_u32_t* s = (const _chksum_u32_t*)src;
+	_chksum_u32_t* d = (_chksum_u32_t*)dst;
+	uint64_t sum = 0;
+
+	if (((uint32_t)dst & 3) || ((uint32_t)src & 3)) {
+		memcpy(dst, src, len);
+		return chksum_compute(dst, len);
+	}
+
+	while (len >= 16) {
+		uint32_t w0 = s[0], w1 = s[1], w2 = s[2], w3 = s[3];
+		d[0] = w0;
+		d[1] = w1;
+		d[2] = w2;
+		d[3] = w3;
+		sum += w0;
+		sum += w1;
+		sum += w2;
+		sum += w3;
+		s += 4;
+		d += 4;
+		len -= 16;
+	}
+	while (len >= 4) {
+		sum += *s;
+		*d++ = *s++;
+		len -= 4;
+	}
+	memcpy(d, s, len);
+	sum += _chksum_tail((const uint8_t*)d, len);
+
+	return _chksum_fold(sum);
+}
@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*------------------------------------------------------------------------------
+ *  \file
+ *
+ *  \section Purpose
+ *  Internet checksum (RFC 1071) computation, shared by the network stacks.
+ *
+ *  The 16-bit ones' complement sum is computed on the data as stored in
+ *  memory, so the value returned by chksum_compute() and chksum_copy() is in
+ *  network byte order once stored into memory. The data can start at any
+ *  address.
+ *
+ *------------------------------------------------------------------------------*/
+
+#ifndef CHKSUM_H_
+#define CHKSUM_H_
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*------------------------------------------------------------------------------
+ *         Exported functions
+ *------------------------------------------------------------------------------*/
+
+/**
+ * \brief Compute the ones' complement sum of a buffer, not inverted.
+ * \param data Start of the buffer.
+ * \param len Length of the buffer in bytes.
+ * \return 16-bit sum, in the byte order of the data.
+ */
+extern uint16_t chksum_compute(const void* data, uint32_t len);
+
+/**
+ * \brief Copy a buffer and compute its ones' complement sum in the same
+ * pass, when both buffers are word-aligned.
+ * \param dst Destination buffer.
+ * \param src Source buffer.
+ * \param len Length of the buffers in bytes.
+ * \return 16-bit sum, in the byte order of the data.
+ */
+extern uint16_t chksum_copy(void* dst, const void* src, uint32_t len);
+
+/**
+ * \brief Add two 16-bit ones' complement sums.
+ */
+static inline uint16_t chksum_add(uint16_t a, uint16_t b)
+{
+	uint32_t sum = (uint32_t)a + b;
+	return (uint16_t)((sum & 0xffff) + (sum >> 16));
+}
+
+#endif /* CHKSUM_H_ */
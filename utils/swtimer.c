@@ -0,0 +1,251 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *  Hierarchical timer wheel.
+ *
+ *  Level L slot S holds the timers expiring in the range of ticks whose bits
+ *  [L*SWTIMER_SLOT_BITS, (L+1)*SWTIMER_SLOT_BITS) equal S, relative to the
+ *  wheel clock. When the clock enters a new lap of level L-1, the matching
+ *  slot of level L is cascaded: its timers are inserted again, landing in
+ *  lower levels. A timer is thus moved at most SWTIMER_LEVELS-1 times.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "swtimer.h"
+#include "timer.h"
+
+#include <stddef.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define SLOT_MASK (SWTIMER_SLOTS - 1)
+
+#define LEVEL_SHIFT(level) ((level) * SWTIMER_SLOT_BITS)
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct {
+	bool started;
+	uint64_t clk;		/* next tick to process */
+	uint32_t pending[SWTIMER_LEVELS];
+	struct _swtimer* slots[SWTIMER_LEVELS][SWTIMER_SLOTS];
+} _wheel;
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _start(void)
+{
+	if (!_wheel.started) {
+		_wheel.clk = timer_get_tick();
+		_wheel.started = true;
+	}
+}
+
+static void _list_add(struct _swtimer** head, struct _swtimer* timer)
+{
+	timer->next = *head;
+	if (timer->next)
+		timer->next->pprev = &timer->next;
+	timer->pprev = head;
+	*head = timer;
+}
+
+static void _list_del(struct _swtimer* timer)
+{
+	*timer->pprev = timer->next;
+	if (timer->next)
+		timer->next->pprev = timer->pprev;
+	timer->next = NULL;
+	timer->pprev = NULL;
+}
+
+static void _insert(struct _swtimer* timer)
+{
+	uint64_t expires = timer->expires;
+	uint64_t delta;
+	uint8_t level;
+
+	if (expires < _wheel.clk)
+		expires = _wheel.clk;
+	delta = expires - _wheel.clk;
+	if (delta > SWTIMER_MAX_DELAY) {
+		/* parked in the last level, re-cascaded when reached */
+		delta = SWTIMER_MAX_DELAY;
+		expires = _wheel.clk + delta;
+	}
+
+	for (level = 0; level < SWTIMER_LEVELS - 1; level++)
+		if (delta < (1ull << LEVEL_SHIFT(level + 1)))
+			break;
+
+	timer->level = level;
+	_wheel.pending[level]++;
+	_list_add(&_wheel.slots[level][(expires >> LEVEL_SHIFT(level)) & SLOT_MASK], timer);
+}
+
+static void _remove(struct _swtimer* timer)
+{
+	_wheel.pending[timer->level]--;
+	_list_del(timer);
+}
+
+/* Returns the index of the cascaded slot */
+static uint32_t _cascade(uint8_t level)
+{
+	uint32_t index = (_wheel.clk >> LEVEL_SHIFT(level)) & SLOT_MASK;
+	struct _swtimer* timer;
+
+	while ((timer = _wheel.slots[level][index]) != NULL) {
+		_remove(timer);
+		_insert(timer);
+	}
+	return index;
+}
+
+static bool _wheel_is_empty(void)
+{
+	uint8_t level;
+
+	for (level = 0; level < SWTIMER_LEVELS; level++)
+		if (_wheel.pending[level])
+			return false;
+	return true;
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+void swtimer_init(struct _swtimer* timer, callback_method_t method, void* arg)
+{
+	timer->next = NULL;
+	timer->pprev = NULL;
+	timer->expires = 0;
+	timer->level = 0;
+	callback_set(&timer->cb, method, arg);
+}
+
+void swtimer_arm(struct _swtimer* timer, uint32_t delay)
+{
+	uint64_t now = timer_get_tick();
+	uint32_t mask = irq_disable_save();
+
+	_start();
+	/* the wheel may be ahead of the system tick when driven by
+	 * swtimer_advance() */
+	if (now + 1 < _wheel.clk)
+		now = _wheel.clk - 1;
+
+	if (timer->pprev)
+		_remove(timer);
+	timer->expires = now + delay;
+	_insert(timer);
+	irq_restore(mask);
+}
+
+void swtimer_cancel(struct _swtimer* timer)
+{
+	uint32_t mask = irq_disable_save();
+
+	if (timer->pprev)
+		_remove(timer);
+	irq_restore(mask);
+}
+
+bool swtimer_is_pending(const struct _swtimer* timer)
+{
+	return timer->pprev != NULL;
+}
+
+uint32_t swtimer_advance(uint64_t tick)
+{
+	uint32_t count = 0;
+	uint32_t mask = irq_disable_save();
+
+	_start();
+	while (_wheel.clk <= tick) {
+		uint32_t index = _wheel.clk & SLOT_MASK;
+		struct _swtimer* expired;
+		uint8_t level;
+
+		if (_wheel_is_empty()) {
+			_wheel.clk = tick + 1;
+			break;
+		}
+
+		if (index == 0) {
+			for (level = 1; level < SWTIMER_LEVELS; level++)
+				if (_cascade(level) != 0)
+					break;
+		} else if (_wheel.pending[0] == 0) {
+			/* nothing to run before the next cascade */
+			uint64_t next = (_wheel.clk | SLOT_MASK) + 1;
+			_wheel.clk = next <= tick ? next : tick + 1;
+			continue;
+		}
+
+		/* move the expired timers to a local list, so that callbacks
+		 * can still cancel them */
+		expired = _wheel.slots[0][index];
+		_wheel.slots[0][index] = NULL;
+		if (expired)
+			expired->pprev = &expired;
+		_wheel.clk++;
+
+		while (expired) {
+			struct _swtimer* timer = expired;
+
+			_remove(timer);
+			irq_restore(mask);
+			callback_call(&timer->cb);
+			count++;
+			mask = irq_disable_save();
+		}
+	}
+	irq_restore(mask);
+
+	return count;
+}
+
+uint32_t swtimer_process(void)
+{
+	return swtimer_advance(timer_get_tick());
+}
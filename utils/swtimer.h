@@ -0,0 +1,144 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *
+ *  \par Purpose
+ *
+ *  Software timers running callbacks after a delay, on top of the system
+ *  timer (see timer.h).
+ *
+ *  Timers are kept in a hierarchical timer wheel: SWTIMER_LEVELS levels of
+ *  SWTIMER_SLOTS slots, each level covering SWTIMER_SLOTS times the range of
+ *  the previous one. Arming and cancelling a timer are O(1). Processing a
+ *  tick only looks at one slot, and timers of upper levels are moved down
+ *  ("cascaded") once per lap of the level below.
+ *
+ *  \par Usage
+ *
+ *  -# Initialize each timer once with swtimer_init().
+ *  -# Arm it with swtimer_arm() (this also re-arms a pending timer), or
+ *     cancel it with swtimer_cancel(). Both can be used from interrupt
+ *     context.
+ *  -# Call swtimer_process() periodically from a deferred context (main
+ *     loop, work queue): expired callbacks are run from there, never from an
+ *     interrupt handler. A callback may re-arm or cancel any timer.
+ */
+
+#ifndef SWTIMER_H_
+#define SWTIMER_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "callback.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Definitions
+ *----------------------------------------------------------------------------*/
+
+/** log2 of the number of slots per level */
+#define SWTIMER_SLOT_BITS 6
+
+/** Number of slots per level */
+#define SWTIMER_SLOTS (1 << SWTIMER_SLOT_BITS)
+
+/** Number of levels */
+#define SWTIMER_LEVELS 4
+
+/** Longest delay (in ticks) handled without re-cascading: longer delays are
+ * supported but cost one extra cascade per range */
+#define SWTIMER_MAX_DELAY ((1ull << (SWTIMER_LEVELS * SWTIMER_SLOT_BITS)) - 1)
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+struct _swtimer {
+	struct _swtimer* next;
+	struct _swtimer** pprev;	/**< NULL when not pending */
+	uint64_t expires;		/**< tick of expiration */
+	uint8_t level;			/**< wheel level while pending */
+	struct _callback cb;
+};
+
+/*----------------------------------------------------------------------------
+ *         Global functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a software timer.
+ *
+ * \param timer  Timer to initialize
+ * \param method Callback invoked on expiration
+ * \param arg    Argument of the callback
+ */
+extern void swtimer_init(struct _swtimer* timer, callback_method_t method, void* arg);
+
+/**
+ * \brief Arm a timer to expire in delay ticks.
+ *
+ * If the timer is pending, it is first cancelled.
+ *
+ * \param timer Timer to arm
+ * \param delay Delay in ticks (units of timer_get_tick())
+ */
+extern void swtimer_arm(struct _swtimer* timer, uint32_t delay);
+
+/**
+ * \brief Cancel a timer. Does nothing if the timer is not pending.
+ */
+extern void swtimer_cancel(struct _swtimer* timer);
+
+/**
+ * \brief Tells if a timer is armed and has not expired yet.
+ */
+extern bool swtimer_is_pending(const struct _swtimer* timer);
+
+/**
+ * \brief Run the callbacks of the timers expired up to tick.
+ *
+ * \param tick Tick up to which (included) timers are processed
+ * \return Number of callbacks invoked
+ */
+extern uint32_t swtimer_advance(uint64_t tick);
+
+/**
+ * \brief Run the callbacks of the timers expired up to the current tick.
+ *
+ * \return Number of callbacks invoked
+ */
+extern uint32_t swtimer_process(void);
+
+#endif /* SWTIMER_H_ */
@@ -0,0 +1,243 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Host test of the Internet checksum (chksum.c) against a byte by byte
+ * RFC 1071 reference, for every length up to a few hundred bytes and every
+ * alignment of the source and destination buffers, followed by a throughput
+ * measurement of the optimized functions against the reference.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chksum.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+			failures++; \
+		} \
+	} while (0)
+
+#define MAX_LEN 70000
+
+#define BENCH_LEN 1500
+#define BENCH_BYTES (256u * 1024 * 1024)
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+static int failures;
+
+static uint32_t seed = 0x2545f491;
+
+static uint8_t src_buf[MAX_LEN + 16] __attribute__((aligned(64)));
+static uint8_t dst_buf[MAX_LEN + 16] __attribute__((aligned(64)));
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t _random(void)
+{
+	/* xorshift32 */
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/* RFC 1071 sum of big-endian 16-bit words, odd byte padded with zero */
+static uint16_t _ref_sum(const uint8_t* p, uint32_t len)
+{
+	uint64_t sum = 0;
+	uint32_t i;
+
+	for (i = 0; i + 1 < len; i += 2)
+		sum += (p[i] << 8) | p[i + 1];
+	if (len & 1)
+		sum += p[len - 1] << 8;
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)sum;
+}
+
+/* Compare a sum in data byte order with a reference in host order */
+static int _same_sum(uint16_t sum, uint16_t ref)
+{
+	uint8_t b[2];
+
+	memcpy(b, &sum, 2);
+	return b[0] == (ref >> 8) && b[1] == (ref & 0xff);
+}
+
+static void _fill_random(uint8_t* p, uint32_t len)
+{
+	while (len--)
+		*p++ = (uint8_t)_random();
+}
+
+static double _now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_compute(void)
+{
+	uint32_t len, off;
+
+	printf("chksum_compute: lengths 0-320, offsets 0-7\n");
+
+	_fill_random(src_buf, sizeof(src_buf));
+	for (off = 0; off < 8; off++)
+		for (len = 0; len <= 320; len++)
+			CHECK(_same_sum(chksum_compute(src_buf + off, len),
+					_ref_sum(src_buf + off, len)));
+
+	printf("chksum_compute: long buffers, carries\n");
+
+	for (off = 0; off < 4; off++) {
+		CHECK(_same_sum(chksum_compute(src_buf + off, 1514),
+				_ref_sum(src_buf + off, 1514)));
+		CHECK(_same_sum(chksum_compute(src_buf + off, MAX_LEN - off),
+				_ref_sum(src_buf + off, MAX_LEN - off)));
+	}
+
+	/* All ones: every addition carries */
+	memset(src_buf, 0xff, sizeof(src_buf));
+	for (off = 0; off < 4; off++)
+		for (len = 0; len <= 130; len++)
+			CHECK(_same_sum(chksum_compute(src_buf + off, len),
+					_ref_sum(src_buf + off, len)));
+	CHECK(_same_sum(chksum_compute(src_buf, MAX_LEN),
+			_ref_sum(src_buf, MAX_LEN)));
+
+	memset(src_buf, 0, sizeof(src_buf));
+	CHECK(chksum_compute(src_buf, MAX_LEN) == 0);
+}
+
+static void test_copy(void)
+{
+	uint32_t len, soff, doff;
+	uint16_t sum;
+
+	printf("chksum_copy: lengths 0-200, offsets 0-3\n");
+
+	_fill_random(src_buf, sizeof(src_buf));
+	for (soff = 0; soff < 4; soff++) {
+		for (doff = 0; doff < 4; doff++) {
+			for (len = 0; len <= 200; len++) {
+				memset(dst_buf, 0xa5, len + 8);
+				sum = chksum_copy(dst_buf + doff, src_buf + soff, len);
+				CHECK(_same_sum(sum, _ref_sum(src_buf + soff, len)));
+				CHECK(memcmp(dst_buf + doff, src_buf + soff, len) == 0);
+				/* nothing written past the end */
+				CHECK(dst_buf[doff + len] == 0xa5);
+			}
+		}
+	}
+
+	sum = chksum_copy(dst_buf, src_buf, MAX_LEN);
+	CHECK(_same_sum(sum, _ref_sum(src_buf, MAX_LEN)));
+	CHECK(memcmp(dst_buf, src_buf, MAX_LEN) == 0);
+}
+
+/*----------------------------------------------------------------------------
+ *        Throughput
+ *----------------------------------------------------------------------------*/
+
+static void bench(void)
+{
+	uint32_t i, rounds = BENCH_BYTES / BENCH_LEN;
+	volatile uint16_t sink = 0;
+	double t, ref, compute, copy;
+
+	_fill_random(src_buf, BENCH_LEN);
+
+	t = _now();
+	for (i = 0; i < rounds / 8; i++)
+		sink += _ref_sum(src_buf, BENCH_LEN);
+	ref = (_now() - t) * 8;
+
+	t = _now();
+	for (i = 0; i < rounds; i++)
+		sink += chksum_compute(src_buf, BENCH_LEN);
+	compute = _now() - t;
+
+	t = _now();
+	for (i = 0; i < rounds; i++)
+		sink += chksum_copy(dst_buf, src_buf, BENCH_LEN);
+	copy = _now() - t;
+	(void)sink;
+
+	printf("throughput on %u-byte buffers (MB/s): reference %.0f, "
+	       "chksum_compute %.0f, chksum_copy %.0f\n", BENCH_LEN,
+	       BENCH_BYTES / ref / 1e6, BENCH_BYTES / compute / 1e6,
+	       BENCH_BYTES / copy / 1e6);
+}
+
+/*----------------------------------------------------------------------------
+ *        Main
+ *----------------------------------------------------------------------------*/
+
+int main(void)
+{
+	test_compute();
+	test_copy();
+	bench();
+
+	if (failures) {
+		printf("%d check(s) failed\n", failures);
+		return EXIT_FAILURE;
+	}
+	printf("all checks passed\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,425 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Host test of the software timer wheel (swtimer.c), driven by a simulated
+ * system tick. Timers must expire at their exact tick whatever the wheel
+ * level they are armed in, including delays longer than SWTIMER_MAX_DELAY
+ * that are parked and cascaded again, and callbacks must be able to re-arm
+ * or cancel any timer, including the ones expiring in the same tick.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "swtimer.h"
+#include "timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			printf("  FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+			failures++; \
+		} \
+	} while (0)
+
+#define RANDOM_TIMERS 2000
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+struct test_timer {
+	struct _swtimer timer;
+	uint64_t expires;	/* expected expiration tick */
+	uint64_t fired_at;	/* tick of the last callback */
+	uint32_t fired;		/* number of callbacks */
+	uint32_t period;	/* re-armed from the callback when not 0 */
+	uint32_t rearms;	/* number of re-arms left */
+	struct test_timer* cancel;	/* cancelled from the callback */
+	struct test_timer* arm;		/* armed from the callback */
+	uint32_t arm_delay;
+};
+
+/*----------------------------------------------------------------------------
+ *        Variables
+ *----------------------------------------------------------------------------*/
+
+int irq_mask_depth;
+
+static int failures;
+
+/* simulated system tick, see timer_get_tick() */
+static uint64_t now;
+
+/* tick being processed by _run_to() when stepping one tick at a time */
+static uint64_t current;
+
+static uint32_t seed = 0x2545f491;
+
+/*----------------------------------------------------------------------------
+ *        Simulated system timer
+ *----------------------------------------------------------------------------*/
+
+uint64_t timer_get_tick(void)
+{
+	return now;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t _random(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static int _callback(void* arg)
+{
+	struct test_timer* t = arg;
+
+	CHECK(irq_mask_depth == 0);
+	CHECK(!swtimer_is_pending(&t->timer));
+	t->fired++;
+	t->fired_at = current;
+
+	if (t->cancel)
+		swtimer_cancel(&t->cancel->timer);
+	if (t->arm) {
+		t->arm->expires = now + t->arm_delay;
+		swtimer_arm(&t->arm->timer, t->arm_delay);
+	}
+	if (t->period && t->rearms) {
+		t->rearms--;
+		t->expires = now + t->period;
+		swtimer_arm(&t->timer, t->period);
+	}
+	return 0;
+}
+
+static void _init(struct test_timer* t)
+{
+	memset(t, 0, sizeof(*t));
+	swtimer_init(&t->timer, _callback, t);
+}
+
+static void _arm(struct test_timer* t, uint32_t delay)
+{
+	t->expires = now + delay;
+	swtimer_arm(&t->timer, delay);
+}
+
+/* Move the system tick to tick and process the wheel, in one step */
+static uint32_t _jump_to(uint64_t tick)
+{
+	now = tick;
+	current = tick;
+	return swtimer_process();
+}
+
+/* Move the system tick to tick one tick at a time */
+static uint32_t _run_to(uint64_t tick)
+{
+	uint32_t count = 0;
+
+	while (now < tick) {
+		now++;
+		current = now;
+		count += swtimer_process();
+	}
+	return count;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+/* A timer of each level expires at its tick, neither before nor after */
+static void test_levels(void)
+{
+	static const uint32_t delays[] = {
+		1, 2, SWTIMER_SLOTS - 1, SWTIMER_SLOTS, SWTIMER_SLOTS + 1,
+		SWTIMER_SLOTS * SWTIMER_SLOTS - 1, SWTIMER_SLOTS * SWTIMER_SLOTS,
+		SWTIMER_SLOTS * SWTIMER_SLOTS + 1, 100000, 1u << 18, 1u << 20,
+		3000000, SWTIMER_MAX_DELAY - 1, SWTIMER_MAX_DELAY,
+	};
+	struct test_timer t;
+	uint32_t i, phase;
+
+	printf("levels\n");
+	for (phase = 0; phase < 3; phase++) {
+		/* arm from various positions of the wheel clock */
+		_run_to(now + 1 + phase * 37);
+		for (i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+			_init(&t);
+			_arm(&t, delays[i]);
+			CHECK(swtimer_is_pending(&t.timer));
+			CHECK(_jump_to(t.expires - 1) == 0);
+			CHECK(t.fired == 0);
+			CHECK(_jump_to(t.expires) == 1);
+			CHECK(t.fired == 1);
+			CHECK(!swtimer_is_pending(&t.timer));
+			CHECK(_jump_to(now + 1) == 0);
+		}
+	}
+
+	/* the current tick is already processed: no delay means the next
+	 * one */
+	_init(&t);
+	_arm(&t, 0);
+	CHECK(_jump_to(now) == 0);
+	CHECK(_jump_to(now + 1) == 1);
+	CHECK(t.fired == 1);
+}
+
+/* Delays beyond SWTIMER_MAX_DELAY are parked in the last level and cascaded
+ * again until they expire */
+static void test_long_delays(void)
+{
+	static const uint32_t delays[] = {
+		SWTIMER_MAX_DELAY + 1, SWTIMER_MAX_DELAY + 1000,
+		3 * SWTIMER_MAX_DELAY + 5, 0xffffffff,
+	};
+	struct test_timer t[4];
+	uint64_t start = now;
+	uint32_t i;
+
+	printf("delays beyond SWTIMER_MAX_DELAY\n");
+	for (i = 0; i < 4; i++) {
+		_init(&t[i]);
+		_arm(&t[i], delays[i]);
+	}
+	for (i = 0; i < 4; i++) {
+		CHECK(_jump_to(t[i].expires - 1) == 0);
+		CHECK(t[i].fired == 0);
+		CHECK(_jump_to(t[i].expires) == 1);
+		CHECK(t[i].fired == 1);
+	}
+	CHECK(now - start == 0xffffffff);
+
+	/* the same, stepping the wheel one tick at a time */
+	_init(&t[0]);
+	_arm(&t[0], SWTIMER_MAX_DELAY + 77);
+	CHECK(_run_to(t[0].expires) == 1);
+	CHECK(t[0].fired_at == t[0].expires);
+}
+
+/* Many timers in all levels, armed and cancelled while the wheel turns:
+ * after each step, exactly the timers due have fired */
+static void test_random(void)
+{
+	static struct test_timer t[RANDOM_TIMERS];
+	uint64_t end;
+	uint32_t i, round;
+
+	printf("random timers\n");
+	for (i = 0; i < RANDOM_TIMERS; i++)
+		_init(&t[i]);
+
+	for (round = 0; round < 200; round++) {
+		/* arm, re-arm or cancel a few timers */
+		for (i = 0; i < 50; i++) {
+			struct test_timer* r = &t[_random() % RANDOM_TIMERS];
+			uint32_t delay;
+
+			switch (_random() % 4) {
+			case 0:
+				delay = _random() % SWTIMER_SLOTS;
+				break;
+			case 1:
+				delay = _random() % (SWTIMER_SLOTS * SWTIMER_SLOTS);
+				break;
+			case 2:
+				delay = _random() % (1u << 20);
+				break;
+			default:
+				delay = _random() % (SWTIMER_MAX_DELAY * 2);
+				break;
+			}
+			if (_random() % 8 == 0) {
+				swtimer_cancel(&r->timer);
+				r->expires = 0;
+			} else {
+				_arm(r, delay);
+			}
+			r->fired = 0;
+		}
+
+		/* then advance, by steps of one tick up to a whole lap of the
+		 * upper level */
+		switch (_random() % 3) {
+		case 0:
+			_run_to(now + 1 + _random() % 200);
+			break;
+		case 1:
+			_jump_to(now + 1 + _random() % 100000);
+			break;
+		default:
+			_jump_to(now + 1 + _random() % (SWTIMER_MAX_DELAY * 2));
+			break;
+		}
+
+		for (i = 0; i < RANDOM_TIMERS; i++) {
+			if (!t[i].expires)
+				continue;
+			if (t[i].expires <= now) {
+				CHECK(t[i].fired == 1);
+				CHECK(!swtimer_is_pending(&t[i].timer));
+				t[i].expires = 0;
+			} else {
+				CHECK(t[i].fired == 0);
+				CHECK(swtimer_is_pending(&t[i].timer));
+			}
+		}
+	}
+
+	/* drain the wheel */
+	end = now;
+	for (i = 0; i < RANDOM_TIMERS; i++)
+		if (t[i].expires > end)
+			end = t[i].expires;
+	_jump_to(end);
+	for (i = 0; i < RANDOM_TIMERS; i++)
+		CHECK(!swtimer_is_pending(&t[i].timer));
+}
+
+/* Callbacks re-arming or cancelling timers */
+static void test_callbacks(void)
+{
+	struct test_timer a, b, c, d;
+	uint64_t start;
+	uint32_t i;
+
+	printf("re-arm and cancel from callbacks\n");
+
+	/* periodic timer re-armed from its callback, with a period crossing
+	 * the levels */
+	_init(&a);
+	a.period = SWTIMER_SLOTS + 3;
+	a.rearms = 100;
+	start = now;
+	_arm(&a, a.period);
+	for (i = 1; i <= 101; i++) {
+		CHECK(_run_to(start + i * a.period) == 1);
+		CHECK(a.fired == i);
+		CHECK(a.fired_at == start + i * a.period);
+	}
+	CHECK(!swtimer_is_pending(&a.timer));
+
+	/* re-armed with no delay from its callback: runs again on the next
+	 * tick, not in a loop */
+	_init(&a);
+	a.period = 0;
+	a.arm = &a;
+	a.arm_delay = 0;
+	_arm(&a, 5);
+	CHECK(_run_to(now + 5) == 1);
+	CHECK(_run_to(now + 1) == 1);
+	CHECK(_run_to(now + 1) == 1);
+	CHECK(a.fired == 3);
+	swtimer_cancel(&a.timer);
+	CHECK(_run_to(now + 10) == 0);
+
+	/* two timers expiring on the same tick, each cancelling the other:
+	 * only the first one run fires */
+	_init(&a);
+	_init(&b);
+	a.cancel = &b;
+	b.cancel = &a;
+	_arm(&a, 1000);
+	_arm(&b, 1000);
+	CHECK(_jump_to(now + 1000) == 1);
+	CHECK(a.fired + b.fired == 1);
+	CHECK(!swtimer_is_pending(&a.timer));
+	CHECK(!swtimer_is_pending(&b.timer));
+
+	/* a callback cancelling a timer of an upper level, and re-arming an
+	 * expired timer of the same tick further away */
+	_init(&a);
+	_init(&b);
+	_init(&c);
+	_init(&d);
+	a.cancel = &b;
+	a.arm = &c;
+	a.arm_delay = 300000;
+	_arm(&a, 10);
+	_arm(&b, 200000);
+	_arm(&c, 10);
+	_arm(&d, 400000);
+	CHECK(_run_to(now + 10) == 2);
+	CHECK(a.fired == 1);
+	CHECK(!swtimer_is_pending(&b.timer));
+	/* c may have run before a re-armed it */
+	CHECK(swtimer_is_pending(&c.timer));
+	CHECK(_jump_to(c.expires - 1) == 0);
+	CHECK(_jump_to(c.expires) == 1);
+	CHECK(c.fired_at == c.expires);
+	CHECK(_jump_to(d.expires) == 1);
+	CHECK(b.fired == 0);
+	CHECK(d.fired == 1);
+}
+
+/*----------------------------------------------------------------------------
+ *        Main
+ *----------------------------------------------------------------------------*/
+
+int main(void)
+{
+	now = 1000;
+
+	test_levels();
+	test_long_delays();
+	test_random();
+	test_callbacks();
+
+	CHECK(irq_mask_depth == 0);
+
+	if (failures) {
+		printf("%d check(s) failed\n", failures);
+		return EXIT_FAILURE;
+	}
+	printf("all checks passed\n");
+	return EXIT_SUCCESS;
+}
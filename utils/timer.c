@@ -29,7 +29,14 @@
 
 /**
  *  \file
- *  Implement simple TC usage as system tick.
+ *  Implement a tickless system timer on top of a TC channel.
+ *
+ *  The TC counter runs freely on its fastest clock and is extended in
+ *  software to 64 bits: each read compares the counter with the previous
+ *  value to detect wrap-arounds. The overflow interrupt guarantees that the
+ *  counter is read at least once per wrap. Sleeping functions program a
+ *  one-shot RA compare interrupt for their deadline instead of relying on a
+ *  periodic tick.
  */
 
 /*----------------------------------------------------------------------------
@@ -45,6 +52,13 @@
 #include <assert.h>
 #include <string.h>
 
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define NSEC_PER_SEC 1000000000ull
+#define USEC_PER_SEC 1000000ull
+
 /*----------------------------------------------------------------------------
  *         Local variables
  *----------------------------------------------------------------------------*/
@@ -52,30 +66,89 @@
 /** System timer */
 static struct _timer _sys_timer;
 
+/** Frequency of the TC counter (Hz) */
+static uint32_t _counter_freq;
+
+/** Number of counter periods per tick */
+static uint32_t _counts_per_tick;
+
+/** Ticks elapsed up to _tick_base, updated by timer_get_tick() */
+static uint64_t _ticks;
+
+/** Counter value at the start of the current tick */
+static uint64_t _tick_base;
+
 /*----------------------------------------------------------------------------
- *         Exported Functions
+ *         Local functions
  *----------------------------------------------------------------------------*/
 
+/**
+ *  \brief Read the counter and extend it to 64 bits.
+ */
+static uint64_t _timer_read(void)
+{
+	uint32_t mask, cv;
+	uint64_t now;
+
+	if (!_sys_timer.tc)
+		return 0;
+
+	mask = irq_disable_save();
+	cv = tc_get_cv(_sys_timer.tc, _sys_timer.channel);
+	now = (_sys_timer.tick & ~0xFFFFFFFFull) | cv;
+	if (cv < (uint32_t)_sys_timer.tick)
+		now += 1ull << 32;
+	_sys_timer.tick = now;
+	irq_restore(mask);
+
+	return now;
+}
+
+/**
+ *  \brief Wait until the counter reaches deadline.
+ */
+static void _timer_wait_until(uint64_t deadline)
+{
+	while (_timer_read() < deadline) {
+#ifndef CONFIG_TIMER_POLLING
+		uint32_t mask = irq_disable_save();
+		uint32_t ra = (uint32_t)deadline;
+
+		/* one-shot compare, a wrap before the deadline only causes an
+		 * early wake-up */
+		tc_set_ra_rb_rc(_sys_timer.tc, _sys_timer.channel, &ra, 0, 0);
+		tc_enable_it(_sys_timer.tc, _sys_timer.channel, TC_IER_CPAS);
+		/* a pending interrupt wakes the core even when masked */
+		if (_timer_read() < deadline)
+			irq_wait();
+		irq_restore(mask);
+#endif
+	}
+}
+
 /**
  *  \brief Handler for timer interrupt.
  */
-static void timer_increment(uint32_t source, void* user_arg)
+static void timer_handler(uint32_t source, void* user_arg)
 {
 	assert(source == get_tc_id_from_addr(_sys_timer.tc));
-	struct _timer* timer = (struct _timer*)user_arg;
 
-	uint32_t status = tc_get_status(timer->tc, timer->channel);
-	if ((status & TC_SR_CPCS) == TC_SR_CPCS)
-		timer->tick++;
+	uint32_t status = tc_get_status(_sys_timer.tc, _sys_timer.channel);
+	if (status & TC_SR_CPAS)
+		tc_disable_it(_sys_timer.tc, _sys_timer.channel, TC_IDR_CPAS);
+	_timer_read();
 }
 
+/*----------------------------------------------------------------------------
+ *         Exported Functions
+ *----------------------------------------------------------------------------*/
+
 void timer_configure(struct _timer* timer)
 {
-	uint32_t rc = 0;
-	uint32_t tc_clks = 0;
 	uint32_t tc_id = get_tc_id_from_addr(timer->tc);
 
 	memcpy(&_sys_timer, timer, sizeof(_sys_timer));
+	_sys_timer.tick = 0;
 
 #ifdef CONFIG_HAVE_PMC_GENERATED_CLOCKS
 	// For devices that support generated clock, configure TC to use Main
@@ -91,18 +164,20 @@ void timer_configure(struct _timer* timer)
 	pmc_configure_peripheral(tc_id, NULL, true);
 #endif
 
-	// Select clock source, configure tc base on timer clock
-	tc_clks = tc_find_best_clock_source(timer->tc, timer->resolution);
-	tc_configure(timer->tc, timer->channel, tc_clks | TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | TC_CMR_CPCTRG);
-	rc = (tc_get_available_freq(timer->tc, tc_clks) * timer->freq) / timer->resolution;
-	tc_set_ra_rb_rc(timer->tc, timer->channel, 0, 0, &rc);
+	// Free-running counter on the fastest clock
+	_counter_freq = tc_get_available_freq(timer->tc, TC_CMR_TCCLKS_TIMER_CLOCK1);
+	assert(_counter_freq >= timer->resolution);
+	_counts_per_tick = _counter_freq / timer->freq;
+	_ticks = 0;
+	_tick_base = 0;
+	tc_configure(timer->tc, timer->channel, TC_CMR_TCCLKS_TIMER_CLOCK1 | TC_CMR_WAVE | TC_CMR_WAVSEL_UP);
 
 #ifdef CONFIG_TIMER_POLLING
-	tc_disable_it(timer->tc, timer->channel, TC_IER_CPCS);
+	tc_disable_it(timer->tc, timer->channel, TC_IDR_COVFS | TC_IDR_CPAS);
 #else
-	irq_add_handler(tc_id, timer_increment, &_sys_timer);
+	irq_add_handler(tc_id, timer_handler, NULL);
 	irq_enable(tc_id);
-	tc_enable_it(timer->tc, timer->channel, TC_IER_CPCS);
+	tc_enable_it(timer->tc, timer->channel, TC_IER_COVFS);
 #endif
 	tc_start(timer->tc, timer->channel);
 }
@@ -132,38 +207,62 @@ uint8_t timer_timeout_reached(struct _timeout* timeout)
 
 void timer_sleep(uint64_t count)
 {
-	volatile uint32_t _timeout_usec = tc_get_cv(_sys_timer.tc, _sys_timer.channel);
-	volatile uint64_t _timeout_msec = timer_get_tick() + count;
+	_timer_wait_until(_timer_read() + count * _counts_per_tick);
+}
 
-	while (((int64_t)_timeout_msec - timer_get_tick()) > 0) {
-#ifndef CONFIG_TIMER_POLLING
-		irq_wait();
-#endif
+void timer_usleep(uint64_t count)
+{
+	_timer_wait_until(_timer_read() + (count * _counter_freq) / USEC_PER_SEC);
+}
+
+uint64_t timer_get_tick(void)
+{
+	uint32_t mask;
+	uint64_t elapsed, n, ticks;
+
+	if (!_counts_per_tick)
+		return 0;
+
+	/* Advance the tick count from the last call: this only needs a 32-bit
+	 * division when a tick boundary was crossed, and the 64-bit one when
+	 * the counter was not read for more than 2^32 periods. */
+	mask = irq_disable_save();
+	elapsed = _timer_read() - _tick_base;
+	if (elapsed >= _counts_per_tick) {
+		if (elapsed >> 32)
+			n = elapsed / _counts_per_tick;
+		else
+			n = (uint32_t)elapsed / _counts_per_tick;
+		_ticks += n;
+		_tick_base += n * _counts_per_tick;
 	}
+	ticks = _ticks;
+	irq_restore(mask);
 
-	while (((int32_t)_timeout_usec - tc_get_cv(_sys_timer.tc, _sys_timer.channel)) > 0);
+	return ticks;
 }
 
-void timer_usleep(uint64_t count)
+uint64_t timer_get_timestamp(void)
 {
-	volatile uint32_t _timeout_usec = tc_get_cv(_sys_timer.tc, _sys_timer.channel) + (count % 1000);
-	volatile uint64_t _timeout_msec = timer_get_tick() + (count / 1000);
+	return _timer_read();
+}
 
-	while (((int64_t)_timeout_msec - timer_get_tick()) > 0) {
-#ifndef CONFIG_TIMER_POLLING
-		irq_wait();
-#endif
-	}
+uint32_t timer_get_timestamp_freq(void)
+{
+	return _counter_freq;
+}
 
-	while (((int64_t)_timeout_usec - tc_get_cv(_sys_timer.tc, _sys_timer.channel)) > 0);
+uint64_t timer_timestamp_to_ns(uint64_t timestamp)
+{
+	if (!_counter_freq)
+		return 0;
+	return (timestamp / _counter_freq) * NSEC_PER_SEC +
+	       ((timestamp % _counter_freq) * NSEC_PER_SEC) / _counter_freq;
 }
 
-uint64_t timer_get_tick(void)
+uint64_t timer_get_time_ns(void)
 {
-#ifdef CONFIG_TIMER_POLLING
-	timer_increment(get_tc_id_from_addr(_sys_timer.tc), &_sys_timer);
-#endif
-	return _sys_timer.tick;
+	return timer_timestamp_to_ns(_timer_read());
 }
 
 void msleep(uint32_t count)
@@ -63,10 +63,10 @@ struct _timeout
 struct _timer {
 	Tc* tc;
 	uint8_t channel;
-	uint32_t freq;
-	uint32_t resolution;
+	uint32_t freq;		/**< tick frequency, unit of timer_sleep() */
+	uint32_t resolution;	/**< minimum counter frequency */
 
-	volatile uint64_t tick;
+	volatile uint64_t tick;	/**< last value of the 64-bit counter */
 };
 
 /*----------------------------------------------------------------------------
@@ -76,9 +76,12 @@ struct _timer {
 /**
  * \brief Configures the timer and reset tick counter.
  *
- * If CONFIG_TIMER_POLLING is not defined, the TC interrupt will be used to
- * increment the tick counter.  If CONFIG_TIMER_POLLING is defined, the tick
- * counter will be updated from the TC when requested.
+ * The TC channel runs freely on its fastest clock, its 32-bit counter being
+ * extended to 64 bits in software. No periodic interrupt is used: if
+ * CONFIG_TIMER_POLLING is not defined, the TC interrupt only fires on counter
+ * overflow and on the deadline of a sleeping function. If
+ * CONFIG_TIMER_POLLING is defined, the counter must be read (by any timer
+ * function) at least once per counter wrap-around.
  *
  * \note TC is enabled automatically in this function.
  * \warning If interrupts are used, this function also reconfigures the TC
@@ -89,11 +92,11 @@ struct _timer {
 extern void timer_configure(struct _timer *timer);
 
 /**
- * \brief Wait for count times the timer resolution
+ * \brief Wait for count timer ticks
  *
- * If interrupts are enabled, the waiting loop will use WFI instructions to put
- * the core to sleep between timer ticks.  Otherwise, if polling is enabled, a
- * busy-loop is used to poll the TC counter value.
+ * If interrupts are enabled, a compare interrupt is programmed for the
+ * deadline and the core sleeps with WFI until then.  Otherwise, if polling is
+ * enabled, a busy-loop is used to poll the TC counter value.
  */
 extern void timer_sleep(uint64_t count);
 
@@ -133,6 +136,29 @@ extern uint64_t timer_get_interval(uint64_t start, uint64_t end);
  */
 extern uint64_t timer_get_tick(void);
 
+/**
+ * \brief Returns the current value of the 64-bit counter.
+ *
+ * This is the cheapest way to timestamp an event, and can be used from
+ * interrupt context. Its frequency is given by timer_get_timestamp_freq().
+ */
+extern uint64_t timer_get_timestamp(void);
+
+/**
+ * \brief Returns the frequency of the timestamp counter in Hz.
+ */
+extern uint32_t timer_get_timestamp_freq(void);
+
+/**
+ * \brief Convert a timestamp to nanoseconds.
+ */
+extern uint64_t timer_timestamp_to_ns(uint64_t timestamp);
+
+/**
+ * \brief Returns the time elapsed since timer_configure() in nanoseconds.
+ */
+extern uint64_t timer_get_time_ns(void);
+
 /**
  *  \brief Alias for timer_sleep.
  */
@@ -0,0 +1,279 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *  Prioritized work queue.
+ *
+ *  Each priority has its own FIFO (singly linked list with head and tail).
+ *  Queueing and dequeueing are done with interrupts masked; the items
+ *  themselves run with interrupts in their original state.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "irq/irq.h"
+#include "timer.h"
+#include "workqueue.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+/** No interrupt source attached */
+#define NO_IRQ 0xffffffff
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct {
+	struct _work* head;
+	struct _work* tail;
+	struct _work_stats stats;
+} _queues[WORK_PRIO_COUNT];
+
+static uint32_t _irq_source = NO_IRQ;
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+/* Must be called with interrupts masked */
+static struct _work* _dequeue(void)
+{
+	struct _work* work;
+	uint8_t prio;
+
+	for (prio = 0; prio < WORK_PRIO_COUNT; prio++) {
+		work = _queues[prio].head;
+		if (work) {
+			_queues[prio].head = work->next;
+			if (!work->next)
+				_queues[prio].tail = NULL;
+			work->next = NULL;
+			work->queued = false;
+			return work;
+		}
+	}
+	return NULL;
+}
+
+static void _update_stats(struct _work_stats* stats, uint64_t latency)
+{
+	stats->count++;
+	stats->total_latency += latency;
+	if (latency > stats->max_latency)
+		stats->max_latency = latency;
+}
+
+static void _work_irq_handler(uint32_t source, void* user_arg)
+{
+	work_run();
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+void work_init(struct _work* work, enum _work_priority priority,
+		callback_method_t method, void* arg)
+{
+	assert(priority < WORK_PRIO_COUNT);
+
+	work->next = NULL;
+	work->priority = priority;
+	work->queued = false;
+	work->queued_at = 0;
+	work->stats.count = 0;
+	work->stats.total_latency = 0;
+	work->stats.max_latency = 0;
+	callback_set(&work->cb, method, arg);
+}
+
+bool work_queue(struct _work* work)
+{
+	uint32_t mask;
+
+	if (work->queued)
+		return false;
+
+	mask = irq_disable_save();
+	if (work->queued) {
+		irq_restore(mask);
+		return false;
+	}
+	work->queued = true;
+	work->queued_at = timer_get_timestamp();
+	work->next = NULL;
+	if (_queues[work->priority].tail)
+		_queues[work->priority].tail->next = work;
+	else
+		_queues[work->priority].head = work;
+	_queues[work->priority].tail = work;
+	irq_restore(mask);
+
+	if (_irq_source != NO_IRQ)
+		irq_set_pending(_irq_source);
+	return true;
+}
+
+void work_defer(void* arg)
+{
+	work_queue((struct _work*)arg);
+}
+
+void work_cancel(struct _work* work)
+{
+	struct _work* prev = NULL;
+	struct _work* cur;
+	uint32_t mask = irq_disable_save();
+
+	if (work->queued) {
+		cur = _queues[work->priority].head;
+		while (cur && cur != work) {
+			prev = cur;
+			cur = cur->next;
+		}
+		if (cur) {
+			if (prev)
+				prev->next = work->next;
+			else
+				_queues[work->priority].head = work->next;
+			if (_queues[work->priority].tail == work)
+				_queues[work->priority].tail = prev;
+		}
+		work->next = NULL;
+		work->queued = false;
+	}
+	irq_restore(mask);
+}
+
+bool work_is_pending(const struct _work* work)
+{
+	return work->queued;
+}
+
+bool work_pending(void)
+{
+	uint8_t prio;
+
+	for (prio = 0; prio < WORK_PRIO_COUNT; prio++)
+		if (_queues[prio].head)
+			return true;
+	return false;
+}
+
+uint32_t work_run(void)
+{
+	struct _work* work;
+	uint64_t latency;
+	uint32_t mask;
+	uint32_t count = 0;
+
+	while (true) {
+		mask = irq_disable_save();
+		work = _dequeue();
+		if (work) {
+			latency = timer_get_timestamp() - work->queued_at;
+			_update_stats(&work->stats, latency);
+			_update_stats(&_queues[work->priority].stats, latency);
+		}
+		irq_restore(mask);
+		if (!work)
+			break;
+
+		callback_call(&work->cb);
+		count++;
+	}
+	return count;
+}
+
+void work_attach_irq(uint32_t source)
+{
+	irq_disable(source);
+	irq_add_handler(source, _work_irq_handler, NULL);
+	irq_configure_mode(source, IRQ_MODE_POSITIVE_EDGE);
+	irq_configure_priority(source, 0);
+	_irq_source = source;
+	irq_enable(source);
+
+	/* drain the items queued before attaching */
+	if (work_pending())
+		irq_set_pending(source);
+}
+
+void work_get_stats(enum _work_priority priority, struct _work_stats* stats)
+{
+	uint32_t mask;
+
+	assert(priority < WORK_PRIO_COUNT);
+
+	mask = irq_disable_save();
+	*stats = _queues[priority].stats;
+	irq_restore(mask);
+}
+
+void work_reset_stats(void)
+{
+	uint32_t mask = irq_disable_save();
+	uint8_t prio;
+
+	for (prio = 0; prio < WORK_PRIO_COUNT; prio++) {
+		_queues[prio].stats.count = 0;
+		_queues[prio].stats.total_latency = 0;
+		_queues[prio].stats.max_latency = 0;
+	}
+	irq_restore(mask);
+}
+
+void work_dump_stats(void)
+{
+	static const char* names[WORK_PRIO_COUNT] = { "high", "normal", "low" };
+	struct _work_stats stats;
+	uint64_t avg;
+	uint8_t prio;
+
+	printf("prio    count     avg(us)   max(us)\r\n");
+	for (prio = 0; prio < WORK_PRIO_COUNT; prio++) {
+		work_get_stats((enum _work_priority)prio, &stats);
+		avg = stats.count ? stats.total_latency / stats.count : 0;
+		printf("%-7s %-9u %-9u %u\r\n", names[prio],
+		       (unsigned)stats.count,
+		       (unsigned)(timer_timestamp_to_ns(avg) / 1000),
+		       (unsigned)(timer_timestamp_to_ns(stats.max_latency) / 1000));
+	}
+}
@@ -0,0 +1,185 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2016, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ *  \file
+ *
+ *  \par Purpose
+ *
+ *  Run-to-completion work queue, used to defer processing out of interrupt
+ *  handlers (deferred procedure calls).
+ *
+ *  Work items are queued from any context and run later, one after the
+ *  other, by work_run(). Items of a higher priority always run before items
+ *  of a lower one; items of the same priority run in queueing order. An item
+ *  is queued at most once: queueing a pending item does nothing.
+ *
+ *  \par Usage
+ *
+ *  -# Initialize each work item once with work_init().
+ *  -# Queue it with work_queue(), typically from an interrupt handler or a
+ *     driver completion callback. Drivers taking a "void (*)(void*)"
+ *     completion callback (spid, aesd, shad, tdesd, adcd...) complete through
+ *     the queue when given work_defer() as callback and the work item as
+ *     argument.
+ *  -# Drain the queue by calling work_run() from the main loop, or let it be
+ *     drained from a spare low priority interrupt with work_attach_irq().
+ *  -# Use work_get_stats() to get the queueing latency (time between
+ *     work_queue() and the start of the item).
+ */
+
+#ifndef WORKQUEUE_H_
+#define WORKQUEUE_H_
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "callback.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *         Types
+ *----------------------------------------------------------------------------*/
+
+enum _work_priority {
+	WORK_PRIO_HIGH,
+	WORK_PRIO_NORMAL,
+	WORK_PRIO_LOW,
+	WORK_PRIO_COUNT,
+};
+
+/** Queueing latency statistics, in timestamp units (see timer.h) */
+struct _work_stats {
+	uint32_t count;		/**< number of items run */
+	uint64_t total_latency;	/**< sum of the latencies */
+	uint64_t max_latency;	/**< worst latency */
+};
+
+struct _work {
+	struct _work* next;
+	struct _callback cb;
+	uint8_t priority;
+	volatile bool queued;
+	uint64_t queued_at;	/**< timestamp of the last work_queue() */
+	struct _work_stats stats;
+};
+
+/*----------------------------------------------------------------------------
+ *         Global functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a work item.
+ *
+ * \param work     Work item to initialize
+ * \param priority Priority of the item
+ * \param method   Function run by the item
+ * \param arg      Argument of the function
+ */
+extern void work_init(struct _work* work, enum _work_priority priority,
+		callback_method_t method, void* arg);
+
+/**
+ * \brief Queue a work item. Can be used from interrupt context.
+ *
+ * \param work Work item to queue
+ * \return true if the item was queued, false if it was already pending.
+ */
+extern bool work_queue(struct _work* work);
+
+/**
+ * \brief Queue the work item given as argument.
+ *
+ * Same as work_queue(), with a signature matching the completion callbacks
+ * of the drivers, for them to complete through the work queue.
+ *
+ * \param arg Work item to queue (struct _work*)
+ */
+extern void work_defer(void* arg);
+
+/**
+ * \brief Remove a work item from the queue. Does nothing if it is not
+ * pending.
+ */
+extern void work_cancel(struct _work* work);
+
+/**
+ * \brief Tells if a work item is queued and has not started yet.
+ */
+extern bool work_is_pending(const struct _work* work);
+
+/**
+ * \brief Tells if any work item is queued.
+ */
+extern bool work_pending(void);
+
+/**
+ * \brief Run the queued work items, highest priority first, until the queue
+ * is empty. Items queued meanwhile (including by the items themselves) are
+ * run too.
+ *
+ * \return Number of items run
+ */
+extern uint32_t work_run(void);
+
+/**
+ * \brief Drain the queue from an interrupt instead of the main loop.
+ *
+ * The given source, which must not be used by any peripheral, is configured
+ * as edge-triggered with the lowest priority, and is triggered by
+ * work_queue(). While the items run, the other interrupts are only served
+ * if interrupt nesting is enabled (see irq_set_nesting()) and their priority
+ * is higher than 0.
+ *
+ * \param source Spare interrupt source (ID_xxx)
+ */
+extern void work_attach_irq(uint32_t source);
+
+/**
+ * \brief Get the queueing latency statistics of a priority.
+ *
+ * \param priority Priority level
+ * \param stats    Filled with the statistics
+ */
+extern void work_get_stats(enum _work_priority priority, struct _work_stats* stats);
+
+/**
+ * \brief Reset the statistics of all priorities.
+ */
+extern void work_reset_stats(void);
+
+/**
+ * \brief Print the statistics of all priorities, in microseconds.
+ */
+extern void work_dump_stats(void);
+
+#endif /* WORKQUEUE_H_ */